@@ -0,0 +1,97 @@
+// Keystroke latency of resident DSN autocompletion: replays sample queries
+// one typed character at a time as "complete" requests to a QueryServer,
+// the way the Jupyter kernel sends them, and reports the latency
+// percentiles. The first request, which loads the schema, is reported
+// separately.
+//
+// Build with -DARIANE_XML_BUILD_BENCHMARKS=ON, then run from the repository
+// root (the bundled schemas are found relative to it):
+//   ariane-xml-c-kernel/build/autocomplete-bench [P25|P26|AUTO] [rounds]
+
+#include "utils/query_server.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace ariane_xml;
+
+namespace {
+
+const std::vector<std::string> SAMPLE_QUERIES = {
+    "SELECT S21_G00_30_001, S21_G00_30_002 FROM ./dsn WHERE S21_G00_30_004 = 'DUPONT'",
+    "SELECT 30_001, 30_004, 40_019 FROM ./dsn WHERE 40_001 IS NOT NULL",
+    "SELECT S21_G00_06_001 FROM ./dsn ORDER BY S21_G00_06_001 LIMIT 10",
+    "SELECT COUNT(S21_G00_40_009) FROM ./dsn WHERE S21_G00_40_007 = '01'",
+    "DESCRIBE S21_G00_30",
+    "SELECT salaire, numero, rupture FROM ./dsn",
+    "SELECT S21_G00_03_001, S21_G00_04_009 FROM ./dsn",
+};
+
+std::string quote(const std::string& text) {
+    std::string quoted = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            quoted += '\\';
+        }
+        quoted += c;
+    }
+    return quoted + '"';
+}
+
+std::string request(int id, const std::string& code, const std::string& version) {
+    return "{\"jsonrpc\":\"2.0\",\"id\":" + std::to_string(id) +
+           ",\"method\":\"complete\",\"params\":{\"code\":" + quote(code) +
+           ",\"cursor_pos\":" + std::to_string(code.size()) +
+           ",\"version\":" + quote(version) + "}}";
+}
+
+double percentile(const std::vector<double>& sorted, double p) {
+    size_t index = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string version = argc > 1 ? argv[1] : "AUTO";
+    int rounds = argc > 2 ? std::atoi(argv[2]) : 20;
+
+    QueryServer server([](const std::string&) {});
+    int id = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    std::string first = server.handle(request(++id, "SELECT S21", version));
+    double loadTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    if (first.find("\"completion\"") == std::string::npos) {
+        std::cerr << "No suggestions: is the " << version
+                  << " schema under ariane-xml-schemas/ in the working directory?" << std::endl;
+        return 1;
+    }
+    std::cout << "First request (schema load): " << loadTime << " ms" << std::endl;
+
+    std::vector<double> latencies;
+    size_t responseBytes = 0;
+    for (int round = 0; round < rounds; ++round) {
+        for (const auto& query : SAMPLE_QUERIES) {
+            for (size_t typed = 1; typed <= query.size(); ++typed) {
+                std::string line = request(++id, query.substr(0, typed), version);
+                start = std::chrono::steady_clock::now();
+                std::string response = server.handle(line);
+                latencies.push_back(std::chrono::duration<double, std::milli>(
+                    std::chrono::steady_clock::now() - start).count());
+                responseBytes += response.size();
+            }
+        }
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    std::cout << "Keystrokes: " << latencies.size() << " (" << responseBytes / latencies.size()
+              << " response bytes on average)" << std::endl;
+    std::cout << "p50: " << percentile(latencies, 0.50) << " ms, p90: " << percentile(latencies, 0.90)
+              << " ms, p99: " << percentile(latencies, 0.99) << " ms, max: " << latencies.back()
+              << " ms" << std::endl;
+    return 0;
+}
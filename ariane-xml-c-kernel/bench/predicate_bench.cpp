@@ -0,0 +1,157 @@
+// Compares XmlNavigator::evaluateWhereExpr (AST walk) with evaluateWhere on
+// the compiled predicate over a generated document of about one million
+// element nodes, then std::regex_search with RegexMatcher on its values.
+//
+// Build with -DARIANE_XML_BUILD_BENCHMARKS=ON, then run:
+//   ./predicate-bench [records]
+
+#include "executor/xml_navigator.h"
+#include "executor/compiled_predicate.h"
+#include "executor/regex_matcher.h"
+#include <pugixml.hpp>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <regex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace ariane_xml;
+
+namespace {
+
+std::unique_ptr<WhereExpr> condition(std::vector<std::string> path, ComparisonOp op,
+                                     std::string value, bool numeric,
+                                     std::vector<std::string> values = {}) {
+    auto cond = std::make_unique<WhereCondition>();
+    cond->field.components = std::move(path);
+    cond->field.is_partial_path = true;
+    cond->op = op;
+    cond->value = std::move(value);
+    cond->is_numeric = numeric;
+    cond->values = std::move(values);
+    return cond;
+}
+
+std::unique_ptr<WhereExpr> combine(LogicalOp op, std::unique_ptr<WhereExpr> left,
+                                   std::unique_ptr<WhereExpr> right) {
+    auto logical = std::make_unique<WhereLogical>();
+    logical->op = op;
+    logical->left = std::move(left);
+    logical->right = std::move(right);
+    return logical;
+}
+
+// <records> with one <record> of four children per record: 5 elements each
+std::string generateDocument(size_t records) {
+    static const char* positions[] = {"Engineer", "Manager", "Analyst", "Technician", "Designer"};
+    std::string xml = "<records>";
+    xml.reserve(records * 120);
+    for (size_t i = 0; i < records; ++i) {
+        xml += "<record><id>" + std::to_string(i) + "</id>";
+        xml += "<salary>" + std::to_string((i * 7919) % 1000) + "</salary>";
+        xml += "<position>" + std::string(positions[i % 5]) + "</position>";
+        xml += "<dept>D" + std::to_string(i % 40) + "</dept></record>";
+    }
+    xml += "</records>";
+    return xml;
+}
+
+template <typename Evaluate>
+double timeScan(const std::vector<pugi::xml_node>& nodes, size_t& matches, Evaluate&& evaluate) {
+    auto start = std::chrono::steady_clock::now();
+    matches = 0;
+    for (const auto& node : nodes) {
+        if (evaluate(node)) {
+            ++matches;
+        }
+    }
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t records = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200000;
+    const int rounds = 3;
+
+    pugi::xml_document doc;
+    std::string xml = generateDocument(records);
+    if (!doc.load_buffer(xml.data(), xml.size())) {
+        std::cerr << "Failed to parse generated document" << std::endl;
+        return 1;
+    }
+
+    std::vector<pugi::xml_node> nodes;
+    for (pugi::xml_node record : doc.document_element().children("record")) {
+        nodes.push_back(record);
+    }
+
+    // WHERE .record.salary > 500 AND (.record.position LIKE /an/ OR .record.dept IN (...))
+    auto where = combine(LogicalOp::AND,
+        condition({"record", "salary"}, ComparisonOp::GREATER_THAN, "500", true),
+        combine(LogicalOp::OR,
+            condition({"record", "position"}, ComparisonOp::LIKE, "an", false),
+            condition({"record", "dept"}, ComparisonOp::IN, "", false,
+                      {"D1", "D3", "D5", "D7", "D11", "D13", "D17", "D19"})));
+
+    std::cout << "Document: " << records << " records, " << records * 5 + 1 << " elements" << std::endl;
+
+    double astBest = 0, compiledBest = 0, compileTime = 0;
+    size_t astMatches = 0, compiledMatches = 0;
+    for (int round = 0; round < rounds; ++round) {
+        double ast = timeScan(nodes, astMatches, [&](const pugi::xml_node& node) {
+            return XmlNavigator::evaluateWhereExpr(node, where.get(), 1);
+        });
+
+        auto compileStart = std::chrono::steady_clock::now();
+        CompiledPredicate compiled(where.get());
+        compileTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - compileStart).count();
+
+        double fast = timeScan(nodes, compiledMatches, [&](const pugi::xml_node& node) {
+            return XmlNavigator::evaluateWhere(node, compiled, 1);
+        });
+
+        astBest = round == 0 ? ast : std::min(astBest, ast);
+        compiledBest = round == 0 ? fast : std::min(compiledBest, fast);
+    }
+
+    std::cout << "evaluateWhereExpr: " << astBest << " ms (" << astMatches << " matches)" << std::endl;
+    std::cout << "evaluateWhere:     " << compiledBest << " ms (" << compiledMatches << " matches, "
+              << compileTime << " ms to compile)" << std::endl;
+    std::cout << "Speedup: " << astBest / compiledBest << "x" << std::endl;
+
+    // LIKE patterns on every <position> value
+    std::vector<std::string_view> values;
+    for (const auto& node : nodes) {
+        values.push_back(node.child("position").child_value());
+    }
+
+    bool agree = astMatches == compiledMatches;
+    for (const char* like : {".*Manager.*", "^Tech", "ne(er|r)$", "[A-Z][a-z]+ig"}) {
+        std::regex regex(like);
+        RegexMatcher matcher(like);
+
+        size_t regexMatches = 0;
+        size_t matcherMatches = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (auto value : values) {
+            regexMatches += std::regex_search(value.begin(), value.end(), regex);
+        }
+        double regexTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        for (auto value : values) {
+            matcherMatches += matcher.search(value);
+        }
+        double matcherTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << "LIKE /" << like << "/: std::regex " << regexTime << " ms, RegexMatcher "
+                  << matcherTime << " ms (" << matcherMatches << " matches)" << std::endl;
+        agree = agree && regexMatches == matcherMatches;
+    }
+
+    return agree ? 0 : 1;
+}
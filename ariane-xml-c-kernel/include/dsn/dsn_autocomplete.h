@@ -2,7 +2,10 @@
 #define DSN_AUTOCOMPLETE_H
 
 #include "dsn_schema.h"
+#include "dsn_completion_trie.h"
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <memory>
 
@@ -33,6 +36,11 @@ struct AutoCompleteSuggestion {
  * - Bloc name suggestions with descriptions
  * - Attribute suggestions with field descriptions
  * - Context-aware suggestions based on cursor position
+ * - Search in field descriptions ("salaire") and typo-tolerant matching
+ *
+ * Names, shortcuts, bloc names and labels, and description words are
+ * indexed in prefix tries built once per schema, so a suggestion costs the
+ * length of the input and the matches, not a scan of the schema.
  */
 class DsnAutoComplete {
 public:
@@ -79,6 +87,33 @@ public:
         const std::string& partial_shortcut
     );
 
+    /**
+     * Get suggestions for words of field descriptions
+     * Example: "salai" -> fields described with "salaire", "salaires", ...
+     * @param partial_word The partial word (case and accents ignored)
+     * @return List of matching fields, in name order
+     */
+    std::vector<AutoCompleteSuggestion> getDescriptionSuggestions(
+        const std::string& partial_word
+    );
+
+    /**
+     * Get fields whose name, shortcut or a description word starts within
+     * a few edits of the input, for typos
+     * Example: "S21_G00_03_001" -> S21_G00_30_001, ...
+     * @param partial The mistyped input
+     * @return List of matching fields, fewest edits first
+     */
+    std::vector<AutoCompleteSuggestion> getFuzzySuggestions(
+        const std::string& partial
+    );
+
+    /**
+     * Edits allowed when fuzzy matching an input of this length: none
+     * under 4 characters, 1 under 8, then 2
+     */
+    static uint32_t maxEditsFor(size_t length);
+
     /**
      * Get SQL keyword suggestions
      * @param partial_keyword The partial keyword
@@ -99,9 +134,38 @@ public:
         size_t max_display = 20
     );
 
+    /**
+     * Encode suggestions as the JSON array front ends read
+     * ([{"completion", "display", "description", "type"}, ...])
+     * @param suggestions List of suggestions
+     * @return JSON text
+     */
+    static std::string toJson(const std::vector<AutoCompleteSuggestion>& suggestions);
+
+    /**
+     * Directory of the bundled schema for a DSN version, relative to the
+     * working directory (AUTO uses the latest, P26)
+     * @param version P25, P26 or AUTO
+     * @return Schema directory
+     */
+    static std::string schemaDirectory(const std::string& version);
+
 private:
     std::shared_ptr<DsnSchema> schema_;
 
+    // Tries over the schema. Values are positions in attributesByName()
+    // (paths_, words_), in attributesByShortId() (shortcuts_), or bloc
+    // indices (blocs_), so matches come back in the order the scans had.
+    CompletionTrie paths_;
+    CompletionTrie shortcuts_;
+    CompletionTrie blocs_;       // Bloc names (S21_G00_30), labels and label words
+    CompletionTrie words_;       // Words of field descriptions
+
+    void buildIndex();
+
+    AutoCompleteSuggestion fieldSuggestion(const DsnAttribute& attr) const;
+    AutoCompleteSuggestion shortcutSuggestion(const DsnAttribute& attr) const;
+
     /**
      * Extract the word/path being completed at cursor position
      */
@@ -122,7 +186,7 @@ private:
     /**
      * Check if a string starts with a given prefix (case-insensitive)
      */
-    bool startsWith(const std::string& str, const std::string& prefix);
+    bool startsWith(std::string_view str, std::string_view prefix);
 
     /**
      * Common SQL keywords for DSN queries
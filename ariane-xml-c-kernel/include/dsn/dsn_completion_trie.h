@@ -0,0 +1,76 @@
+#ifndef DSN_COMPLETION_TRIE_H
+#define DSN_COMPLETION_TRIE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace ariane_xml {
+
+/**
+ * Compressed prefix trie from folded keys (see fold) to 32-bit values,
+ * e.g. positions in a sorted attribute list. Keys are added, then build()
+ * packs them into a radix tree: each node carries the label of the edge
+ * leading to it, so chains of single-child nodes collapse, and the values
+ * under a node are one contiguous range.
+ *
+ * Matches are ranked: fewest edits first, then smallest value, so values
+ * that are positions in a sorted list come back in that order.
+ */
+class CompletionTrie {
+public:
+    struct Match {
+        uint32_t value;
+        uint32_t edits;  // Levenshtein distance from the query to the key's closest prefix
+    };
+
+    void add(std::string_view key, uint32_t value);
+    void build();
+
+    /**
+     * Values of the keys starting with 'prefix', each once, in order
+     */
+    std::vector<uint32_t> prefixMatches(std::string_view prefix) const;
+
+    /**
+     * Values of the keys having a prefix within 'maxEdits' insertions,
+     * deletions or substitutions of 'query', each once at its fewest edits
+     */
+    std::vector<Match> fuzzyMatches(std::string_view query, uint32_t maxEdits) const;
+
+    /**
+     * Lowercase ASCII and strip the accents of UTF-8 Latin-1 letters, so
+     * "Numéro" and "numero" fold to the same key
+     */
+    static std::string fold(std::string_view text);
+
+    // Approximate heap footprint
+    size_t memoryBytes() const;
+
+private:
+    struct Node {
+        uint32_t label_begin;   // Edge label, in labels_
+        uint32_t label_length;
+        uint32_t first_child;   // Children are consecutive, by first label byte
+        uint32_t child_count;
+        uint32_t values_begin;  // Values of the subtree, in values_: those of
+        uint32_t values_end;    // keys ending here first
+    };
+
+    void buildNode(uint32_t node, size_t begin, size_t end, size_t depth);
+    uint32_t findChild(const Node& node, char c) const;
+    void fuzzyVisit(uint32_t node, std::string_view query, uint32_t maxEdits,
+                    std::vector<uint32_t> row, uint32_t best, std::vector<Match>& matches) const;
+
+    std::vector<std::pair<std::string, uint32_t>> pending_;  // Added, not yet built
+    std::vector<Node> nodes_;                                // Root first
+    std::string labels_;
+    std::vector<uint32_t> values_;
+};
+
+} // namespace ariane_xml
+
+#endif // DSN_COMPLETION_TRIE_H
@@ -2,6 +2,7 @@
 #define DSN_FORMATTER_H
 
 #include "dsn_schema.h"
+#include "executor/result_batch.h"
 #include <string>
 #include <vector>
 #include <map>
@@ -9,26 +10,6 @@
 
 namespace ariane_xml {
 
-/**
- * Represents a result row with field values
- */
-struct ResultRow {
-    std::map<std::string, std::string> fields;  // field_name -> value
-
-    std::string get(const std::string& field) const {
-        auto it = fields.find(field);
-        return (it != fields.end()) ? it->second : "";
-    }
-
-    void set(const std::string& field, const std::string& value) {
-        fields[field] = value;
-    }
-
-    bool has(const std::string& field) const {
-        return fields.find(field) != fields.end();
-    }
-};
-
 /**
  * Output format options for DSN results
  */
@@ -54,40 +35,40 @@ public:
 
     /**
      * Format query results in the specified format
-     * @param results Vector of result rows
+     * @param results Query results
      * @param format Output format
      * @return Formatted string
      */
     std::string format(
-        const std::vector<ResultRow>& results,
+        const ResultBatch& results,
         DsnOutputFormat format = DsnOutputFormat::TABLE
     );
 
     /**
      * Format in standard table format
      */
-    std::string formatTable(const std::vector<ResultRow>& results);
+    std::string formatTable(const ResultBatch& results);
 
     /**
      * Format in DSN-structured hierarchical format
      * Groups fields by bloc and shows descriptions
      */
-    std::string formatDsnStructured(const std::vector<ResultRow>& results);
+    std::string formatDsnStructured(const ResultBatch& results);
 
     /**
      * Format as JSON
      */
-    std::string formatJson(const std::vector<ResultRow>& results);
+    std::string formatJson(const ResultBatch& results);
 
     /**
      * Format as CSV
      */
-    std::string formatCsv(const std::vector<ResultRow>& results);
+    std::string formatCsv(const ResultBatch& results);
 
     /**
      * Format in compact single-line format
      */
-    std::string formatCompact(const std::vector<ResultRow>& results);
+    std::string formatCompact(const ResultBatch& results);
 
     /**
      * Set maximum field width for table output
@@ -155,9 +136,17 @@ private:
     std::string drawLine(char c, size_t length);
 
     /**
-     * Get all unique field names from results
+     * Get all unique field names from results, in name order
+     */
+    std::vector<std::string> getFieldNames(const ResultBatch& results);
+
+    /**
+     * Batch column of each field name
      */
-    std::vector<std::string> getFieldNames(const std::vector<ResultRow>& results);
+    std::vector<size_t> getFieldColumns(
+        const ResultBatch& results,
+        const std::vector<std::string>& fields
+    );
 };
 
 } // namespace ariane_xml
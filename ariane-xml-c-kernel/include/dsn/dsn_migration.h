@@ -4,6 +4,7 @@
 #include "dsn_schema.h"
 #include <string>
 #include <vector>
+#include <map>
 #include <memory>
 #include <set>
 
@@ -7,6 +7,8 @@
 
 namespace ariane_xml {
 
+class ThreadPool;
+
 /**
  * Parser for DSN XSD schemas (P25, P26, etc.)
  * Extracts DSN attribute information and builds the schema model
@@ -23,11 +25,16 @@ public:
 
     /**
      * Parse multiple XSD files from a directory (for versions with multiple files)
+     * Each file is parsed into its own fragment, in parallel when a pool is
+     * given; fragments are merged in file name order, so the schema is the
+     * same whatever the scheduling or directory order.
      * @param schemaDir Path to the schema directory
      * @param version DSN version (P25, P26, etc.)
+     * @param pool Worker pool, or null to parse one file after another
      * @return Shared pointer to the parsed schema
      */
-    static std::shared_ptr<DsnSchema> parseDirectory(const std::string& schemaDir, const std::string& version);
+    static std::shared_ptr<DsnSchema> parseDirectory(const std::string& schemaDir, const std::string& version,
+                                                     ThreadPool* pool = nullptr);
 
     /**
      * Auto-detect DSN version from an XML file
@@ -37,6 +44,12 @@ public:
     static std::string detectVersion(const std::string& xmlPath);
 
 private:
+    /**
+     * Parse one XSD file of a directory into a fragment
+     * @return The fragment, or null if the file isn't well-formed XML
+     */
+    static std::shared_ptr<DsnSchema> parseFragment(const std::string& xsdPath, const std::string& version);
+
     /**
      * Extract short ID (YY_ZZZ) from full attribute name
      * Example: S21_G00_30_001 -> 30_001
@@ -1,28 +1,34 @@
 #ifndef DSN_SCHEMA_H
 #define DSN_SCHEMA_H
 
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
-#include <map>
-#include <memory>
 
 namespace ariane_xml {
 
 /**
  * Represents a DSN attribute/field in the schema
  * Example: S21_G00_30_001 (NIR)
+ *
+ * The strings are views: of the caller's strings when adding an attribute,
+ * of the schema's interned strings when returned by a lookup (valid as long
+ * as the schema).
  */
 struct DsnAttribute {
-    std::string full_name;       // S21_G00_30_001
-    std::string short_id;        // 30_001 (YY_ZZZ notation)
-    std::string bloc_name;       // S21.G00.30 (INDIVIDU)
-    std::string bloc_label;      // Human-readable bloc name (e.g., "INDIVIDU")
-    std::string description;     // "NIR - Numéro d'inscription au répertoire"
-    std::string type;            // "Alphanumeric 1-15"
-    bool mandatory;              // Is this field mandatory?
-    int min_occurs;              // Minimum occurrences (0 = optional)
-    int max_occurs;              // Maximum occurrences (-1 = unbounded)
-    std::vector<std::string> versions;  // ["P25V01", "P26V01"]
+    std::string_view full_name;    // S21_G00_30_001
+    std::string_view short_id;     // 30_001 (YY_ZZZ notation)
+    std::string_view bloc_name;    // S21.G00.30 (INDIVIDU)
+    std::string_view bloc_label;   // Human-readable bloc name (e.g., "INDIVIDU")
+    std::string_view description;  // "NIR - Numéro d'inscription au répertoire"
+    std::string_view type;         // "Alphanumeric 1-15"
+    bool mandatory;                // Is this field mandatory?
+    int min_occurs;                // Minimum occurrences (0 = optional)
+    int max_occurs;                // Maximum occurrences (-1 = unbounded)
 
     DsnAttribute()
         : mandatory(false), min_occurs(0), max_occurs(1) {}
@@ -31,26 +37,60 @@ struct DsnAttribute {
 /**
  * Represents a DSN bloc/structure
  * Example: S21.G00.30 (INDIVIDU)
+ * Its attributes are those whose bloc_name is the bloc's name
+ * (DsnSchema::findBlocAttributes). Strings are views as for DsnAttribute.
  */
 struct DsnBloc {
-    std::string name;            // S21.G00.30
-    std::string label;           // INDIVIDU
-    std::string description;     // Description of the bloc
-    std::vector<DsnAttribute> attributes;  // All attributes in this bloc
-    bool mandatory;              // Is this bloc mandatory?
-    int min_occurs;              // Minimum occurrences
-    int max_occurs;              // Maximum occurrences (-1 = unbounded)
+    std::string_view name;         // S21.G00.30
+    std::string_view label;        // INDIVIDU
+    std::string_view description;  // Description of the bloc
+    bool mandatory;                // Is this bloc mandatory?
+    int min_occurs;                // Minimum occurrences
+    int max_occurs;                // Maximum occurrences (-1 = unbounded)
 
     DsnBloc()
         : mandatory(false), min_occurs(0), max_occurs(1) {}
 };
 
+/**
+ * Strings stored once each and named by a 32-bit id. Copies live in
+ * fixed-size chunks so views of them never move; strings known to outlive
+ * the pool (generated tables) are referenced instead of copied.
+ */
+class InternedStrings {
+public:
+    uint32_t intern(std::string_view text);
+    uint32_t internStatic(std::string_view text);
+
+    std::string_view get(uint32_t id) const { return strings_[id]; }
+
+    // Approximate heap footprint
+    size_t memoryBytes() const;
+
+private:
+    uint32_t find(std::string_view text, size_t& slot) const;
+    uint32_t add(std::string_view stored, size_t slot);
+
+    std::vector<std::string_view> strings_;
+    std::vector<std::unique_ptr<char[]>> chunks_;
+    size_t chunkUsed_ = 0;    // Bytes used in the last chunk
+    size_t chunkBytes_ = 0;   // Bytes allocated in all chunks
+    std::vector<uint32_t> lookup_;  // Id + 1 by hash, 0 for free; power of two, at most half full
+};
+
 /**
  * Main DSN schema representation
  * Parsed from P25/P26 XSD files
+ *
+ * Attributes live in one flat table of interned string ids, numbered in
+ * the order they were added. Open-addressing hash indices resolve a full
+ * name, a short id or a bloc name in O(1); attributes sharing a short id
+ * or a bloc are chained through the table.
  */
 class DsnSchema {
 public:
+    using AttributeId = uint32_t;
+
     DsnSchema() = default;
     explicit DsnSchema(const std::string& version);
 
@@ -58,49 +98,105 @@ public:
     std::string getVersion() const { return version_; }
     void setVersion(const std::string& version) { version_ = version; }
 
-    // Add attributes and blocs
-    void addAttribute(const DsnAttribute& attr);
+    // Add attributes and blocs. Strings are copied into the schema. Adding
+    // a full name again replaces its details; its short id and bloc, which
+    // the full name encodes, stay.
+    AttributeId addAttribute(const DsnAttribute& attr);
     void addBloc(const DsnBloc& bloc);
 
+    // Same, for strings that outlive the schema (generated tables): they
+    // are referenced rather than copied
+    AttributeId addStaticAttribute(const DsnAttribute& attr);
+
+    // Add every attribute and bloc of 'other', in its order, as if they
+    // had been added here
+    void merge(const DsnSchema& other);
+
+    // Make room for this many attributes
+    void reserve(size_t attributes);
+
+    // Attribute table
+    size_t attributeCount() const { return attributes_.size(); }
+    DsnAttribute attribute(AttributeId id) const;
+
+    // Attribute ids in full name order, and in short id order (attributes
+    // sharing a short id in the order they were added)
+    const std::vector<AttributeId>& attributesByName() const { return by_name_; }
+    const std::vector<AttributeId>& attributesByShortId() const { return by_short_id_; }
+
     // Lookup methods
-    std::vector<DsnAttribute> findByShortId(const std::string& short_id) const;
-    DsnAttribute* findByFullName(const std::string& full_name);
-    const DsnAttribute* findByFullName(const std::string& full_name) const;
+    std::vector<DsnAttribute> findByShortId(std::string_view short_id) const;
+    std::optional<DsnAttribute> findByFullName(std::string_view full_name) const;
 
     // Bloc lookup
-    const DsnBloc* findBloc(const std::string& bloc_name) const;
-    std::vector<const DsnBloc*> findBlocsByPattern(const std::string& pattern) const;
+    size_t blocCount() const { return blocs_.size(); }
+    DsnBloc bloc(size_t index) const;
+    std::optional<DsnBloc> findBloc(std::string_view bloc_name) const;
+    std::vector<DsnBloc> findBlocsByPattern(const std::string& pattern) const;
+    std::vector<DsnAttribute> findBlocAttributes(std::string_view bloc_name) const;
 
     // Check for ambiguity
-    bool isAmbiguous(const std::string& short_id) const;
-
-    // Get all shortcuts mapped to full names
-    const std::map<std::string, std::vector<DsnAttribute>>& getShortcutMap() const {
-        return shortcut_map_;
-    }
-
-    // Get all blocs
-    const std::vector<DsnBloc>& getBlocs() const {
-        return blocs_;
-    }
+    bool isAmbiguous(std::string_view short_id) const;
 
-    // Get all attributes
-    const std::map<std::string, DsnAttribute>& getAttributes() const {
-        return full_name_map_;
-    }
+    // Approximate heap footprint
+    size_t memoryBytes() const;
 
 private:
-    std::string version_;  // P25, P26, etc.
+    static constexpr uint32_t NONE = static_cast<uint32_t>(-1);
+
+    struct AttributeRecord {
+        uint32_t full_name;
+        uint32_t short_id;
+        uint32_t bloc_name;
+        uint32_t bloc_label;
+        uint32_t description;
+        uint32_t type;
+        int32_t min_occurs;
+        int32_t max_occurs;
+        bool mandatory;
+        AttributeId next_same_short_id;  // NONE at the end of the chain
+        AttributeId next_same_bloc;
+        AttributeId last_same_short_id;  // Chain heads only: where to append
+        AttributeId last_same_bloc;
+    };
+
+    struct BlocRecord {
+        uint32_t name;
+        uint32_t label;
+        uint32_t description;
+        int32_t min_occurs;
+        int32_t max_occurs;
+        bool mandatory;
+    };
+
+    // A hash index: slots hold entry + 1 by hash of its key, 0 for free;
+    // power of two, at most half full
+    struct Index {
+        std::vector<uint32_t> slots;
+        size_t count = 0;
+    };
+
+    template <typename KeyOf>
+    static uint32_t lookup(const Index& index, std::string_view key, KeyOf keyOf);
+    template <typename KeyOf>
+    static void insert(Index& index, uint32_t entry, KeyOf keyOf);
+
+    AttributeId add(const DsnAttribute& attr, bool staticStrings);
+    DsnAttribute view(const AttributeRecord& record) const;
+    std::string_view text(uint32_t id) const { return strings_.get(id); }
 
-    // Shortcut notation mapping: "30_001" -> [DsnAttribute, ...]
-    std::map<std::string, std::vector<DsnAttribute>> shortcut_map_;
+    std::string version_;  // P25, P26, etc.
+    InternedStrings strings_;
 
-    // Full name mapping: "S21_G00_30_001" -> DsnAttribute
-    std::map<std::string, DsnAttribute> full_name_map_;
+    std::vector<AttributeRecord> attributes_;
+    std::vector<AttributeId> by_name_;
+    std::vector<AttributeId> by_short_id_;
+    Index name_index_;        // Full name -> attribute
+    Index short_id_index_;    // Short id -> first attribute with it
+    Index bloc_attr_index_;   // Bloc name -> first attribute in it
 
-    // Bloc storage
-    std::vector<DsnBloc> blocs_;
-    std::map<std::string, size_t> bloc_index_;  // bloc name -> index in blocs_
+    std::vector<BlocRecord> blocs_;
+    Index bloc_index_;        // Bloc name -> index in blocs_
 };
 
 } // namespace ariane_xml
@@ -0,0 +1,89 @@
+#ifndef DSN_SCHEMA_TABLES_H
+#define DSN_SCHEMA_TABLES_H
+
+#include "dsn_schema.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace ariane_xml {
+
+class ThreadPool;
+
+/**
+ * One attribute as DsnParser extracted it, in static storage
+ */
+struct DsnAttributeRecord {
+    const char* full_name;
+    const char* short_id;
+    const char* bloc_name;
+    const char* bloc_label;
+    const char* description;
+    const char* type;
+    int min_occurs;
+    int max_occurs;
+    bool mandatory;
+};
+
+/**
+ * An XSD file the tables were generated from
+ */
+struct DsnSourceFile {
+    const char* name;   // File name within the schema directory
+    uint64_t size;
+    uint64_t hash;      // hashDsnSchemaFile of the contents
+};
+
+/**
+ * A bundled DSN schema directory, parsed at build time by dsn-schema-gen
+ * into tables compiled into the executable. Attributes are in the order
+ * the parser added them, so replaying them rebuilds the same DsnSchema
+ * without reading any XML; its strings stay in the tables, uncopied.
+ */
+struct DsnSchemaTables {
+    const char* version;  // P25, P26, ...
+    const DsnSourceFile* files;
+    size_t file_count;
+    const DsnAttributeRecord* attributes;
+    size_t attribute_count;
+};
+
+/**
+ * Generated tables, one per bundled schema directory; the list ends with
+ * an entry whose version is null
+ */
+extern const DsnSchemaTables BUNDLED_DSN_SCHEMAS[];
+
+/**
+ * Fingerprint of an XSD file's contents (64-bit FNV-1a)
+ */
+inline uint64_t hashDsnSchemaFile(std::string_view contents) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : contents) {
+        hash = (hash ^ c) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+/**
+ * Tables generated from exactly the XSD files in 'schemaDir' (same names,
+ * sizes and contents), or null
+ */
+const DsnSchemaTables* findBundledDsnSchema(const std::string& schemaDir);
+
+/**
+ * Load a DSN schema directory: from the generated tables when it holds a
+ * bundled schema, otherwise with DsnParser::parseDirectory
+ * @param schemaDir Path to the schema directory
+ * @param version DSN version (P25, P26, etc.)
+ * @param pool Worker pool the parser may spread the files over, or null
+ * @return Shared pointer to the schema
+ */
+std::shared_ptr<DsnSchema> loadDsnSchemaDirectory(const std::string& schemaDir, const std::string& version,
+                                                  ThreadPool* pool = nullptr);
+
+} // namespace ariane_xml
+
+#endif // DSN_SCHEMA_TABLES_H
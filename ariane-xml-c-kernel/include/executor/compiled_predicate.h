@@ -0,0 +1,125 @@
+#ifndef COMPILED_PREDICATE_H
+#define COMPILED_PREDICATE_H
+
+#include "parser/ast.h"
+#include "executor/regex_matcher.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace ariane_xml {
+
+// A WHERE or HAVING expression lowered once per query: numeric constants
+// are parsed, LIKE patterns compiled and IN lists hashed up front, and the
+// AND/OR tree is flattened into an array evaluated with short-circuiting.
+// How a condition's value is found depends on the caller (a node, a FOR
+// variable, an aggregated row), so evaluate() takes a per-condition test.
+//
+// Conditions refer to the parsed expression, which must outlive this.
+class CompiledPredicate {
+public:
+    class Condition {
+    public:
+        const WhereCondition& source() const { return *source_; }
+        const FieldPath& field() const { return source_->field; }
+
+        // The field relative to its FOR variable (variable name dropped)
+        const FieldPath& boundField() const { return boundField_; }
+
+        // Components joined with '.', as HAVING looks columns up
+        const std::string& columnName() const { return columnName_; }
+
+        // WHERE semantics on a node value ("" when the node or attribute is
+        // missing), same as XmlNavigator::evaluateCondition
+        bool test(std::string_view value) const;
+
+        // HAVING semantics on a value of an aggregated row
+        bool testAggregate(std::string_view value) const;
+
+        // WHERE on a FOR position variable (AT clause)
+        bool testPosition(size_t position) const;
+
+    private:
+        friend class CompiledPredicate;
+
+        const WhereCondition* source_ = nullptr;
+        FieldPath boundField_;
+        std::string columnName_;
+
+        bool hasNumber_ = false;                    // 'value' parses as a double
+        double number_ = 0.0;
+        bool hasPosition_ = false;                  // 'value' parses as an unsigned integer
+        unsigned long long position_ = 0;
+        std::unique_ptr<RegexMatcher> pattern_;     // LIKE / NOT LIKE; null if the pattern is invalid
+        std::unordered_set<std::string_view> members_;  // IN / NOT IN, views into 'values'
+    };
+
+    // Empty predicate: always true
+    CompiledPredicate() = default;
+    explicit CompiledPredicate(const WhereExpr* expr);
+
+    bool empty() const { return nodes_.empty(); }
+
+    // Every condition, in the order they appear
+    const std::vector<Condition>& conditions() const { return conditions_; }
+
+    // 'test(condition)' decides one condition; AND/OR stop at the first
+    // operand that settles the result
+    template <typename ConditionTest>
+    bool evaluate(ConditionTest&& test) const {
+        return nodes_.empty() || evaluateNode(root_, test);
+    }
+
+    // Parse like std::stod / std::stoull (leading whitespace, longest valid
+    // prefix, out of range rejected) without throwing
+    static bool parseNumber(std::string_view text, double& number);
+    static bool parseUnsigned(std::string_view text, unsigned long long& number);
+
+private:
+    enum class NodeKind : uint8_t { CONDITION, AND, OR, ALWAYS, NEVER };
+
+    struct Node {
+        NodeKind kind;
+        uint32_t left = 0;    // Condition index for CONDITION
+        uint32_t right = 0;
+    };
+
+    uint32_t lower(const WhereExpr* expr);
+
+    template <typename ConditionTest>
+    bool evaluateNode(uint32_t id, ConditionTest& test) const {
+        const Node& node = nodes_[id];
+        switch (node.kind) {
+            case NodeKind::CONDITION:
+                return test(conditions_[node.left]);
+            case NodeKind::AND:
+                return evaluateNode(node.left, test) && evaluateNode(node.right, test);
+            case NodeKind::OR:
+                return evaluateNode(node.left, test) || evaluateNode(node.right, test);
+            case NodeKind::ALWAYS:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    std::vector<Node> nodes_;
+    std::vector<Condition> conditions_;
+    uint32_t root_ = 0;
+};
+
+// The compiled WHERE and HAVING clauses of a query
+struct QueryPredicates {
+    CompiledPredicate where;
+    CompiledPredicate having;
+
+    explicit QueryPredicates(const Query& query)
+        : where(query.where.get()), having(query.having.get()) {}
+};
+
+} // namespace ariane_xml
+
+#endif // COMPILED_PREDICATE_H
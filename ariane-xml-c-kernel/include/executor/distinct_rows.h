@@ -0,0 +1,76 @@
+#ifndef DISTINCT_ROWS_H
+#define DISTINCT_ROWS_H
+
+#include "executor/result_batch.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ariane_xml {
+
+// 128-bit hash of a row's values (column names are not part of it).
+// Values are length-prefixed, so ("a|", "b") and ("a", "|b") differ.
+struct RowHash {
+    uint64_t low = 0;
+    uint64_t high = 0;
+
+    static RowHash of(const ResultRow& row);
+
+    // Hash of the values of columns [begin, end) only
+    static RowHash of(const ResultRow& row, size_t begin, size_t end);
+
+    // Same hash for a row of a batch
+    static RowHash of(const ResultBatch& batch, size_t row);
+
+    bool operator==(const RowHash& other) const { return low == other.low && high == other.high; }
+};
+
+// DISTINCT applied while rows are produced, keeping the first copy of each
+// row in file order. Rows are offered file by file (in any file order) and
+// appended to a ResultBatch: a row equal to one kept from an earlier or the
+// same file is not appended, and a kept row from a later file is marked
+// dropped in favour of the new one. Rows are compared value by value when
+// their hashes match; the table is open addressing over the hashes (no
+// allocation per row). Not thread-safe: use one table per worker.
+class DistinctRows {
+public:
+    explicit DistinctRows(ResultBatch& batch) : batch_(&batch) {}
+
+    // Offer a row of file 'fileIndex'
+    void append(const ResultRow& row, size_t fileIndex);
+
+    // Offer row 'row' of another batch with the same columns, for rows
+    // offered in their final order: one equal to a kept row is skipped.
+    // 'codes' is kept across rows of the same batch (see ResultBatch::append).
+    void append(const ResultBatch& other, size_t row, ResultBatch::CodeMap& codes);
+
+    // Batch rows that were kept at first and later superseded
+    const std::vector<bool>& dropped() const { return dropped_; }
+
+    // Keep only the first copy of each row of 'batch'
+    static void removeDuplicates(ResultBatch& batch);
+
+private:
+    struct Slot {
+        RowHash hash;
+        size_t row = 0;  // Batch row + 1; 0 for a free slot
+        size_t fileIndex = 0;
+    };
+
+    // The slot holding the row whose values are valueAt(0), valueAt(1), ...,
+    // or the free slot it would take
+    template <typename ValueAt>
+    Slot& find(const RowHash& hash, ValueAt valueAt);
+
+    // Claim a free slot returned by find() for batch row 'row'
+    void claim(Slot& slot, const RowHash& hash, size_t row, size_t fileIndex);
+
+    ResultBatch* batch_;
+    std::vector<Slot> slots_;  // Power of two, at most half full
+    size_t size_ = 0;
+    std::vector<bool> dropped_;
+};
+
+} // namespace ariane_xml
+
+#endif // DISTINCT_ROWS_H
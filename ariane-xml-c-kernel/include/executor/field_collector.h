@@ -0,0 +1,102 @@
+#ifndef FIELD_COLLECTOR_H
+#define FIELD_COLLECTOR_H
+
+#include "parser/ast.h"
+#include "executor/xml_navigator.h"
+#include "executor/path_automaton.h"
+#include <cstdint>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ariane_xml {
+
+// Collects the values of every SELECT field in one document-order pass,
+// with the same results as calling XmlNavigator::extractValues per field.
+// All element paths are compiled into one PathAutomaton; attribute fields
+// are checked on each element. Fed by a DOM walk (XmlNavigator) or by
+// stream events (StreamScanner).
+//
+// A value slot is opened when a matching element starts and filled by that
+// element's first text child, which is what pugi::xml_node::child_value()
+// returns.
+//
+// With a 'limit' (LIMIT rows), full() turns true once every field holds that
+// many values that can no longer change, so the feeder can stop reading.
+// Ambiguous partial paths are then only detected among the elements read.
+class FieldCollector {
+public:
+    static constexpr size_t NO_LIMIT = SIZE_MAX;
+
+    explicit FieldCollector(const std::vector<FieldPath>& fields, size_t limit = NO_LIMIT);
+
+    // 'attributeValue(name)' returns the element's first attribute with that
+    // name, or nullptr
+    template <typename AttributeLookup>
+    void startElement(std::string_view name, AttributeLookup&& attributeValue) {
+        enterElement(name);
+        for (size_t f : attributeFields_) {
+            const char* value = attributeValue(fields_[f].field->attribute_name);
+            if (value && *value) {
+                fields_[f].values.emplace_back(value);
+                ++fields_[f].filled;
+                settle(f);
+            }
+        }
+    }
+
+    // Character data directly inside the current element
+    void text(std::string_view value);
+
+    void endElement();
+
+    // Whether every field already holds 'limit' values
+    bool full() const { return openFields_ == 0; }
+
+    // Per-field results; throws the same ambiguous partial path error as
+    // XmlNavigator::extractValues (first offending field wins)
+    void finish(const std::string& filename, std::vector<std::vector<XmlResult>>& values);
+
+private:
+    enum class FieldKind { FILENAME, ATTRIBUTE, ELEMENT, NONE };
+
+    struct FieldState {
+        const FieldPath* field = nullptr;
+        FieldKind kind = FieldKind::NONE;
+        bool anchored = false;              // Matches the document element only
+        std::vector<std::string> values;    // One slot per match, empty ones dropped at the end
+        std::set<std::string> fullPaths;    // Distinct full paths seen (partial paths only)
+        size_t filled = 0;                  // Non-empty values
+        size_t pending = 0;                 // Slots still waiting for their text
+        bool done = false;                  // 'limit' values are settled
+    };
+
+    struct Frame {
+        PathAutomaton::State state = PathAutomaton::START;
+        std::vector<std::pair<size_t, size_t>> waiting;  // (field, slot) filled by first text child
+        bool hasText = false;
+    };
+
+    void enterElement(std::string_view name);
+
+    // Mark field 'f' done once its first 'limit' values can't change
+    void settle(size_t f);
+
+    std::vector<FieldState> fields_;
+    std::vector<size_t> attributeFields_;
+    std::vector<size_t> patternField_;   // Automaton pattern id -> field index
+    PathAutomaton automaton_;
+
+    std::vector<std::string> path_;      // Element names, reused across siblings
+    std::vector<Frame> frames_;          // Indexed by depth, reused as elements open and close
+    size_t depth_ = 0;
+    bool sawDocumentElement_ = false;
+
+    size_t limit_;
+    size_t openFields_ = SIZE_MAX;       // Fields not done yet; SIZE_MAX: never full
+};
+
+} // namespace ariane_xml
+
+#endif // FIELD_COLLECTOR_H
@@ -0,0 +1,66 @@
+#ifndef FILE_SCHEDULER_H
+#define FILE_SCHEDULER_H
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace ariane_xml {
+
+// Per-worker accounting for one multi-threaded scan
+struct WorkerStats {
+    size_t files_processed = 0;
+    size_t files_stolen = 0;        // Files taken from another worker's queue
+    uintmax_t bytes_processed = 0;
+    double busy_seconds = 0.0;      // Time spent inside processFile
+    double idle_seconds = 0.0;      // Scan wall time not spent processing
+};
+
+// Work-stealing scheduler for file-level parallelism.
+// Files are sorted by size (largest first) and dealt to the worker with the
+// fewest assigned bytes, so every worker starts on one of the biggest files.
+// A worker whose queue runs dry steals the largest pending file from the
+// worker with the most pending bytes, which keeps giants from queueing
+// behind each other and bounds the straggler tail.
+//
+// Scans that stop early (LIMIT without ORDER BY) need the low file indices
+// done first instead: in FILE_ORDER the files are dealt round-robin in
+// index order, and a thief takes the lowest pending index.
+class FileScheduler {
+public:
+    enum class Order {
+        LARGEST_FIRST,
+        FILE_ORDER
+    };
+
+    FileScheduler(const std::vector<uintmax_t>& fileSizes, size_t workerCount,
+                  Order order = Order::LARGEST_FIRST);
+
+    FileScheduler(const FileScheduler&) = delete;
+    FileScheduler& operator=(const FileScheduler&) = delete;
+
+    // Get the next file for a worker. Returns false once every file has
+    // been handed out. 'stolen' is set when the file came from another queue.
+    bool next(size_t workerId, size_t& fileIndex, bool& stolen);
+
+    size_t workerCount() const { return queues_.size(); }
+
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<size_t> files;              // In the scheduler's order
+        uintmax_t pendingBytes = 0;
+    };
+
+    bool popFront(WorkerQueue& queue, size_t& fileIndex);
+
+    std::vector<uintmax_t> sizes_;
+    Order order_;
+    std::vector<std::unique_ptr<WorkerQueue>> queues_;
+};
+
+} // namespace ariane_xml
+
+#endif // FILE_SCHEDULER_H
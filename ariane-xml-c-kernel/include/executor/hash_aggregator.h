@@ -0,0 +1,113 @@
+#ifndef HASH_AGGREGATOR_H
+#define HASH_AGGREGATOR_H
+
+#include "parser/ast.h"
+#include "executor/query_executor.h"
+#include "executor/distinct_rows.h"
+#include "executor/compiled_predicate.h"
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ariane_xml {
+
+// What an aggregate query computes from the rows its scan produces. Each
+// scanned row holds one column per GROUP BY field, then one column per
+// SELECT field: the argument of an aggregate, or the plain field's value.
+struct AggregatePlan {
+    struct Column {
+        AggregateFunc func = AggregateFunc::NONE;  // NONE: first value in file order
+        std::string name;                          // Output column name
+        FieldPath field;                           // SELECT field it comes from
+    };
+
+    // Value a HAVING condition tests: a group key or an output column
+    struct HavingSource {
+        bool groupKey = false;
+        size_t index = 0;
+    };
+
+    explicit AggregatePlan(const Query& query);
+
+    size_t groupColumns = 0;
+    std::vector<std::string> groupFields;  // GROUP BY paths, leading dot dropped
+    std::vector<Column> columns;           // In SELECT order
+
+    // HAVING, with the source of each condition resolved against the GROUP
+    // BY and SELECT fields. Conditions naming neither are false.
+    CompiledPredicate having;
+    std::unordered_map<const WhereCondition*, HavingSource> havingSources;
+
+    // No FOR, no GROUP BY and only aggregates: each aggregate depends on
+    // its own field's values alone, so the scan can fold those directly
+    // (HashAggregator::addColumns) instead of building rows
+    bool columnwise = false;
+};
+
+// Hash aggregation: folds scanned rows into per-group partial aggregates
+// (count, numeric count, sum, min, max) as they arrive, so member rows are
+// never kept; memory grows with the number of groups, not of rows. Each
+// worker fills its own aggregator and the partials are merged once after
+// the scan. Sums are compensated, so the merge order doesn't show in the
+// result. Not thread-safe.
+class HashAggregator {
+public:
+    explicit HashAggregator(const AggregatePlan& plan);
+
+    // Fold the rows file 'fileIndex' produced into their groups
+    void add(const std::vector<ResultRow>& rows, size_t fileIndex);
+
+    // Fold one file's per-column values (as zipFieldValues takes them) into
+    // the single group; same result as add() on the zipped rows. Only for
+    // columnwise plans.
+    void addColumns(const std::vector<std::vector<XmlResult>>& columns);
+
+    // Fold another worker's groups into these
+    void merge(const HashAggregator& other);
+
+    // One row per group passing HAVING, in group value order. Without
+    // GROUP BY there is at most one row, also when nothing was scanned.
+    std::vector<ResultRow> take();
+
+private:
+    struct Accumulator {
+        size_t count = 0;    // Non-empty values
+        size_t numbers = 0;  // Values that parse as numbers
+        double sum = 0.0;
+        double compensation = 0.0;  // Low-order bits lost from 'sum'
+        double min = 0.0;
+        double max = 0.0;
+
+        // COUNT only needs to know the value is there, not its number
+        void add(const std::string& value, bool numeric);
+        void addNumber(double value);
+        void addToSum(double value);
+        void merge(const Accumulator& other);
+        std::string result(AggregateFunc func) const;
+    };
+
+    struct Group {
+        RowHash hash;
+        std::vector<std::string> key;
+        std::vector<Accumulator> accumulators;  // One per SELECT column
+        std::vector<std::string> firstValues;   // Plain columns' values, from 'firstFile'
+        size_t firstFile = 0;
+    };
+
+    // Slot of the group for which sameKey(group) holds, or the free slot
+    // such a group would take
+    template <typename SameKey>
+    size_t findSlot(const RowHash& hash, SameKey sameKey) const;
+
+    // New group in the free slot 'slot'
+    Group& addGroup(size_t slot, const RowHash& hash, std::vector<std::string> key, size_t fileIndex);
+
+    const AggregatePlan* plan_;
+    std::vector<Group> groups_;
+    std::vector<size_t> slots_;  // Group index + 1, 0 for free; power of two, at most half full
+};
+
+} // namespace ariane_xml
+
+#endif // HASH_AGGREGATOR_H
@@ -0,0 +1,62 @@
+#ifndef PATH_AUTOMATON_H
+#define PATH_AUTOMATON_H
+
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace ariane_xml {
+
+// Matches a set of element paths while descending a document, one element
+// name at a time. Patterns are suffixes of the element's full path
+// (".a.b" matches x.a.b), or, when anchored, the full path itself. The
+// NFA over all patterns is determinised lazily: each state caches its
+// transitions per symbol, and names that occur in no pattern share one
+// symbol. Callers keep a stack of states alongside the element stack.
+class PathAutomaton {
+public:
+    using State = uint32_t;
+    static constexpr State START = 0;  // Above the document element
+
+    // Register a pattern (before the first step). Returns its id.
+    size_t addPattern(const std::vector<std::string>& components, bool anchored);
+
+    // State of a child element named 'name' whose parent is in 'state'
+    State step(State state, std::string_view name);
+
+    // Patterns matched by an element whose state is 'state'
+    const std::vector<uint32_t>& accepted(State state) const { return accepts_[state]; }
+
+    size_t patternCount() const { return patterns_.size(); }
+
+private:
+    using Item = std::pair<uint32_t, uint32_t>;  // (pattern, components matched so far)
+
+    static constexpr State UNKNOWN = UINT32_MAX;
+    static constexpr uint32_t OTHER_SYMBOL = 0;
+
+    struct Pattern {
+        std::vector<uint32_t> symbols;
+        bool anchored = false;
+    };
+
+    uint32_t symbolOf(std::string_view name) const;
+    State intern(std::vector<Item> items);
+
+    std::vector<Pattern> patterns_;
+    std::deque<std::string> names_;                          // Owns the strings symbols_ points into
+    std::unordered_map<std::string_view, uint32_t> symbols_;
+    std::vector<std::vector<Item>> states_;
+    std::vector<std::vector<uint32_t>> accepts_;
+    std::vector<std::vector<State>> transitions_;            // [state][symbol]
+    std::map<std::vector<Item>, State> stateIds_;
+};
+
+} // namespace ariane_xml
+
+#endif // PATH_AUTOMATON_H
@@ -3,17 +3,23 @@
 
 #include "parser/ast.h"
 #include "executor/xml_navigator.h"
+#include "executor/compiled_predicate.h"
+#include "executor/file_scheduler.h"
+#include "executor/result_batch.h"
 #include <vector>
 #include <string>
 #include <utility>
 #include <atomic>
 #include <functional>
+#include <limits>
 #include <map>
 
 namespace ariane_xml {
 
-// Result row (multiple fields) - using vector to preserve field order
-using ResultRow = std::vector<std::pair<std::string, std::string>>;
+class ThreadPool;
+class DocumentCache;
+class ElementIndex;
+struct AggregatePlan;
 
 // Progress callback: (completed_files, total_files, thread_count)
 using ProgressCallback = std::function<void(size_t, size_t, size_t)>;
@@ -24,32 +30,51 @@ struct ExecutionStats {
     size_t thread_count = 0;
     double execution_time_seconds = 0.0;
     bool used_threading = false;
+    std::vector<WorkerStats> worker_stats;  // One entry per worker (threaded scans only)
+};
+
+// XML file found by a directory scan, with its size for scheduling
+struct XmlFileInfo {
+    std::string path;
+    uintmax_t size = 0;
 };
 
 class QueryExecutor {
 public:
+    // Every entry point takes an optional worker pool (normally the session's,
+    // see AppContext::getThreadPool). Without one, threaded scans use a
+    // temporary pool that lives for the duration of the query. Likewise an
+    // optional document cache (AppContext::getDocumentCache) lets repeated
+    // queries reuse parsed files; without one every file is parsed per query.
+
     // Execute the query and return results
-    static std::vector<ResultRow> execute(const Query& query);
+    static ResultBatch execute(const Query& query, ThreadPool* pool = nullptr, DocumentCache* cache = nullptr);
 
     // Execute with a specific list of files (for filtering)
-    static std::vector<ResultRow> executeWithFiles(
+    static ResultBatch executeWithFiles(
         const Query& query,
-        const std::vector<std::string>& xmlFiles
+        const std::vector<std::string>& xmlFiles,
+        ThreadPool* pool = nullptr,
+        DocumentCache* cache = nullptr
     );
 
     // Execute with progress tracking (for VERBOSE mode)
-    static std::vector<ResultRow> executeWithProgress(
+    static ResultBatch executeWithProgress(
         const Query& query,
         ProgressCallback progressCallback,
-        ExecutionStats* stats = nullptr
+        ExecutionStats* stats = nullptr,
+        ThreadPool* pool = nullptr,
+        DocumentCache* cache = nullptr
     );
 
     // Execute with progress tracking and specific file list
-    static std::vector<ResultRow> executeWithProgressAndFiles(
+    static ResultBatch executeWithProgressAndFiles(
         const Query& query,
         const std::vector<std::string>& xmlFiles,
         ProgressCallback progressCallback,
-        ExecutionStats* stats = nullptr
+        ExecutionStats* stats = nullptr,
+        ThreadPool* pool = nullptr,
+        DocumentCache* cache = nullptr
     );
 
     // Validate query for ambiguous attributes (used in VERBOSE mode)
@@ -65,31 +90,145 @@ public:
     // Get all XML files from a path (made public for filtering)
     static std::vector<std::string> getXmlFiles(const std::string& path);
 
+    // Get all XML files from a path together with their sizes
+    static std::vector<XmlFileInfo> scanXmlFiles(const std::string& path);
+
 private:
+    // Row limit meaning "every row"
+    static constexpr size_t NO_ROW_LIMIT = std::numeric_limits<size_t>::max();
+
+    // Shared execution pipeline behind every public entry point:
+    // scan (threaded when worthwhile), then DISTINCT / ORDER BY / OFFSET / LIMIT
+    static ResultBatch executePipeline(
+        const Query& query,
+        const std::vector<XmlFileInfo>& xmlFiles,
+        ProgressCallback progressCallback,
+        ExecutionStats* stats,
+        ThreadPool* pool,
+        DocumentCache* cache
+    );
 
-    // Process a single XML file
+    // Run processFile over all files (serially or threaded) and return
+    // the rows concatenated in file order, each file's rows moved into the
+    // batch as soon as they are produced. With 'topK' > 0 only the first
+    // topK rows in ORDER BY order are kept (sorted). With a 'rowLimit', only
+    // the first rowLimit rows in file order are produced: files that can't
+    // contribute any more are skipped and documents are left part way. With
+    // an 'aggregate' plan, each file's rows are folded into per-worker
+    // partial aggregates and the result is one row per group.
+    static ResultBatch scanFiles(
+        const std::vector<XmlFileInfo>& xmlFiles,
+        const Query& query,
+        size_t threadCount,
+        ProgressCallback progressCallback,
+        ExecutionStats* stats,
+        ThreadPool* pool,
+        DocumentCache* cache,
+        size_t topK = 0,
+        size_t rowLimit = NO_ROW_LIMIT,
+        const AggregatePlan* aggregate = nullptr
+    );
+
+    // Process a single XML file (streamed when large enough and the query
+    // allows it, see processFileStreaming). At most 'rowLimit' rows are
+    // returned, the first ones in document order.
     static std::vector<ResultRow> processFile(
+        const XmlFileInfo& file,
+        const Query& query,
+        const QueryPredicates& predicates,
+        DocumentCache* cache,
+        size_t rowLimit = NO_ROW_LIMIT
+    );
+
+    // Evaluate the query against a loaded document, using its element index
+    // for name and path lookups when given
+    static std::vector<ResultRow> processDocument(
+        const pugi::xml_document& doc,
         const std::string& filepath,
-        const Query& query
+        const std::string& filename,
+        const Query& query,
+        const QueryPredicates& predicates,
+        const ElementIndex* index,
+        size_t rowLimit = NO_ROW_LIMIT
+    );
+
+    // Values of each SELECT field in a document, as zipFieldValues takes
+    // them (no WHERE, no FOR); with a row limit, at least the values the
+    // first 'rowLimit' rows need
+    static void extractFieldValues(
+        const pugi::xml_document& doc,
+        const std::string& filename,
+        const Query& query,
+        const ElementIndex* index,
+        std::vector<std::vector<XmlResult>>& fieldResults,
+        size_t rowLimit = NO_ROW_LIMIT
+    );
+
+    // extractFieldValues for a file, streamed or loaded as processFile
+    // would; for scans that fold values without building rows
+    static void processFileValues(
+        const XmlFileInfo& file,
+        const Query& query,
+        DocumentCache* cache,
+        std::vector<std::vector<XmlResult>>& fieldResults
+    );
+
+    // Evaluate the query with StreamScanner instead of a DOM. Returns false
+    // (with 'results' left empty) when the query shape isn't supported or the
+    // file can't be streamed; the caller then loads the document.
+    static bool processFileStreaming(
+        const std::string& filepath,
+        const std::string& filename,
+        const Query& query,
+        const QueryPredicates& predicates,
+        std::vector<ResultRow>& results,
+        size_t rowLimit = NO_ROW_LIMIT
+    );
+
+    // Combine per-field value lists into rows (no WHERE, no FOR)
+    static std::vector<ResultRow> zipFieldValues(
+        const Query& query,
+        const std::vector<std::vector<XmlResult>>& fieldResults,
+        size_t rowLimit = NO_ROW_LIMIT
+    );
+
+    // Rows for a multi-component WHERE field, evaluated on the nodes below
+    // 'root' matching the field's parent path
+    static void collectWhereRows(
+        const pugi::xml_node& root,
+        const Query& query,
+        const QueryPredicates& predicates,
+        const std::vector<std::string>& parentPath,
+        const std::string& filename,
+        std::vector<ResultRow>& results,
+        const ElementIndex* index = nullptr,
+        size_t rowLimit = NO_ROW_LIMIT
     );
 
     // Process a single XML file with FOR clause context binding
     static std::vector<ResultRow> processFileWithForClauses(
         const std::string& filepath,
         const Query& query,
+        const QueryPredicates& predicates,
         const pugi::xml_document& doc,
-        const std::string& filename
+        const std::string& filename,
+        const ElementIndex* index,
+        size_t rowLimit = NO_ROW_LIMIT
     );
 
     // Recursive function to process nested FOR clauses
     static void processNestedForClauses(
         const pugi::xml_node& currentContext,
         const Query& query,
+        const QueryPredicates& predicates,
         std::map<std::string, pugi::xml_node>& varContext,
         std::map<std::string, size_t>& positionContext,
         size_t forClauseIndex,
         const std::string& filename,
-        std::vector<ResultRow>& results
+        std::vector<ResultRow>& results,
+        const ElementIndex* index = nullptr,
+        size_t positionBase = 0,  // Matches of the first clause preceding this context (streamed subtrees)
+        size_t rowLimit = NO_ROW_LIMIT
     );
 
     // Resolve field value using variable context
@@ -98,27 +237,33 @@ private:
         const std::map<std::string, pugi::xml_node>& varContext,
         const std::map<std::string, size_t>& positionContext,
         const pugi::xml_node& fallbackContext,
-        const Query& query
+        const Query& query,
+        const ElementIndex* index = nullptr
     );
 
-    // Evaluate WHERE expression with variable context
+    // Evaluate the compiled WHERE clause with variable context
     static bool evaluateWhereWithContext(
         const std::map<std::string, pugi::xml_node>& varContext,
         const std::map<std::string, size_t>& positionContext,
-        const WhereExpr* expr,
-        const Query& query
+        const CompiledPredicate& where,
+        const Query& query,
+        const ElementIndex* index = nullptr
     );
 
-    // Execute query with multi-threading
-    static std::vector<ResultRow> executeMultithreaded(
-        const std::vector<std::string>& xmlFiles,
+    // Execute query on pool workers (work-stealing, largest files first)
+    static ResultBatch executeMultithreaded(
+        const std::vector<XmlFileInfo>& xmlFiles,
         const Query& query,
+        const QueryPredicates& predicates,
         size_t threadCount,
-        std::atomic<size_t>* completedCounter = nullptr
+        ThreadPool* pool,
+        DocumentCache* cache,
+        size_t topK,
+        size_t rowLimit,
+        const AggregatePlan* aggregate,
+        std::atomic<size_t>* completedCounter = nullptr,
+        std::vector<WorkerStats>* workerStats = nullptr
     );
-
-    // Compute aggregate function value
-    static std::string computeAggregate(const FieldPath& field, const std::vector<ResultRow>& allResults);
 };
 
 } // namespace ariane_xml
@@ -0,0 +1,59 @@
+#ifndef REGEX_MATCHER_H
+#define REGEX_MATCHER_H
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <regex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ariane_xml {
+
+// LIKE / NOT LIKE pattern (the ECMAScript syntax from parseRegexPattern)
+// with std::regex_search semantics, compiled once per query:
+// - patterns that are a plain literal, optionally anchored or wrapped in
+//   '.*', become a substring / prefix / suffix / equality check;
+// - other regular patterns become a byte DFA, run only when the text
+//   contains the literal every match requires (memchr/memmem prefilter);
+// - constructs the DFA can't express (back-references, lookahead, word
+//   boundaries, ...) keep using std::regex.
+// Immutable once built, so it can be shared between worker threads.
+class RegexMatcher {
+public:
+    enum class Strategy { CONTAINS, PREFIX, SUFFIX, EQUALS, DFA, BACKTRACKING };
+
+    // Throws std::regex_error for patterns std::regex rejects
+    explicit RegexMatcher(const std::string& pattern);
+
+    // True if the pattern matches somewhere in 'text'
+    bool search(std::string_view text) const;
+
+    Strategy strategy() const { return strategy_; }
+
+    // Literal checked before the DFA runs (whole literal for the literal
+    // strategies); empty when there is none
+    const std::string& requiredLiteral() const { return literal_; }
+
+private:
+    bool buildDfa(const std::string& pattern);
+    bool runDfa(std::string_view text) const;
+
+    Strategy strategy_ = Strategy::BACKTRACKING;
+    std::string literal_;
+
+    // DFA: bytes are mapped to classes that no pattern set tells apart
+    std::array<uint8_t, 256> byteClass_{};
+    size_t classCount_ = 0;
+    std::vector<uint32_t> transitions_;  // [state * classCount_ + class]
+    std::vector<uint8_t> accepts_;       // MATCHED / MATCHED_AT_END flags per state
+    uint32_t start_ = 0;
+    bool matchesEmpty_ = false;          // Whether the empty text matches
+
+    std::unique_ptr<std::regex> regex_;  // BACKTRACKING
+};
+
+} // namespace ariane_xml
+
+#endif // REGEX_MATCHER_H
@@ -0,0 +1,128 @@
+#ifndef RESULT_BATCH_H
+#define RESULT_BATCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace ariane_xml {
+
+// Result row (multiple fields) - using vector to preserve field order.
+// Produced per file by the scan; whole results are kept as a ResultBatch.
+using ResultRow = std::vector<std::pair<std::string, std::string>>;
+
+// One column of a ResultBatch. Values are stored back to back in one
+// buffer. A column starts dictionary encoded (each distinct value stored
+// once, rows hold 4-byte codes), which suits file names, codes and other
+// repeated values; once distinct values make up more than half the rows
+// the dictionary no longer pays off and the column switches to one stored
+// value per row.
+class ResultColumn {
+public:
+    static constexpr uint32_t UNMAPPED = UINT32_MAX;
+
+    size_t size() const { return rows_; }
+
+    std::string_view value(size_t row) const {
+        return entry(dictionary_ ? codes_[row] : row);
+    }
+
+    void append(std::string_view value);
+
+    // Append rows [begin, end) of another column. 'codes' maps the other
+    // column's dictionary entries to this column's (UNMAPPED until first
+    // seen), so each distinct value is looked up once however many rows
+    // use it; keep it for later appends from the same column. Plain rows
+    // are copied as one block when this column is plain too.
+    void append(const ResultColumn& other, size_t begin, size_t end, std::vector<uint32_t>& codes);
+
+    bool dictionaryEncoded() const { return dictionary_; }
+
+    // Approximate heap footprint
+    size_t memoryBytes() const;
+
+private:
+    std::string_view entry(size_t index) const {
+        size_t begin = index == 0 ? 0 : ends_[index - 1];
+        return std::string_view(bytes_.data() + begin, ends_[index] - begin);
+    }
+
+    void addEntry(std::string_view value);
+    void growLookup();
+    void dropDictionary();
+
+    std::string bytes_;           // Entries back to back
+    std::vector<uint64_t> ends_;  // End offset of each entry
+    std::vector<uint32_t> codes_;   // Entry of each row (dictionary encoded only)
+    std::vector<uint32_t> lookup_;  // Entry + 1 by hash, 0 for free; power of two, at most half full
+    size_t rows_ = 0;
+    bool dictionary_ = true;
+};
+
+// Query results in columns: the column names are stored once for the whole
+// result instead of in every row, and each column is a ResultColumn.
+// Columns are matched by position; all rows have every column.
+class ResultBatch {
+public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    // Per column, another batch's dictionary codes translated to this
+    // batch's (see ResultColumn::append). Valid for appends from that one
+    // batch while neither changes otherwise.
+    using CodeMap = std::vector<std::vector<uint32_t>>;
+
+    ResultBatch() = default;
+    explicit ResultBatch(std::vector<std::string> columnNames);
+
+    static ResultBatch fromRows(const std::vector<ResultRow>& rows);
+
+    const std::vector<std::string>& columnNames() const { return names_; }
+    size_t columnCount() const { return names_.size(); }
+    size_t rowCount() const { return rows_; }
+    bool empty() const { return rows_ == 0; }
+
+    // First column with this name, or npos
+    size_t columnIndex(const std::string& name) const;
+
+    std::string_view value(size_t row, size_t column) const { return columns_[column].value(row); }
+
+    // The row with its column names, as the scan produced it
+    ResultRow row(size_t row) const;
+
+    // Append a row. The first row sets the columns of a batch that has none;
+    // afterwards a missing value is empty and an extra one is dropped.
+    void append(const ResultRow& row);
+
+    // Append rows [begin, end) of a batch with the same columns
+    void append(const ResultBatch& other, size_t begin, size_t end);
+
+    // Same, reusing 'codes' across appends from the same batch, as merging
+    // many runs of one batch does
+    void append(const ResultBatch& other, size_t begin, size_t end, CodeMap& codes);
+
+    // The given rows, in the given order
+    ResultBatch select(const std::vector<size_t>& rows) const;
+
+    // Rows [begin, end)
+    ResultBatch slice(size_t begin, size_t end) const;
+
+    void removeColumn(size_t column);
+
+    // Remove every row, keeping the columns
+    void clearRows();
+
+    // Approximate heap footprint
+    size_t memoryBytes() const;
+
+private:
+    std::vector<std::string> names_;
+    std::vector<ResultColumn> columns_;
+    size_t rows_ = 0;
+};
+
+} // namespace ariane_xml
+
+#endif // RESULT_BATCH_H
@@ -0,0 +1,78 @@
+#ifndef ROW_SORTER_H
+#define ROW_SORTER_H
+
+#include "parser/ast.h"
+#include "executor/result_batch.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ariane_xml {
+
+class ThreadPool;
+
+// ORDER BY keys of a result row, decoded once into typed values so that
+// comparisons don't look columns up or parse numbers again. Within a key,
+// missing/empty values come first, then values that parse as numbers (in
+// numeric order), then other text (byte order); DESC reverses the key.
+// This is a strict weak order, so any sort algorithm and any way of
+// splitting the rows gives the same result.
+class RowOrder {
+public:
+    struct Key {
+        enum class Kind : uint8_t { EMPTY, NUMBER, TEXT };
+
+        Kind kind = Kind::EMPTY;
+        double number = 0.0;
+        std::string_view text;  // Points into the decoded row
+    };
+
+    explicit RowOrder(const std::vector<OrderByField>& fields);
+
+    size_t keyCount() const { return names_.size(); }
+
+    // Fill keys[0, keyCount()) from 'row'; the row must outlive the keys
+    // (moving the row itself is fine, its strings stay in place)
+    void decode(const ResultRow& row, Key* keys) const;
+
+    // Column of each key in 'batch' (first one with the key's name), or
+    // ResultBatch::npos when the batch has none
+    std::vector<size_t> columnsIn(const ResultBatch& batch) const;
+
+    // Same as decode(batch.row(row)), with 'columns' from columnsIn(); the
+    // keys point into the batch
+    void decode(const ResultBatch& batch, size_t row, const size_t* columns, Key* keys) const;
+
+    // <0 if 'a' sorts first, >0 if 'b' does, 0 if they tie on every key
+    int compare(const Key* a, const Key* b) const;
+
+private:
+    std::vector<std::string> names_;
+    std::vector<bool> descending_;
+};
+
+// Sorts a result batch on every ORDER BY key. Ties keep their input order.
+// Key decoding and sorting are spread over the pool (parallel merge sort).
+// The sort is in memory on purpose: it runs on a batch the scan already
+// holds whole, and the formatter takes a whole batch, so writing sorted
+// runs to disk here would only add a copy. Bounding ORDER BY memory needs
+// the scan to spill runs and the output to stream their merge.
+class RowSorter {
+public:
+    explicit RowSorter(const std::vector<OrderByField>& fields, ThreadPool* pool = nullptr);
+
+    void sort(ResultBatch& rows) const;
+
+private:
+    // Row indices of 'rows' in sorted order
+    std::vector<size_t> sortedOrder(const ResultBatch& rows) const;
+
+    RowOrder order_;
+    ThreadPool* pool_;
+};
+
+} // namespace ariane_xml
+
+#endif // ROW_SORTER_H
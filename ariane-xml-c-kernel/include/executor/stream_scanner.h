@@ -0,0 +1,65 @@
+#ifndef STREAM_SCANNER_H
+#define STREAM_SCANNER_H
+
+#include "parser/ast.h"
+#include "executor/xml_navigator.h"
+#include "executor/field_collector.h"
+#include <pugixml.hpp>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace ariane_xml {
+
+// Element path selecting the subtrees captureSubtrees() hands out
+struct SubtreePattern {
+    std::vector<std::string> components;  // Suffix the element's full path must end with
+    bool anchored = false;                // Full path must also start with components
+};
+
+// Receives one captured subtree: a standalone document holding the ancestor
+// chain (names only) and the complete matching element, plus the number of
+// matching elements that came before it in the file. Returns false to stop
+// the scan (e.g. once LIMIT rows are known).
+using SubtreeHandler = std::function<bool(const pugi::xml_document& fragment, size_t matchesBefore)>;
+
+// Streaming scan engine. Evaluates a query while the file is read through
+// XmlStreamReader instead of loading a DOM, so memory stays bounded by the
+// subtree being looked at rather than the size of the file. The query
+// executor decides which queries can be answered this way; everything else
+// (and any file the reader rejects) goes through the DOM path.
+class StreamScanner {
+public:
+    // Files at least this large are streamed when the query allows it.
+    // Defaults to 32 MiB; ARIANE_XML_STREAM_THRESHOLD (bytes) overrides it.
+    static uintmax_t minimumFileSize();
+
+    // Values of each SELECT field in document order, identical to calling
+    // XmlNavigator::extractValues per field on the loaded document (including
+    // the ambiguous partial path error). With a 'limit', reading stops once
+    // every field has that many values (see FieldCollector). Returns false if
+    // the file can't be streamed.
+    static bool extractValues(
+        const std::string& filepath,
+        const std::string& filename,
+        const std::vector<FieldPath>& fields,
+        std::vector<std::vector<XmlResult>>& values,
+        size_t limit = FieldCollector::NO_LIMIT
+    );
+
+    // Stream the file and rebuild each outermost element matching 'pattern'
+    // as a small document passed to 'handler'. Matches nested inside a
+    // captured element are part of that capture. Stopping from the handler
+    // ends the read there and counts as success. Returns false if the file
+    // can't be streamed; the handler may already have been called by then.
+    static bool captureSubtrees(
+        const std::string& filepath,
+        const SubtreePattern& pattern,
+        const SubtreeHandler& handler
+    );
+};
+
+} // namespace ariane_xml
+
+#endif // STREAM_SCANNER_H
@@ -2,32 +2,64 @@
 #define XML_NAVIGATOR_H
 
 #include "parser/ast.h"
+#include "error/error_codes.h"
 #include <pugixml.hpp>
+#include <cstdint>
+#include <set>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace ariane_xml {
 
+class ElementIndex;
+class CompiledPredicate;
+
 // Represents a single result from XML traversal
 struct XmlResult {
     std::string filename;
     std::string value;
 };
 
+// Lookups accept the document's ElementIndex (see XmlDocument::index) to
+// replace tree walks with index probes. Without it, or for nodes of another
+// document, they walk the tree.
 class XmlNavigator {
 public:
     // Navigate XML document and extract values matching the field path
     static std::vector<XmlResult> extractValues(
         const pugi::xml_document& doc,
         const std::string& filename,
-        const FieldPath& field
+        const FieldPath& field,
+        const ElementIndex* index = nullptr
+    );
+
+    // Values of every field at once, as if extractValues were called per
+    // field: one walk over the document for all of them (see FieldCollector).
+    // With a 'limit', the walk stops once every field has that many values.
+    static void extractValues(
+        const pugi::xml_document& doc,
+        const std::string& filename,
+        const std::vector<FieldPath>& fields,
+        std::vector<std::vector<XmlResult>>& values,
+        size_t limit = SIZE_MAX
     );
 
     // Evaluate WHERE expression (condition or logical combination)
     static bool evaluateWhereExpr(
         const pugi::xml_node& node,
         const WhereExpr* expr,
-        size_t parentDepth = 0
+        size_t parentDepth = 0,
+        const ElementIndex* index = nullptr
+    );
+
+    // Evaluate a compiled WHERE predicate; same result as evaluateWhereExpr
+    // on the expression it was compiled from
+    static bool evaluateWhere(
+        const pugi::xml_node& node,
+        const CompiledPredicate& where,
+        size_t parentDepth = 0,
+        const ElementIndex* index = nullptr
     );
 
     // Evaluate WHERE condition on a specific node
@@ -41,7 +73,8 @@ public:
     static bool evaluateCondition(
         const pugi::xml_node& node,
         const WhereCondition& condition,
-        size_t parentDepth
+        size_t parentDepth,
+        const ElementIndex* index = nullptr
     );
 
     // Helper to navigate nested paths (absolute from current node)
@@ -58,13 +91,22 @@ public:
     static void findNodesByPartialPath(
         const pugi::xml_node& node,
         const std::vector<std::string>& path,
-        std::vector<pugi::xml_node>& results
+        std::vector<pugi::xml_node>& results,
+        const ElementIndex* index = nullptr
     );
 
     // Find first element with given name in XML tree (depth-first search)
     static pugi::xml_node findFirstElementByName(
         const pugi::xml_node& node,
-        const std::string& name
+        const std::string& name,
+        const ElementIndex* index = nullptr
+    );
+
+    // Error raised when a partial path (e.g. ".name") resolves to several
+    // distinct full paths in one document
+    static ArianeError ambiguousPathError(
+        const std::string& partialPath,
+        const std::set<std::string>& fullPaths
     );
 
     // Check if a partial path (2+ components) is ambiguous in the XML tree
@@ -74,24 +116,29 @@ public:
         const std::vector<std::string>& partialPath
     );
 
-private:
-
-    // Get value from node for comparison
-    static std::string getNodeValue(
+    // Value a WHERE condition compares, using a path relative to 'node'
+    // (skipping the first 'offset' components). The view is only valid while
+    // the document is alive.
+    static std::string_view getNodeValueRelative(
         const pugi::xml_node& node,
-        const FieldPath& field
+        const FieldPath& field,
+        size_t offset,
+        const ElementIndex* index
     );
 
-    // Get value from node using relative path (skipping first 'offset' components)
-    static std::string getNodeValueRelative(
+private:
+
+    // Get value from node for comparison. Values are views into the document
+    // (the file mapping for documents from XmlLoader) and are only valid while
+    // it is alive.
+    static std::string_view getNodeValue(
         const pugi::xml_node& node,
-        const FieldPath& field,
-        size_t offset
+        const FieldPath& field
     );
 
     // Compare values
     static bool compareValues(
-        const std::string& nodeValue,
+        std::string_view nodeValue,
         const std::string& targetValue,
         ComparisonOp op,
         bool isNumeric
@@ -9,20 +9,33 @@
 
 namespace ariane_xml {
 
+class ThreadPool;
+
 class XmlGenerator {
 public:
     XmlGenerator();
 
-    // Generate XML instances from schema
+    // Generate XML instances from schema. With a pool, files are generated
+    // in parallel, each worker drawing from its own random generators.
     void generateFiles(
         const XsdSchema& schema,
         int count,
         const std::string& destDir,
-        const std::string& prefix = "generated_"
+        const std::string& prefix = "generated_",
+        ThreadPool* pool = nullptr
     );
 
 private:
     DataGenerator data_gen_;
+    std::mt19937 rng_;  // Drives optional/repeat decisions
+
+    // Generate and save file number 'index' (1-based); returns false on save failure
+    bool generateFile(
+        const XsdSchema& schema,
+        int index,
+        const std::string& destDir,
+        const std::string& prefix
+    );
 
     // Generate a single XML document
     pugi::xml_document generateDocument(const XsdSchema& schema);
@@ -9,36 +9,42 @@
 
 namespace ariane_xml {
 
+// Each parse runs on its own parser object holding that schema's named
+// types, so schemas can be parsed concurrently (CHECK, GENERATE)
 class XsdParser {
 public:
     // Parse an XSD file and return the schema model
     static std::unique_ptr<XsdSchema> parse(const std::string& xsd_file_path);
 
 private:
-    // Store named types for lookup
-    static std::map<std::string, std::shared_ptr<XsdElement>> named_types_;
+    XsdParser() = default;
 
-    static std::shared_ptr<XsdElement> parseElement(
+    std::unique_ptr<XsdSchema> parseSchema(const std::string& xsd_file_path);
+
+    // Named types of the schema being parsed, for lookup
+    std::map<std::string, std::shared_ptr<XsdElement>> named_types_;
+
+    std::shared_ptr<XsdElement> parseElement(
         const pugi::xml_node& node,
         const pugi::xml_document& doc
     );
 
-    static std::shared_ptr<XsdElement> parseComplexType(
+    std::shared_ptr<XsdElement> parseComplexType(
         const pugi::xml_node& complexTypeNode,
         const pugi::xml_document& doc
     );
 
-    static std::shared_ptr<XsdElement> parseSequence(
+    std::shared_ptr<XsdElement> parseSequence(
         const pugi::xml_node& sequenceNode,
         const pugi::xml_document& doc
     );
 
-    static void parseAndStoreNamedTypes(
+    void parseAndStoreNamedTypes(
         const pugi::xml_node& schemaNode,
         const pugi::xml_document& doc
     );
 
-    static std::shared_ptr<XsdElement> createElementFromType(
+    std::shared_ptr<XsdElement> createElementFromType(
         const std::string& typeName,
         const std::string& elementName
     );
@@ -7,8 +7,11 @@
 
 namespace ariane_xml {
 
-// Forward declaration for DSN schema
+// Forward declarations
 class DsnSchema;
+class ThreadPool;
+class DocumentCache;
+class CompiledSchemaCache;
 
 // Query mode enum
 enum class QueryMode {
@@ -19,7 +22,7 @@ enum class QueryMode {
 // Stores application context/settings during a session
 class AppContext {
 public:
-    AppContext() = default;
+    AppContext();
 
     // XSD file path management
     void setXsdPath(const std::string& path);
@@ -54,6 +57,15 @@ public:
     std::optional<std::string> getPseudoConfigPath() const;
     bool hasPseudoConfigPath() const;
 
+    // Worker pool shared by queries and multi-file commands for the whole session
+    std::shared_ptr<ThreadPool> getThreadPool() const;
+
+    // Parsed documents reused across the session's queries (SHOW/CLEAR CACHE)
+    std::shared_ptr<DocumentCache> getDocumentCache() const;
+
+    // Compiled XSD schemas reused across the session's CHECK calls
+    std::shared_ptr<CompiledSchemaCache> getSchemaCache() const;
+
 private:
     std::optional<std::string> xsd_path_;
     std::optional<std::string> dest_path_;
@@ -66,6 +78,11 @@ private:
 
     // Pseudonymisation fields
     std::optional<std::string> pseudo_config_path_;
+
+    // Threads are only started the first time the pool is used
+    std::shared_ptr<ThreadPool> thread_pool_;
+    std::shared_ptr<DocumentCache> document_cache_;
+    std::shared_ptr<CompiledSchemaCache> schema_cache_;
 };
 
 } // namespace ariane_xml
@@ -29,15 +29,18 @@ private:
     bool handleDsnCompareCommand(const std::string& input);
     bool handlePseudonymiseCommand(const std::string& input);
     bool handleListCommand(const std::string& input);
+    bool handleClearCommand(const std::string& input);
 
     void setXsdPath(const std::string& path);
     void setDestPath(const std::string& path);
     void setPseudoConfigPath(const std::string& path);
+    void setCacheBudget(const std::string& megabytes);
 
     void showXsdPath();
     void showDestPath();
     void showMode();
     void showPseudoConfig();
+    void showCache();
     void showPseudonymisationStatus(const std::string& filepath);
 
     void displayAttribute(const DsnAttribute& attr);
@@ -0,0 +1,80 @@
+#ifndef DOCUMENT_CACHE_H
+#define DOCUMENT_CACHE_H
+
+#include "utils/xml_loader.h"
+#include <cstdint>
+#include <filesystem>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace ariane_xml {
+
+// Cache statistics (SHOW CACHE)
+struct DocumentCacheStats {
+    size_t entries = 0;
+    size_t bytes = 0;        // Estimated memory held by cached documents
+    size_t budget = 0;
+    uint64_t hits = 0;
+    uint64_t misses = 0;     // Lookups that had to parse the file
+    uint64_t evictions = 0;
+};
+
+// Parsed documents kept across queries of an interactive session.
+// Entries are keyed by path and only reused while the file's size and
+// modification time are unchanged. The least recently used documents are
+// dropped once the estimated footprint exceeds the memory budget. Safe to use
+// from several worker threads; documents are shared read-only.
+class DocumentCache {
+public:
+    static constexpr size_t DEFAULT_BUDGET = 512 * 1024 * 1024;
+
+    explicit DocumentCache(size_t budgetBytes = DEFAULT_BUDGET);
+
+    // Return the cached document for 'filepath', loading (and caching) it on a
+    // miss. Throws like XmlLoader::load.
+    std::shared_ptr<const XmlDocument> load(const std::string& filepath);
+
+    // True if a document for 'filepath' is cached (it may still be stale)
+    bool contains(const std::string& filepath) const;
+
+    // Change the budget (0 disables caching), evicting as needed
+    void setBudget(size_t budgetBytes);
+
+    // Drop every cached document; returns the number dropped
+    size_t clear();
+
+    DocumentCacheStats stats() const;
+
+private:
+    struct Entry {
+        std::shared_ptr<const XmlDocument> doc;
+        uintmax_t size = 0;
+        std::filesystem::file_time_type mtime;
+        size_t cost = 0;
+        std::list<std::string>::iterator lruPos;
+    };
+
+    // Rough footprint of a parsed document: the file text, pugixml's node
+    // and attribute records, and the element index queries build on it.
+    // Stops counting once past 'limit' and returns what it has so far.
+    static size_t estimateCost(const XmlDocument& doc, uintmax_t fileSize, size_t limit);
+
+    void evictToFit(size_t incoming);  // Caller holds mutex_
+    void erase(std::unordered_map<std::string, Entry>::iterator it);
+
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, Entry> entries_;
+    std::list<std::string> lru_;  // Front = most recently used
+    size_t budget_;
+    size_t bytes_ = 0;
+    uint64_t hits_ = 0;
+    uint64_t misses_ = 0;
+    uint64_t evictions_ = 0;
+};
+
+} // namespace ariane_xml
+
+#endif // DOCUMENT_CACHE_H
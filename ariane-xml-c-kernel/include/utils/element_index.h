@@ -0,0 +1,77 @@
+#ifndef ELEMENT_INDEX_H
+#define ELEMENT_INDEX_H
+
+#include <pugixml.hpp>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace ariane_xml {
+
+// Element-name index over one parsed document, built in a single pass.
+// Each distinct element name (keyed by a view of the name stored in the
+// document, so every name is held once) maps to its elements in document
+// order, tagged with their preorder number. Subtree searches become a range
+// probe on those lists instead of a walk over every node. The index refers
+// to the document's nodes and must not outlive it.
+//
+// Lookups return false when 'scope' is not an element or the document node
+// of the indexed document; callers then fall back to walking the tree.
+class ElementIndex {
+public:
+    explicit ElementIndex(const pugi::xml_document& doc);
+
+    // Elements named 'name' in the subtree of 'scope' (scope included),
+    // in document order
+    bool findByName(
+        const pugi::xml_node& scope,
+        const std::string& name,
+        std::vector<pugi::xml_node>& results
+    ) const;
+
+    // First element named 'name' in the subtree of 'scope' (null if none)
+    bool findFirstByName(
+        const pugi::xml_node& scope,
+        const std::string& name,
+        pugi::xml_node& result
+    ) const;
+
+    // Elements in the subtree of 'scope' whose full path ends with 'path'
+    // (same matching as XmlNavigator::findNodesByPartialPath)
+    bool findByPartialPath(
+        const pugi::xml_node& scope,
+        const std::vector<std::string>& path,
+        std::vector<pugi::xml_node>& results
+    ) const;
+
+    // Number of indexed elements
+    size_t size() const { return subtreeEnd_.size(); }
+
+    // Approximate heap bytes held per indexed element, for callers that
+    // account for an index before it is built
+    static const size_t BYTES_PER_ELEMENT;
+
+private:
+    struct Posting {
+        uint32_t order;       // Preorder number of the element
+        pugi::xml_node node;
+    };
+
+    // Preorder range [begin, end) covered by the subtree of 'scope'
+    bool scopeRange(const pugi::xml_node& scope, uint32_t& begin, uint32_t& end) const;
+
+    // Postings for 'name' starting at preorder number 'begin' (null if the name is absent)
+    const Posting* firstPosting(const std::string& name, uint32_t begin, const Posting*& last) const;
+
+    pugi::xml_node document_;
+    std::unordered_map<std::string_view, std::vector<Posting>> byName_;
+    std::vector<std::pair<const void*, uint32_t>> orderOf_;  // Element -> preorder number, sorted by element
+    std::vector<uint32_t> subtreeEnd_;                        // Preorder number -> one past its last descendant
+};
+
+} // namespace ariane_xml
+
+#endif // ELEMENT_INDEX_H
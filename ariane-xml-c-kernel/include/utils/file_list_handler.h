@@ -10,6 +10,8 @@
 
 namespace ariane_xml {
 
+class ThreadPool;
+
 /**
  * File nature enumeration
  */
@@ -80,9 +82,11 @@ public:
     /**
      * List all XML files in a directory
      * @param directoryPath Path to directory to scan
+     * @param pool Optional worker pool; when given, files are inspected in parallel
      * @return Vector of FileInfo structures, or ArianeError if failed
      */
-    std::variant<std::vector<FileInfo>, ArianeError> listFiles(const std::string& directoryPath);
+    std::variant<std::vector<FileInfo>, ArianeError> listFiles(const std::string& directoryPath,
+                                                               ThreadPool* pool = nullptr);
 
     /**
      * Get information about a single XML file
@@ -0,0 +1,69 @@
+#ifndef QUERY_SERVER_H
+#define QUERY_SERVER_H
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+
+namespace ariane_xml {
+
+class DsnAutoComplete;
+
+// Long-lived query service for front ends such as the Jupyter kernel
+// (ariane-xml --server). Requests and responses are JSON-RPC 2.0 objects,
+// one per line, read from stdin and written to stdout, or exchanged with
+// clients of a Unix socket (served one at a time). The session behind the
+// statement runner (AppContext: mode, XSD and DSN schema, worker pool,
+// document cache) lives as long as the server, so a request pays neither
+// process startup nor schema parsing again.
+//
+// Methods:
+//   execute  {"query": "..."} -> {"output": "...", "stderr": "..."}
+//            Runs one command or query as the interactive shell would (a
+//            trailing ';' is optional). What it prints is returned instead of
+//            written out. A failure is a JSON-RPC error (code -32000) whose
+//            data holds "exit_code", "output" and "stderr" as the command
+//            line would have produced them. Statements can't read stdin:
+//            one that prompts gets no answer and takes its default.
+//   complete {"code": "...", "cursor_pos": n, "version": "P25|P26|AUTO"}
+//            -> [{"completion", "display", "description", "type"}, ...]
+//            DSN suggestions at the cursor, as --autocomplete prints them.
+//            The bundled schema of each version is parsed on its first
+//            request and kept, so a keystroke only pays the lookup.
+//   shutdown -> null, then the server stops
+class QueryServer {
+public:
+    // Runs one statement against the session, printing to std::cout and
+    // std::cerr and throwing on failure as the command line does
+    using StatementRunner = std::function<void(const std::string& statement)>;
+
+    explicit QueryServer(StatementRunner runStatement);
+    ~QueryServer();
+
+    // Serve requests from stdin until EOF or shutdown
+    int serveStdio();
+
+    // Serve clients on a Unix socket created at 'path' (owner access only)
+    // until shutdown; the socket file is removed on return
+    int serveSocket(const std::string& path);
+
+    // Response line (without newline) for one request line; empty when the
+    // request is a notification
+    std::string handle(const std::string& request);
+
+    bool stopped() const { return stopped_; }
+
+private:
+    // Completer for a DSN version, loading its schema on first use; null
+    // when the schema can't be loaded
+    DsnAutoComplete* completer(const std::string& version);
+
+    StatementRunner runStatement_;
+    std::map<std::string, std::unique_ptr<DsnAutoComplete>> completers_;
+    bool stopped_ = false;
+};
+
+} // namespace ariane_xml
+
+#endif // QUERY_SERVER_H
@@ -1,7 +1,7 @@
 #ifndef RESULT_FORMATTER_H
 #define RESULT_FORMATTER_H
 
-#include "executor/query_executor.h"
+#include "executor/result_batch.h"
 #include <vector>
 #include <string>
 #include <ostream>
@@ -13,12 +13,12 @@ class ResultFormatter {
 public:
     // Format and print results to output stream
     static void print(
-        const std::vector<ResultRow>& results,
+        const ResultBatch& results,
         std::ostream& out = std::cout
     );
 
     // Format results as plain text
-    static std::string formatAsText(const std::vector<ResultRow>& results);
+    static std::string formatAsText(const ResultBatch& results);
 };
 
 } // namespace ariane_xml
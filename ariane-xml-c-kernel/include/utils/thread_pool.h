@@ -0,0 +1,57 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ariane_xml {
+
+// Long-lived worker pool shared by everything that fans work out across
+// files (queries, CHECK, GENERATE, LIST). Threads are started on first use
+// and kept until the pool is destroyed, so short queries in an interactive
+// session don't pay for thread creation every time.
+class ThreadPool {
+public:
+    // threadCount == 0 picks one thread per hardware thread
+    explicit ThreadPool(size_t threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Number of worker threads (started or not)
+    size_t size() const { return size_; }
+
+    // Run job(workerId) for every workerId in [0, workerCount) and block until
+    // all of them return. workerCount is capped at size(). The first exception
+    // thrown by a job is rethrown here once every job has finished.
+    // Calls made from inside a pool thread run inline to avoid deadlock.
+    void run(size_t workerCount, const std::function<void(size_t)>& job);
+
+    // Run task(i) for every i in [0, taskCount), handing out indices
+    // dynamically across the pool. Blocks until all tasks are done.
+    void parallelFor(size_t taskCount, const std::function<void(size_t)>& task);
+
+    // Default thread count: hardware concurrency, or 4 if it can't be detected
+    static size_t defaultThreadCount();
+
+private:
+    void start();
+    void workerLoop();
+
+    size_t size_;
+    std::vector<std::thread> threads_;
+    std::deque<std::function<void()>> tasks_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stopping_ = false;
+};
+
+} // namespace ariane_xml
+
+#endif // THREAD_POOL_H
@@ -1,16 +1,57 @@
 #ifndef XML_LOADER_H
 #define XML_LOADER_H
 
+#include "utils/element_index.h"
 #include <pugixml.hpp>
 #include <string>
 #include <memory>
+#include <mutex>
+#include <cstddef>
 
 namespace ariane_xml {
 
+// Document returned by XmlLoader. Regular files are parsed in place over a
+// private (copy-on-write) mapping of the file, so node names and values point
+// straight into the mapping instead of a heap copy. The mapping lives exactly
+// as long as the document; copy out anything that must outlive it.
+class XmlDocument {
+public:
+    XmlDocument();
+    ~XmlDocument();
+
+    XmlDocument(XmlDocument&& other) noexcept;
+    XmlDocument& operator=(XmlDocument&& other) noexcept;
+    XmlDocument(const XmlDocument&) = delete;
+    XmlDocument& operator=(const XmlDocument&) = delete;
+
+    pugi::xml_document& operator*() const { return *doc_; }
+    pugi::xml_document* operator->() const { return doc_.get(); }
+    explicit operator bool() const { return doc_ != nullptr; }
+
+    // Element-name index, built on first use (thread-safe; cached documents
+    // are shared between workers)
+    const ElementIndex& index() const;
+
+private:
+    friend class XmlLoader;
+
+    void release();
+
+    struct IndexSlot {
+        std::once_flag built;
+        std::unique_ptr<ElementIndex> index;
+    };
+
+    std::unique_ptr<pugi::xml_document> doc_;
+    std::unique_ptr<IndexSlot> indexSlot_;
+    void* mapping_ = nullptr;   // Parsed buffer, null when pugixml owns the data
+    size_t mappingSize_ = 0;
+};
+
 class XmlLoader {
 public:
     // Load an XML file and return the document
-    static std::unique_ptr<pugi::xml_document> load(const std::string& filepath);
+    static XmlDocument load(const std::string& filepath);
 
     // Check if a file is a valid XML file
     static bool isXmlFile(const std::string& filepath);
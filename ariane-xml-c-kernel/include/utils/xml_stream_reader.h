@@ -0,0 +1,47 @@
+#ifndef XML_STREAM_READER_H
+#define XML_STREAM_READER_H
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ariane_xml {
+
+// Attribute reported by XmlStreamReader: (name, value with entities decoded)
+using XmlStreamAttribute = std::pair<std::string, std::string>;
+
+// Receives parse events from XmlStreamReader. Returning false from any
+// callback stops the parse (XmlStreamReader::parse then returns false).
+class XmlStreamHandler {
+public:
+    virtual ~XmlStreamHandler() = default;
+
+    virtual bool startElement(const std::string& name,
+                              const std::vector<XmlStreamAttribute>& attributes) = 0;
+
+    // Character data directly inside the current element. As with pugixml's
+    // default options, whitespace-only text is dropped and CDATA is kept as is.
+    virtual bool text(const std::string& value, bool isCData) = 0;
+
+    virtual bool endElement(const std::string& name) = 0;
+};
+
+// Event-driven (SAX-style) XML reader. The file is read in fixed-size chunks
+// and never materialised, so memory is bounded by the largest single token.
+// Text and attribute values are normalised the way pugixml does it by default
+// (entity decoding, end-of-line and attribute whitespace conversion,
+// ISO-8859-1 declared files converted to UTF-8), so values match the DOM path.
+class XmlStreamReader {
+public:
+    // Parse 'filepath' and report events to 'handler'. Returns false on
+    // malformed input, unsupported encodings (UTF-16/32) or I/O errors, with a
+    // description in 'error'. Callers fall back to XmlLoader, which reports
+    // the definitive error.
+    static bool parse(const std::string& filepath,
+                      XmlStreamHandler& handler,
+                      std::string* error = nullptr);
+};
+
+} // namespace ariane_xml
+
+#endif // XML_STREAM_READER_H
@@ -0,0 +1,122 @@
+#ifndef COMPILED_SCHEMA_H
+#define COMPILED_SCHEMA_H
+
+#include "generator/xsd_schema.h"
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace ariane_xml {
+
+// An XSD schema compiled for validation. Each element declaration becomes
+// a type record pointing at flat tables: its child particles in schema
+// order (name id, type, occurrence bounds), its attributes, and a lookup
+// from child name id to particle sorted for binary search. Element names
+// are interned once, so checking a node's children is a hash lookup per
+// child and a counter per particle instead of a walk of the XsdElement
+// tree. Immutable once compiled: one instance is shared by every thread
+// validating against it.
+class CompiledSchema {
+public:
+    using TypeId = uint32_t;
+    using NameId = uint32_t;
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    // A child element of a complex type
+    struct Particle {
+        NameId name;
+        TypeId type;
+        int minOccurs;
+        int maxOccurs;     // -1: unbounded
+        bool firstOfName;  // Later particles with the same name see no occurrences
+    };
+
+    struct Attribute {
+        std::string name;
+        XsdType type;
+        bool required;
+    };
+
+    struct Type {
+        XsdType content;   // COMPLEX: children; otherwise the text's type
+        bool optional;     // minOccurs == 0: its text may be empty
+        uint32_t particlesBegin, particlesEnd;
+        uint32_t attributesBegin, attributesEnd;
+        uint32_t lookupBegin, lookupEnd;
+    };
+
+    // Parse an XSD file and compile it. Throws like XsdParser::parse.
+    static std::shared_ptr<const CompiledSchema> load(const std::string& xsdPath);
+
+    static std::shared_ptr<const CompiledSchema> compile(const XsdSchema& schema);
+
+    bool hasRoot() const { return rootType_ != NONE; }
+    const std::string& rootName() const { return rootName_; }
+    TypeId rootType() const { return rootType_; }
+
+    const Type& type(TypeId id) const { return types_[id]; }
+    const Particle& particle(uint32_t index) const { return particles_[index]; }
+    const Attribute& attribute(uint32_t index) const { return attributes_[index]; }
+    const std::string& name(NameId id) const { return names_[id]; }
+
+    // Id of an element name, NONE if no element of the schema has it
+    NameId nameId(std::string_view name) const;
+
+    // First particle of 'type' for child elements named 'name', or NONE
+    uint32_t findParticle(const Type& type, NameId name) const;
+
+    // Whether a text or attribute value is valid for 'type' (empty values
+    // always are: emptiness is checked separately)
+    static bool matchesType(const char* value, XsdType type);
+
+private:
+    CompiledSchema() = default;
+
+    TypeId compileType(const XsdElement& element,
+                       std::unordered_map<const XsdElement*, TypeId>& compiled);
+    NameId intern(const std::string& name);
+
+    std::string rootName_;
+    TypeId rootType_ = NONE;
+
+    std::vector<Type> types_;
+    std::vector<Particle> particles_;
+    std::vector<Attribute> attributes_;
+    std::vector<std::pair<NameId, uint32_t>> lookup_;  // Per type: (name, particle), by name
+
+    std::deque<std::string> names_;                    // Owns the strings nameIds_ points into
+    std::unordered_map<std::string_view, NameId> nameIds_;
+};
+
+// Compiled schemas kept across CHECK calls of an interactive session.
+// Entries are keyed by XSD path and only reused while the file's size and
+// modification time are unchanged. Safe to use from several threads.
+class CompiledSchemaCache {
+public:
+    // Return the compiled schema for 'xsdPath', parsing and compiling it
+    // on a miss. Throws like XsdParser::parse.
+    std::shared_ptr<const CompiledSchema> load(const std::string& xsdPath);
+
+    // Drop every cached schema; returns the number dropped
+    size_t clear();
+
+private:
+    struct Entry {
+        std::shared_ptr<const CompiledSchema> schema;
+        uintmax_t size = 0;
+        std::filesystem::file_time_type mtime;
+    };
+
+    std::mutex mutex_;
+    std::unordered_map<std::string, Entry> entries_;
+};
+
+} // namespace ariane_xml
+
+#endif // COMPILED_SCHEMA_H
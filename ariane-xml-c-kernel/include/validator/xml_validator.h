@@ -5,10 +5,12 @@
 #include <vector>
 #include <memory>
 #include <pugixml.hpp>
-#include "generator/xsd_schema.h"
+#include "validator/compiled_schema.h"
 
 namespace ariane_xml {
 
+class ThreadPool;
+
 struct ValidationError {
     std::string message;
     std::string path;       // XPath-like location in the document
@@ -40,43 +42,54 @@ public:
         const std::string& xsdFile
     );
 
-    // Validate multiple files
+    // Validate multiple files. The XSD is compiled once, or taken from
+    // 'schemas' when given; with a pool the documents are validated in
+    // parallel. Results keep the input order.
     std::vector<std::pair<std::string, ValidationResult>> validateFiles(
         const std::vector<std::string>& xmlFiles,
-        const std::string& xsdFile
+        const std::string& xsdFile,
+        ThreadPool* pool = nullptr,
+        CompiledSchemaCache* schemas = nullptr
     );
 
     // Expand glob patterns to file list
     static std::vector<std::string> expandPattern(const std::string& pattern);
 
 private:
+    // State of one document's validation: where it is and the occurrence
+    // counters of the elements being checked
+    struct Walk;
+
+    // Load an XML file and validate it against a compiled schema. A null
+    // schema means the XSD failed to parse; schemaError is reported.
+    ValidationResult validateWithSchema(
+        const std::string& xmlFile,
+        const CompiledSchema* schema,
+        const std::string& schemaError
+    );
+
     ValidationResult validateAgainstSchema(
         const pugi::xml_document& doc,
-        const XsdSchema& schema
+        const CompiledSchema& schema
     );
 
     bool validateElement(
         const pugi::xml_node& node,
-        const std::shared_ptr<XsdElement>& schemaElement,
-        ValidationResult& result,
-        const std::string& path
+        CompiledSchema::TypeId type,
+        Walk& walk
     );
 
     bool validateAttributes(
         const pugi::xml_node& node,
-        const std::shared_ptr<XsdElement>& schemaElement,
-        ValidationResult& result,
-        const std::string& path
+        const CompiledSchema::Type& type,
+        Walk& walk
     );
 
     bool validateChildren(
         const pugi::xml_node& node,
-        const std::shared_ptr<XsdElement>& schemaElement,
-        ValidationResult& result,
-        const std::string& path
+        const CompiledSchema::Type& type,
+        Walk& walk
     );
-
-    bool matchesType(const std::string& value, XsdType type);
 };
 
 } // namespace ariane_xml
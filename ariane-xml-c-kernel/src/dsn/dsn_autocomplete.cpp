@@ -3,6 +3,7 @@
 #include <sstream>
 #include <iomanip>
 #include <cctype>
+#include <cstdio>
 
 namespace ariane_xml {
 
@@ -15,8 +16,68 @@ const std::vector<std::string> DsnAutoComplete::SQL_KEYWORDS = {
     "CHECK", "GENERATE", "VERBOSE"
 };
 
+namespace {
+
+// Description words shorter than this ("de", "la", ...) aren't indexed
+constexpr size_t MIN_WORD_LENGTH = 3;
+
+// Add each word of 'text' to 'trie' (letters and digits, after folding;
+// other UTF-8 characters count as letters)
+void addWords(CompletionTrie& trie, std::string_view text, uint32_t value) {
+    std::string folded = CompletionTrie::fold(text);
+    size_t start = 0;
+    for (size_t i = 0; i <= folded.size(); ++i) {
+        unsigned char c = i < folded.size() ? static_cast<unsigned char>(folded[i]) : ' ';
+        if (c >= 0x80 || std::isalnum(c)) {
+            continue;
+        }
+        if (i - start >= MIN_WORD_LENGTH) {
+            trie.add(std::string_view(folded).substr(start, i - start), value);
+        }
+        start = i + 1;
+    }
+}
+
+} // namespace
+
 DsnAutoComplete::DsnAutoComplete(std::shared_ptr<DsnSchema> schema)
-    : schema_(schema) {}
+    : schema_(schema) {
+    buildIndex();
+}
+
+void DsnAutoComplete::buildIndex() {
+    if (!schema_) {
+        return;
+    }
+
+    const auto& by_name = schema_->attributesByName();
+    for (size_t i = 0; i < by_name.size(); ++i) {
+        DsnAttribute attr = schema_->attribute(by_name[i]);
+        paths_.add(attr.full_name, static_cast<uint32_t>(i));
+        addWords(words_, attr.description, static_cast<uint32_t>(i));
+    }
+
+    const auto& by_short_id = schema_->attributesByShortId();
+    for (size_t i = 0; i < by_short_id.size(); ++i) {
+        shortcuts_.add(schema_->attribute(by_short_id[i]).short_id, static_cast<uint32_t>(i));
+    }
+
+    for (size_t i = 0; i < schema_->blocCount(); ++i) {
+        DsnBloc bloc = schema_->bloc(i);
+        std::string bloc_path(bloc.name);
+        std::replace(bloc_path.begin(), bloc_path.end(), '.', '_');
+        blocs_.add(bloc_path, static_cast<uint32_t>(i));
+        if (!bloc.label.empty()) {
+            blocs_.add(bloc.label, static_cast<uint32_t>(i));
+            addWords(blocs_, bloc.label, static_cast<uint32_t>(i));
+        }
+    }
+
+    paths_.build();
+    shortcuts_.build();
+    blocs_.build();
+    words_.build();
+}
 
 std::vector<AutoCompleteSuggestion> DsnAutoComplete::getSuggestions(
     const std::string& input,
@@ -40,10 +101,16 @@ std::vector<AutoCompleteSuggestion> DsnAutoComplete::getSuggestions(
     // Get suggestions based on context
     switch (ctx) {
         case CompletionContext::FIELD:
+            // Names, then shortcuts, then descriptions, then near misses
             suggestions = getPathSuggestions(current_word);
             if (suggestions.empty()) {
-                auto shortcut_sugs = getShortcutSuggestions(current_word);
-                suggestions.insert(suggestions.end(), shortcut_sugs.begin(), shortcut_sugs.end());
+                suggestions = getShortcutSuggestions(current_word);
+            }
+            if (suggestions.empty()) {
+                suggestions = getDescriptionSuggestions(current_word);
+            }
+            if (suggestions.empty()) {
+                suggestions = getFuzzySuggestions(current_word);
             }
             break;
 
@@ -62,12 +129,52 @@ std::vector<AutoCompleteSuggestion> DsnAutoComplete::getSuggestions(
             suggestions.insert(suggestions.end(), path_sugs.begin(), path_sugs.end());
             auto bloc_sugs = getBlocSuggestions(current_word);
             suggestions.insert(suggestions.end(), bloc_sugs.begin(), bloc_sugs.end());
+            if (suggestions.empty()) {
+                suggestions = getFuzzySuggestions(current_word);
+            }
             break;
     }
 
     return suggestions;
 }
 
+AutoCompleteSuggestion DsnAutoComplete::fieldSuggestion(const DsnAttribute& attr) const {
+    std::ostringstream display;
+    display << std::left << std::setw(25) << attr.full_name;
+    if (!attr.description.empty()) {
+        display << " - " << attr.description;
+    }
+
+    return AutoCompleteSuggestion(
+        std::string(attr.full_name),
+        display.str(),
+        std::string(attr.description),
+        AutoCompleteSuggestion::Type::FIELD
+    );
+}
+
+AutoCompleteSuggestion DsnAutoComplete::shortcutSuggestion(const DsnAttribute& attr) const {
+    std::ostringstream display;
+    display << std::left << std::setw(15) << attr.short_id
+            << " -> " << std::setw(25) << attr.full_name;
+    if (!attr.description.empty()) {
+        display << " - " << attr.description.substr(0, 50);
+    }
+
+    // If multiple attributes share the shortcut (ambiguous), say where this one is
+    std::string desc(attr.description);
+    if (schema_->isAmbiguous(attr.short_id)) {
+        desc = "[AMBIGUOUS] " + desc + " (in " + std::string(attr.bloc_label) + ")";
+    }
+
+    return AutoCompleteSuggestion(
+        std::string(attr.full_name),  // Complete to full name to avoid ambiguity
+        display.str(),
+        desc,
+        AutoCompleteSuggestion::Type::FIELD
+    );
+}
+
 std::vector<AutoCompleteSuggestion> DsnAutoComplete::getPathSuggestions(
     const std::string& partial_path
 ) {
@@ -77,24 +184,10 @@ std::vector<AutoCompleteSuggestion> DsnAutoComplete::getPathSuggestions(
         return suggestions;
     }
 
-    // Get all attributes from schema
-    const auto& attrs = schema_->getAttributes();
-
-    for (const auto& [full_name, attr] : attrs) {
-        if (startsWith(full_name, partial_path)) {
-            std::ostringstream display;
-            display << std::left << std::setw(25) << full_name;
-            if (!attr.description.empty()) {
-                display << " - " << attr.description;
-            }
-
-            suggestions.emplace_back(
-                full_name,
-                display.str(),
-                attr.description,
-                AutoCompleteSuggestion::Type::FIELD
-            );
-        }
+    // Positions in name order
+    const auto& by_name = schema_->attributesByName();
+    for (uint32_t position : paths_.prefixMatches(partial_path)) {
+        suggestions.push_back(fieldSuggestion(schema_->attribute(by_name[position])));
     }
 
     return suggestions;
@@ -109,28 +202,26 @@ std::vector<AutoCompleteSuggestion> DsnAutoComplete::getBlocSuggestions(
         return suggestions;
     }
 
-    // Get all blocs from schema
-    const auto& blocs = schema_->getBlocs();
+    // Blocs whose path (S21_G00_30), label or a label word matches
+    for (uint32_t index : blocs_.prefixMatches(partial_bloc)) {
+        DsnBloc bloc = schema_->bloc(index);
 
-    for (const auto& bloc : blocs) {
         // Convert bloc.name (S21.G00.30) to path format (S21_G00_30)
-        std::string bloc_path = bloc.name;
+        std::string bloc_path(bloc.name);
         std::replace(bloc_path.begin(), bloc_path.end(), '.', '_');
 
-        if (startsWith(bloc_path, partial_bloc)) {
-            std::ostringstream display;
-            display << std::left << std::setw(20) << bloc_path;
-            if (!bloc.label.empty()) {
-                display << " (" << bloc.label << ")";
-            }
-
-            suggestions.emplace_back(
-                bloc_path,
-                display.str(),
-                bloc.label + ": " + bloc.description,
-                AutoCompleteSuggestion::Type::BLOC
-            );
+        std::ostringstream display;
+        display << std::left << std::setw(20) << bloc_path;
+        if (!bloc.label.empty()) {
+            display << " (" << bloc.label << ")";
         }
+
+        suggestions.emplace_back(
+            bloc_path,
+            display.str(),
+            std::string(bloc.label) + ": " + std::string(bloc.description),
+            AutoCompleteSuggestion::Type::BLOC
+        );
     }
 
     return suggestions;
@@ -145,38 +236,91 @@ std::vector<AutoCompleteSuggestion> DsnAutoComplete::getShortcutSuggestions(
         return suggestions;
     }
 
-    // Get all shortcuts from schema
-    const auto& shortcuts = schema_->getShortcutMap();
+    // Positions in short id order: attributes sharing a short id (ambiguous)
+    // are next to each other, and all shown
+    const auto& by_short_id = schema_->attributesByShortId();
+    for (uint32_t position : shortcuts_.prefixMatches(partial_shortcut)) {
+        suggestions.push_back(shortcutSuggestion(schema_->attribute(by_short_id[position])));
+    }
 
-    for (const auto& [shortcut, attrs] : shortcuts) {
-        if (startsWith(shortcut, partial_shortcut)) {
-            // If multiple attributes match (ambiguous), show all
-            for (const auto& attr : attrs) {
-                std::ostringstream display;
-                display << std::left << std::setw(15) << shortcut
-                        << " -> " << std::setw(25) << attr.full_name;
-                if (!attr.description.empty()) {
-                    display << " - " << attr.description.substr(0, 50);
-                }
+    return suggestions;
+}
 
-                std::string desc = attr.description;
-                if (attrs.size() > 1) {
-                    desc = "[AMBIGUOUS] " + desc + " (in " + attr.bloc_label + ")";
-                }
+std::vector<AutoCompleteSuggestion> DsnAutoComplete::getDescriptionSuggestions(
+    const std::string& partial_word
+) {
+    std::vector<AutoCompleteSuggestion> suggestions;
 
-                suggestions.emplace_back(
-                    attr.full_name,  // Complete to full name to avoid ambiguity
-                    display.str(),
-                    desc,
-                    AutoCompleteSuggestion::Type::FIELD
-                );
-            }
+    if (!schema_) {
+        return suggestions;
+    }
+
+    const auto& by_name = schema_->attributesByName();
+    for (uint32_t position : words_.prefixMatches(partial_word)) {
+        suggestions.push_back(fieldSuggestion(schema_->attribute(by_name[position])));
+    }
+
+    return suggestions;
+}
+
+std::vector<AutoCompleteSuggestion> DsnAutoComplete::getFuzzySuggestions(
+    const std::string& partial
+) {
+    std::vector<AutoCompleteSuggestion> suggestions;
+
+    uint32_t max_edits = maxEditsFor(partial.size());
+    if (!schema_ || max_edits == 0) {
+        return suggestions;
+    }
+
+    // Rank the matches of all three tries together: fewest edits, then
+    // names before shortcuts before descriptions, then schema order
+    struct Ranked {
+        uint32_t edits;
+        int source;
+        uint32_t position;
+        DsnSchema::AttributeId id;
+    };
+    std::vector<Ranked> ranked;
+    const auto& by_name = schema_->attributesByName();
+    const auto& by_short_id = schema_->attributesByShortId();
+    for (const auto& match : paths_.fuzzyMatches(partial, max_edits)) {
+        ranked.push_back({match.edits, 0, match.value, by_name[match.value]});
+    }
+    for (const auto& match : shortcuts_.fuzzyMatches(partial, max_edits)) {
+        ranked.push_back({match.edits, 1, match.value, by_short_id[match.value]});
+    }
+    for (const auto& match : words_.fuzzyMatches(partial, max_edits)) {
+        ranked.push_back({match.edits, 2, match.value, by_name[match.value]});
+    }
+    std::sort(ranked.begin(), ranked.end(), [](const Ranked& a, const Ranked& b) {
+        if (a.edits != b.edits) {
+            return a.edits < b.edits;
         }
+        return a.source != b.source ? a.source < b.source : a.position < b.position;
+    });
+
+    // Each field once, at its best rank
+    std::vector<bool> seen(schema_->attributeCount(), false);
+    for (const auto& match : ranked) {
+        if (seen[match.id]) {
+            continue;
+        }
+        seen[match.id] = true;
+        DsnAttribute attr = schema_->attribute(match.id);
+        suggestions.push_back(match.source == 1 ? shortcutSuggestion(attr) : fieldSuggestion(attr));
     }
 
     return suggestions;
 }
 
+uint32_t DsnAutoComplete::maxEditsFor(size_t length) {
+    if (length < 4) {
+        return 0;
+    }
+    return length < 8 ? 1 : 2;
+}
+
 std::vector<AutoCompleteSuggestion> DsnAutoComplete::getKeywordSuggestions(
     const std::string& partial_keyword
 ) {
@@ -227,6 +371,77 @@ std::string DsnAutoComplete::formatSuggestions(
     return output.str();
 }
 
+namespace {
+
+void appendJsonString(std::string& out, const std::string& str) {
+    out += '"';
+    for (char c : str) {
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\b': out += "\\b";  break;
+            case '\f': out += "\\f";  break;
+            case '\n': out += "\\n";  break;
+            case '\r': out += "\\r";  break;
+            case '\t': out += "\\t";  break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    // Control characters
+                    char buf[7];
+                    snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned char>(c));
+                    out += buf;
+                } else {
+                    out += c;
+                }
+                break;
+        }
+    }
+    out += '"';
+}
+
+const char* typeName(AutoCompleteSuggestion::Type type) {
+    switch (type) {
+        case AutoCompleteSuggestion::Type::FIELD:
+            return "field";
+        case AutoCompleteSuggestion::Type::BLOC:
+            return "bloc";
+        case AutoCompleteSuggestion::Type::KEYWORD:
+            return "keyword";
+        default:
+            return "unknown";
+    }
+}
+
+} // namespace
+
+std::string DsnAutoComplete::toJson(const std::vector<AutoCompleteSuggestion>& suggestions) {
+    std::string json = "[";
+    for (size_t i = 0; i < suggestions.size(); ++i) {
+        if (i > 0) {
+            json += ',';
+        }
+        json += "{\"completion\":";
+        appendJsonString(json, suggestions[i].completion);
+        json += ",\"display\":";
+        appendJsonString(json, suggestions[i].display);
+        json += ",\"description\":";
+        appendJsonString(json, suggestions[i].description);
+        json += ",\"type\":\"";
+        json += typeName(suggestions[i].type);
+        json += "\"}";
+    }
+    json += ']';
+    return json;
+}
+
+std::string DsnAutoComplete::schemaDirectory(const std::string& version) {
+    if (version == "P25") {
+        return "ariane-xml-schemas/xsd_P25/mensuelle P25";
+    }
+    // P26, and AUTO: the latest version
+    return "ariane-xml-schemas/xsd_P26/mensuelle P26";
+}
+
 std::string DsnAutoComplete::extractCurrentWord(
     const std::string& input,
     size_t cursor_pos
@@ -288,7 +503,7 @@ DsnAutoComplete::CompletionContext DsnAutoComplete::getContext(
     return CompletionContext::UNKNOWN;
 }
 
-bool DsnAutoComplete::startsWith(const std::string& str, const std::string& prefix) {
+bool DsnAutoComplete::startsWith(std::string_view str, std::string_view prefix) {
     if (prefix.length() > str.length()) {
         return false;
     }
@@ -0,0 +1,228 @@
+#include "dsn/dsn_completion_trie.h"
+#include <algorithm>
+#include <cctype>
+#include <numeric>
+
+namespace ariane_xml {
+
+namespace {
+
+constexpr uint32_t NONE = static_cast<uint32_t>(-1);
+
+// Base letters of the UTF-8 sequences C3 80 to C3 BF (Latin-1 À to ÿ);
+// '*' keeps the sequence as it is
+constexpr char LATIN1_BASE_LETTERS[] =
+    "aaaaaa*ceeeeiiii" "*nooooo*ouuuuy**"
+    "aaaaaa*ceeeeiiii" "*nooooo*ouuuuy*y";
+
+} // namespace
+
+std::string CompletionTrie::fold(std::string_view text) {
+    std::string folded;
+    folded.reserve(text.size());
+    for (size_t i = 0; i < text.size(); ++i) {
+        unsigned char c = static_cast<unsigned char>(text[i]);
+        if (c == 0xC3 && i + 1 < text.size()) {
+            unsigned char next = static_cast<unsigned char>(text[i + 1]);
+            if (next >= 0x80 && next <= 0xBF && LATIN1_BASE_LETTERS[next - 0x80] != '*') {
+                folded += LATIN1_BASE_LETTERS[next - 0x80];
+                ++i;
+                continue;
+            }
+        }
+        folded += c < 0x80 ? static_cast<char>(std::tolower(c)) : static_cast<char>(c);
+    }
+    return folded;
+}
+
+void CompletionTrie::add(std::string_view key, uint32_t value) {
+    pending_.emplace_back(fold(key), value);
+}
+
+void CompletionTrie::build() {
+    std::sort(pending_.begin(), pending_.end());
+    pending_.erase(std::unique(pending_.begin(), pending_.end()), pending_.end());
+
+    nodes_.clear();
+    labels_.clear();
+    values_.clear();
+    values_.reserve(pending_.size());
+    for (const auto& entry : pending_) {
+        values_.push_back(entry.second);
+    }
+
+    // Sorted keys lay the values out in depth-first order, so each node's
+    // subtree is the range of keys sharing its path
+    nodes_.push_back(Node{0, 0, 0, 0, 0, static_cast<uint32_t>(pending_.size())});
+    buildNode(0, 0, pending_.size(), 0);
+
+    std::vector<std::pair<std::string, uint32_t>>().swap(pending_);
+}
+
+void CompletionTrie::buildNode(uint32_t node, size_t begin, size_t end, size_t depth) {
+    // Keys ending at this node sort first
+    size_t first = begin;
+    while (first < end && pending_[first].first.size() == depth) {
+        ++first;
+    }
+
+    auto groupEnd = [&](size_t from) {
+        char c = pending_[from].first[depth];
+        size_t to = from + 1;
+        while (to < end && pending_[to].first[depth] == c) {
+            ++to;
+        }
+        return to;
+    };
+
+    uint32_t childCount = 0;
+    for (size_t i = first; i < end; i = groupEnd(i)) {
+        ++childCount;
+    }
+    uint32_t firstChild = static_cast<uint32_t>(nodes_.size());
+    nodes_[node].first_child = firstChild;
+    nodes_[node].child_count = childCount;
+    nodes_.resize(nodes_.size() + childCount);
+
+    uint32_t child = firstChild;
+    for (size_t i = first; i < end; ++child) {
+        size_t to = groupEnd(i);
+
+        // The edge runs as far as the group's keys agree: in sorted order,
+        // as far as its first and last keys agree
+        const std::string& low = pending_[i].first;
+        const std::string& high = pending_[to - 1].first;
+        size_t common = depth + 1;
+        while (common < low.size() && common < high.size() && low[common] == high[common]) {
+            ++common;
+        }
+
+        nodes_[child] = Node{static_cast<uint32_t>(labels_.size()), static_cast<uint32_t>(common - depth),
+                             0, 0, static_cast<uint32_t>(i), static_cast<uint32_t>(to)};
+        labels_.append(low, depth, common - depth);
+        buildNode(child, i, to, common);
+        i = to;
+    }
+}
+
+uint32_t CompletionTrie::findChild(const Node& node, char c) const {
+    auto begin = nodes_.begin() + node.first_child;
+    auto end = begin + node.child_count;
+    auto it = std::lower_bound(begin, end, c, [this](const Node& child, char value) {
+        return static_cast<unsigned char>(labels_[child.label_begin]) < static_cast<unsigned char>(value);
+    });
+    if (it == end || labels_[it->label_begin] != c) {
+        return NONE;
+    }
+    return static_cast<uint32_t>(it - nodes_.begin());
+}
+
+std::vector<uint32_t> CompletionTrie::prefixMatches(std::string_view prefix) const {
+    std::vector<uint32_t> values;
+    if (nodes_.empty()) {
+        return values;
+    }
+
+    std::string key = fold(prefix);
+    uint32_t node = 0;
+    size_t pos = 0;
+    while (pos < key.size()) {
+        uint32_t child = findChild(nodes_[node], key[pos]);
+        if (child == NONE) {
+            return values;
+        }
+        // The prefix may end partway along the edge
+        const Node& next = nodes_[child];
+        for (uint32_t i = 0; i < next.label_length && pos < key.size(); ++i, ++pos) {
+            if (labels_[next.label_begin + i] != key[pos]) {
+                return values;
+            }
+        }
+        node = child;
+    }
+
+    values.assign(values_.begin() + nodes_[node].values_begin, values_.begin() + nodes_[node].values_end);
+    std::sort(values.begin(), values.end());
+    values.erase(std::unique(values.begin(), values.end()), values.end());
+    return values;
+}
+
+std::vector<CompletionTrie::Match> CompletionTrie::fuzzyMatches(std::string_view query, uint32_t maxEdits) const {
+    std::vector<Match> matches;
+    if (nodes_.empty()) {
+        return matches;
+    }
+
+    // Edit distances from each prefix of the query to the empty key prefix
+    std::string key = fold(query);
+    std::vector<uint32_t> row(key.size() + 1);
+    std::iota(row.begin(), row.end(), 0);
+    fuzzyVisit(0, key, maxEdits, row, static_cast<uint32_t>(key.size()), matches);
+
+    // A value reached through several keys keeps its fewest edits
+    std::sort(matches.begin(), matches.end(), [](const Match& a, const Match& b) {
+        return a.value != b.value ? a.value < b.value : a.edits < b.edits;
+    });
+    matches.erase(std::unique(matches.begin(), matches.end(),
+                              [](const Match& a, const Match& b) { return a.value == b.value; }),
+                  matches.end());
+    std::stable_sort(matches.begin(), matches.end(),
+                     [](const Match& a, const Match& b) { return a.edits < b.edits; });
+    return matches;
+}
+
+void CompletionTrie::fuzzyVisit(uint32_t nodeIndex, std::string_view query, uint32_t maxEdits,
+                                std::vector<uint32_t> row, uint32_t best, std::vector<Match>& matches) const {
+    const Node& node = nodes_[nodeIndex];
+    auto emit = [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; ++i) {
+            matches.push_back(Match{values_[i], best});
+        }
+    };
+
+    // 'row' holds the distances from each query prefix to the key prefix
+    // walked so far, and 'best' the smallest distance from the whole query
+    // to any key prefix on the way. No longer key prefix can come closer
+    // than the row's minimum: once that can't beat 'best' (or the bound),
+    // every key below is settled.
+    auto settled = [&]() {
+        return *std::min_element(row.begin(), row.end()) >= std::min(best, maxEdits + 1);
+    };
+
+    for (uint32_t i = 0; i < node.label_length; ++i) {
+        char c = labels_[node.label_begin + i];
+        uint32_t diagonal = row[0];
+        ++row[0];
+        for (size_t q = 1; q < row.size(); ++q) {
+            uint32_t above = row[q];
+            row[q] = std::min({above + 1, row[q - 1] + 1, diagonal + (query[q - 1] != c ? 1u : 0u)});
+            diagonal = above;
+        }
+        best = std::min(best, row.back());
+        if (settled()) {
+            if (best <= maxEdits) {
+                emit(node.values_begin, node.values_end);
+            }
+            return;
+        }
+    }
+    if (nodeIndex == 0 && settled()) {
+        if (best <= maxEdits) {
+            emit(node.values_begin, node.values_end);
+        }
+        return;
+    }
+
+    if (best <= maxEdits) {
+        emit(node.values_begin, node.child_count > 0 ? nodes_[node.first_child].values_begin : node.values_end);
+    }
+    for (uint32_t child = node.first_child; child < node.first_child + node.child_count; ++child) {
+        fuzzyVisit(child, query, maxEdits, row, best, matches);
+    }
+}
+
+size_t CompletionTrie::memoryBytes() const {
+    return nodes_.capacity() * sizeof(Node) + labels_.capacity() + values_.capacity() * sizeof(uint32_t);
+}
+
+} // namespace ariane_xml
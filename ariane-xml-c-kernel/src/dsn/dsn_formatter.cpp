@@ -10,7 +10,7 @@ DsnFormatter::DsnFormatter(std::shared_ptr<DsnSchema> schema)
     : schema_(schema) {}
 
 std::string DsnFormatter::format(
-    const std::vector<ResultRow>& results,
+    const ResultBatch& results,
     DsnOutputFormat format
 ) {
     switch (format) {
@@ -29,20 +29,22 @@ std::string DsnFormatter::format(
     }
 }
 
-std::string DsnFormatter::formatTable(const std::vector<ResultRow>& results) {
+std::string DsnFormatter::formatTable(const ResultBatch& results) {
     if (results.empty()) {
         return "No results.\n";
     }
 
     std::ostringstream output;
     auto fields = getFieldNames(results);
+    auto columns = getFieldColumns(results, fields);
 
     // Calculate column widths
     std::map<std::string, size_t> widths;
-    for (const auto& field : fields) {
+    for (size_t i = 0; i < fields.size(); i++) {
+        const auto& field = fields[i];
         widths[field] = std::min(field.length(), max_field_width_);
-        for (const auto& row : results) {
-            size_t value_len = row.get(field).length();
+        for (size_t row = 0; row < results.rowCount(); row++) {
+            size_t value_len = results.value(row, columns[i]).length();
             widths[field] = std::max(widths[field], std::min(value_len, max_field_width_));
         }
     }
@@ -61,20 +63,20 @@ std::string DsnFormatter::formatTable(const std::vector<ResultRow>& results) {
     output << "|\n";
 
     // Rows
-    for (const auto& row : results) {
-        for (const auto& field : fields) {
-            std::string value = row.get(field);
-            output << "| " << std::left << std::setw(widths[field])
-                   << truncate(value, widths[field]) << " ";
+    for (size_t row = 0; row < results.rowCount(); row++) {
+        for (size_t i = 0; i < fields.size(); i++) {
+            std::string value(results.value(row, columns[i]));
+            output << "| " << std::left << std::setw(widths[fields[i]])
+                   << truncate(value, widths[fields[i]]) << " ";
         }
         output << "|\n";
     }
 
-    output << "\n" << results.size() << " row(s) returned.\n";
+    output << "\n" << results.rowCount() << " row(s) returned.\n";
     return output.str();
 }
 
-std::string DsnFormatter::formatDsnStructured(const std::vector<ResultRow>& results) {
+std::string DsnFormatter::formatDsnStructured(const ResultBatch& results) {
     if (results.empty()) {
         return "No results.\n";
     }
@@ -84,11 +86,9 @@ std::string DsnFormatter::formatDsnStructured(const std::vector<ResultRow>& resu
     auto bloc_groups = groupFieldsByBloc(fields);
 
     // Process each result row
-    for (size_t i = 0; i < results.size(); i++) {
-        const auto& row = results[i];
-
+    for (size_t i = 0; i < results.rowCount(); i++) {
         output << "\n" << drawLine('=', 70) << "\n";
-        output << " Record " << (i + 1) << " of " << results.size() << "\n";
+        output << " Record " << (i + 1) << " of " << results.rowCount() << "\n";
         output << drawLine('=', 70) << "\n";
 
         // Display fields grouped by bloc
@@ -109,7 +109,7 @@ std::string DsnFormatter::formatDsnStructured(const std::vector<ResultRow>& resu
 
                 // Display fields in this bloc
                 for (const auto& field : bloc_fields) {
-                    std::string value = row.get(field);
+                    std::string value(results.value(i, results.columnIndex(field)));
                     if (value.empty()) {
                         value = "(null)";
                     }
@@ -137,30 +137,31 @@ std::string DsnFormatter::formatDsnStructured(const std::vector<ResultRow>& resu
         }
     }
 
-    output << "\n" << results.size() << " record(s) displayed.\n";
+    output << "\n" << results.rowCount() << " record(s) displayed.\n";
     return output.str();
 }
 
-std::string DsnFormatter::formatJson(const std::vector<ResultRow>& results) {
+std::string DsnFormatter::formatJson(const ResultBatch& results) {
     std::ostringstream output;
     output << "[\n";
 
-    for (size_t i = 0; i < results.size(); i++) {
-        const auto& row = results[i];
+    auto fields = getFieldNames(results);
+    auto columns = getFieldColumns(results, fields);
+
+    for (size_t i = 0; i < results.rowCount(); i++) {
         output << "  {\n";
 
-        size_t field_idx = 0;
-        for (const auto& [field, value] : row.fields) {
-            output << "    \"" << escapeJson(field) << "\": \"" << escapeJson(value) << "\"";
-            if (field_idx < row.fields.size() - 1) {
+        for (size_t j = 0; j < fields.size(); j++) {
+            std::string value(results.value(i, columns[j]));
+            output << "    \"" << escapeJson(fields[j]) << "\": \"" << escapeJson(value) << "\"";
+            if (j < fields.size() - 1) {
                 output << ",";
             }
             output << "\n";
-            field_idx++;
         }
 
         output << "  }";
-        if (i < results.size() - 1) {
+        if (i < results.rowCount() - 1) {
             output << ",";
         }
         output << "\n";
@@ -170,13 +171,14 @@ std::string DsnFormatter::formatJson(const std::vector<ResultRow>& results) {
     return output.str();
 }
 
-std::string DsnFormatter::formatCsv(const std::vector<ResultRow>& results) {
+std::string DsnFormatter::formatCsv(const ResultBatch& results) {
     if (results.empty()) {
         return "";
     }
 
     std::ostringstream output;
     auto fields = getFieldNames(results);
+    auto columns = getFieldColumns(results, fields);
 
     // Header
     for (size_t i = 0; i < fields.size(); i++) {
@@ -188,9 +190,9 @@ std::string DsnFormatter::formatCsv(const std::vector<ResultRow>& results) {
     output << "\n";
 
     // Rows
-    for (const auto& row : results) {
+    for (size_t row = 0; row < results.rowCount(); row++) {
         for (size_t i = 0; i < fields.size(); i++) {
-            output << escapeCsv(row.get(fields[i]));
+            output << escapeCsv(std::string(results.value(row, columns[i])));
             if (i < fields.size() - 1) {
                 output << ",";
             }
@@ -201,20 +203,20 @@ std::string DsnFormatter::formatCsv(const std::vector<ResultRow>& results) {
     return output.str();
 }
 
-std::string DsnFormatter::formatCompact(const std::vector<ResultRow>& results) {
+std::string DsnFormatter::formatCompact(const ResultBatch& results) {
     if (results.empty()) {
         return "No results.\n";
     }
 
     std::ostringstream output;
     auto fields = getFieldNames(results);
+    auto columns = getFieldColumns(results, fields);
 
-    for (size_t i = 0; i < results.size(); i++) {
-        const auto& row = results[i];
+    for (size_t i = 0; i < results.rowCount(); i++) {
         output << "[" << (i + 1) << "] ";
 
         for (size_t j = 0; j < fields.size(); j++) {
-            output << fields[j] << "=" << row.get(fields[j]);
+            output << fields[j] << "=" << results.value(i, columns[j]);
             if (j < fields.size() - 1) {
                 output << " | ";
             }
@@ -246,9 +248,9 @@ std::string DsnFormatter::getFieldDescription(const std::string& field_name) {
         return "";
     }
 
-    const DsnAttribute* attr = schema_->findByFullName(field_name);
+    auto attr = schema_->findByFullName(field_name);
     if (attr) {
-        return attr->description;
+        return std::string(attr->description);
     }
 
     return "";
@@ -259,9 +261,9 @@ std::string DsnFormatter::getBlocLabel(const std::string& bloc_name) {
         return "";
     }
 
-    const DsnBloc* bloc = schema_->findBloc(bloc_name);
+    auto bloc = schema_->findBloc(bloc_name);
     if (bloc) {
-        return bloc->label;
+        return std::string(bloc->label);
     }
 
     return "";
@@ -332,20 +334,31 @@ std::string DsnFormatter::drawLine(char c, size_t length) {
 }
 
 std::vector<std::string> DsnFormatter::getFieldNames(
-    const std::vector<ResultRow>& results
+    const ResultBatch& results
 ) {
     std::vector<std::string> fields;
     if (results.empty()) {
         return fields;
     }
 
-    // Get all unique field names from the first row
-    // (assuming all rows have the same fields)
-    for (const auto& [field, value] : results[0].fields) {
-        fields.push_back(field);
-    }
+    // All rows share the batch's columns; list each name once, sorted
+    fields = results.columnNames();
+    std::sort(fields.begin(), fields.end());
+    fields.erase(std::unique(fields.begin(), fields.end()), fields.end());
 
     return fields;
 }
 
+std::vector<size_t> DsnFormatter::getFieldColumns(
+    const ResultBatch& results,
+    const std::vector<std::string>& fields
+) {
+    std::vector<size_t> columns;
+    columns.reserve(fields.size());
+    for (const auto& field : fields) {
+        columns.push_back(results.columnIndex(field));
+    }
+    return columns;
+}
+
 } // namespace ariane_xml
@@ -275,18 +275,16 @@ std::vector<SchemaDifference> DsnMigrationHelper::findAddedFields(
 ) {
     std::vector<SchemaDifference> added;
 
-    const auto& old_attrs = from_schema.getAttributes();
-    const auto& new_attrs = to_schema.getAttributes();
-
-    for (const auto& [field_name, attr] : new_attrs) {
-        if (old_attrs.find(field_name) == old_attrs.end()) {
-            std::string desc = attr.description;
+    for (DsnSchema::AttributeId id : to_schema.attributesByName()) {
+        DsnAttribute attr = to_schema.attribute(id);
+        if (!from_schema.findByFullName(attr.full_name)) {
+            std::string desc(attr.description);
             if (attr.mandatory) {
                 desc += " [MANDATORY]";
             }
             added.emplace_back(
                 SchemaDifference::Type::ADDED,
-                field_name,
+                std::string(attr.full_name),
                 desc
             );
         }
@@ -301,15 +299,13 @@ std::vector<SchemaDifference> DsnMigrationHelper::findRemovedFields(
 ) {
     std::vector<SchemaDifference> removed;
 
-    const auto& old_attrs = from_schema.getAttributes();
-    const auto& new_attrs = to_schema.getAttributes();
-
-    for (const auto& [field_name, attr] : old_attrs) {
-        if (new_attrs.find(field_name) == new_attrs.end()) {
+    for (DsnSchema::AttributeId id : from_schema.attributesByName()) {
+        DsnAttribute attr = from_schema.attribute(id);
+        if (!to_schema.findByFullName(attr.full_name)) {
             removed.emplace_back(
                 SchemaDifference::Type::REMOVED,
-                field_name,
-                attr.description
+                std::string(attr.full_name),
+                std::string(attr.description)
             );
         }
     }
@@ -323,14 +319,11 @@ std::vector<SchemaDifference> DsnMigrationHelper::findModifiedFields(
 ) {
     std::vector<SchemaDifference> modified;
 
-    const auto& old_attrs = from_schema.getAttributes();
-    const auto& new_attrs = to_schema.getAttributes();
-
-    for (const auto& [field_name, new_attr] : new_attrs) {
-        auto it = old_attrs.find(field_name);
-        if (it != old_attrs.end()) {
-            const auto& old_attr = it->second;
-            auto diffs = compareAttributes(old_attr, new_attr);
+    for (DsnSchema::AttributeId id : to_schema.attributesByName()) {
+        DsnAttribute new_attr = to_schema.attribute(id);
+        auto old_attr = from_schema.findByFullName(new_attr.full_name);
+        if (old_attr) {
+            auto diffs = compareAttributes(*old_attr, new_attr);
             modified.insert(modified.end(), diffs.begin(), diffs.end());
         }
     }
@@ -348,7 +341,7 @@ std::vector<SchemaDifference> DsnMigrationHelper::compareAttributes(
     if (old_attr.mandatory != new_attr.mandatory) {
         diffs.emplace_back(
             SchemaDifference::Type::MODIFIED,
-            new_attr.full_name,
+            std::string(new_attr.full_name),
             "Mandatory status changed",
             old_attr.mandatory ? "mandatory" : "optional",
             new_attr.mandatory ? "mandatory" : "optional"
@@ -359,10 +352,10 @@ std::vector<SchemaDifference> DsnMigrationHelper::compareAttributes(
     if (old_attr.type != new_attr.type) {
         diffs.emplace_back(
             SchemaDifference::Type::MODIFIED,
-            new_attr.full_name,
+            std::string(new_attr.full_name),
             "Type changed",
-            old_attr.type,
-            new_attr.type
+            std::string(old_attr.type),
+            std::string(new_attr.type)
         );
     }
 
@@ -376,7 +369,7 @@ std::vector<SchemaDifference> DsnMigrationHelper::compareAttributes(
 
         diffs.emplace_back(
             SchemaDifference::Type::MODIFIED,
-            new_attr.full_name,
+            std::string(new_attr.full_name),
             "Cardinality changed",
             old_occ,
             new_occ
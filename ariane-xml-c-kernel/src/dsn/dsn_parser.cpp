@@ -1,5 +1,7 @@
 #include "dsn/dsn_parser.h"
+#include "utils/thread_pool.h"
 #include <pugixml.hpp>
+#include <algorithm>
 #include <iostream>
 #include <filesystem>
 #include <regex>
@@ -46,7 +48,8 @@ std::shared_ptr<DsnSchema> DsnParser::parse(const std::string& xsdPath, const st
     return schema;
 }
 
-std::shared_ptr<DsnSchema> DsnParser::parseDirectory(const std::string& schemaDir, const std::string& version) {
+std::shared_ptr<DsnSchema> DsnParser::parseDirectory(const std::string& schemaDir, const std::string& version,
+                                                     ThreadPool* pool) {
     auto schema = std::make_shared<DsnSchema>(version);
 
     if (!std::filesystem::exists(schemaDir) || !std::filesystem::is_directory(schemaDir)) {
@@ -54,43 +57,70 @@ std::shared_ptr<DsnSchema> DsnParser::parseDirectory(const std::string& schemaDi
         return schema;
     }
 
-    // Parse all XSD files in the directory
+    // All XSD files in the directory, in name order
+    std::vector<std::string> xsdPaths;
     for (const auto& entry : std::filesystem::directory_iterator(schemaDir)) {
         if (entry.path().extension() == ".xsd") {
-            std::string xsdPath = entry.path().string();
-            std::cerr << "Parsing DSN schema: " << xsdPath << std::endl;
+            xsdPaths.push_back(entry.path().string());
+        }
+    }
+    std::sort(xsdPaths.begin(), xsdPaths.end());
+
+    std::vector<std::shared_ptr<DsnSchema>> fragments(xsdPaths.size());
+    auto parseOne = [&](size_t i) {
+        fragments[i] = parseFragment(xsdPaths[i], version);
+    };
+
+    if (pool && xsdPaths.size() > 1) {
+        pool->parallelFor(xsdPaths.size(), parseOne);
+    } else {
+        for (size_t i = 0; i < xsdPaths.size(); ++i) {
+            parseOne(i);
+        }
+    }
 
-            // Load and parse this XSD file
-            pugi::xml_document doc;
-            pugi::xml_parse_result result = doc.load_file(xsdPath.c_str());
+    for (size_t i = 0; i < xsdPaths.size(); ++i) {
+        std::cerr << "Parsing DSN schema: " << xsdPaths[i] << std::endl;
+        if (!fragments[i]) {
+            std::cerr << "  Warning: Could not parse " << xsdPaths[i] << std::endl;
+            continue;
+        }
+        schema->merge(*fragments[i]);
+    }
 
-            if (!result) {
-                std::cerr << "  Warning: Could not parse " << xsdPath << std::endl;
-                continue;
-            }
+    return schema;
+}
 
-            pugi::xml_node schemaNode = doc.child("xs:schema");
-            if (!schemaNode) schemaNode = doc.child("xsd:schema");
-            if (!schemaNode) schemaNode = doc.child("schema");
+std::shared_ptr<DsnSchema> DsnParser::parseFragment(const std::string& xsdPath, const std::string& version) {
+    pugi::xml_document doc;
+    pugi::xml_parse_result result = doc.load_file(xsdPath.c_str());
 
-            if (!schemaNode) {
-                continue;
-            }
+    if (!result) {
+        return nullptr;
+    }
 
-            // Parse elements
-            for (pugi::xml_node node : schemaNode.children()) {
-                std::string nodeName = node.name();
+    auto fragment = std::make_shared<DsnSchema>(version);
 
-                if (nodeName == "xs:element" || nodeName == "xsd:element" || nodeName == "element") {
-                    parseElement(&node, *schema);
-                } else if (nodeName == "xs:complexType" || nodeName == "xsd:complexType" || nodeName == "complexType") {
-                    parseComplexType(&node, *schema);
-                }
-            }
+    pugi::xml_node schemaNode = doc.child("xs:schema");
+    if (!schemaNode) schemaNode = doc.child("xsd:schema");
+    if (!schemaNode) schemaNode = doc.child("schema");
+
+    if (!schemaNode) {
+        return fragment;
+    }
+
+    // Parse elements
+    for (pugi::xml_node node : schemaNode.children()) {
+        std::string nodeName = node.name();
+
+        if (nodeName == "xs:element" || nodeName == "xsd:element" || nodeName == "element") {
+            parseElement(&node, *fragment);
+        } else if (nodeName == "xs:complexType" || nodeName == "xsd:complexType" || nodeName == "complexType") {
+            parseComplexType(&node, *fragment);
         }
     }
 
-    return schema;
+    return fragment;
 }
 
 std::string DsnParser::detectVersion(const std::string& xmlPath) {
@@ -123,7 +153,7 @@ std::string DsnParser::extractShortId(const std::string& full_name) {
     // Extract YY_ZZZ from SWW_GXX_YY_ZZZ
     // Example: S21_G00_30_001 -> 30_001
 
-    std::regex pattern(R"(S\d+_G\d+_(\d+_\d+))");
+    static const std::regex pattern(R"(S\d+_G\d+_(\d+_\d+))");
     std::smatch match;
 
     if (std::regex_search(full_name, match, pattern)) {
@@ -137,7 +167,7 @@ std::string DsnParser::extractBlocName(const std::string& full_name) {
     // Extract bloc name from attribute name
     // Example: S21_G00_30_001 -> S21.G00.30
 
-    std::regex pattern(R"((S\d+)_(G\d+)_(\d+)_\d+)");
+    static const std::regex pattern(R"((S\d+)_(G\d+)_(\d+)_\d+)");
     std::smatch match;
 
     if (std::regex_search(full_name, match, pattern)) {
@@ -161,19 +191,24 @@ void DsnParser::parseElement(void* element, DsnSchema& schema) {
     std::string elementName = node->attribute("name").as_string();
 
     // Only process DSN-style element names (S\d+_G\d+_\d+_\d+)
-    std::regex dsnPattern(R"(S\d+_G\d+_\d+_\d+)");
+    static const std::regex dsnPattern(R"(S\d+_G\d+_\d+_\d+)");
     if (!std::regex_match(elementName, dsnPattern)) {
         return;
     }
 
-    // Create DSN attribute
+    // Create DSN attribute (its strings are views of these until added)
+    std::string shortId = extractShortId(elementName);
+    std::string blocName = extractBlocName(elementName);
+    std::string description;
+
     DsnAttribute attr;
     attr.full_name = elementName;
-    attr.short_id = extractShortId(elementName);
-    attr.bloc_name = extractBlocName(elementName);
+    attr.short_id = shortId;
+    attr.bloc_name = blocName;
 
     // Extract type
-    attr.type = node->attribute("type").as_string();
+    std::string type = node->attribute("type").as_string();
+    attr.type = type;
 
     // Extract occurrences
     std::string minOccurs = node->attribute("minOccurs").as_string("1");
@@ -194,7 +229,12 @@ void DsnParser::parseElement(void* element, DsnSchema& schema) {
         if (!documentation) documentation = annotation.child("documentation");
 
         if (documentation) {
-            attr.description = extractDescription(documentation.text().as_string());
+            // DSN schemas label the field in <doc:name>, followed by a longer
+            // <doc:description>; plain schemas put the text directly inside
+            pugi::xml_node label = documentation.child("doc:name");
+            description = extractDescription(label ? label.text().as_string()
+                                                   : documentation.text().as_string());
+            attr.description = description;
         }
     }
 
@@ -77,7 +77,7 @@ std::string DsnQueryRewriter::expandComponent(const std::string& component, cons
 
     if (attributes.size() == 1) {
         // Unambiguous shortcut, expand to full name
-        return attributes[0].full_name;
+        return std::string(attributes[0].full_name);
     }
 
     // Ambiguous shortcut - try to disambiguate using previous component
@@ -86,7 +86,7 @@ std::string DsnQueryRewriter::expandComponent(const std::string& component, cons
         for (const auto& attr : attributes) {
             if (attr.full_name.find(previousComponent) == 0) {
                 // This attribute starts with the previous component (same hierarchy)
-                return attr.full_name;
+                return std::string(attr.full_name);
             }
         }
     }
@@ -95,7 +95,7 @@ std::string DsnQueryRewriter::expandComponent(const std::string& component, cons
     handleAmbiguousShortcut(component, attributes);
 
     // Return first match as fallback
-    return attributes[0].full_name;
+    return std::string(attributes[0].full_name);
 }
 
 bool DsnQueryRewriter::isShortcutPattern(const std::string& str) {
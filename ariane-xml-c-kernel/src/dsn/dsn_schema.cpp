@@ -1,77 +1,337 @@
 #include "dsn/dsn_schema.h"
 #include <algorithm>
+#include <cstring>
+#include <functional>
 #include <regex>
 
 namespace ariane_xml {
 
+namespace {
+
+// Interned copies are packed into chunks of this size
+constexpr size_t STRING_CHUNK_BYTES = 4096;
+
+size_t hashText(std::string_view text) {
+    return std::hash<std::string_view>()(text);
+}
+
+} // namespace
+
+uint32_t InternedStrings::intern(std::string_view text) {
+    size_t slot;
+    uint32_t id = find(text, slot);
+    if (id != static_cast<uint32_t>(-1)) {
+        return id;
+    }
+
+    // A string too long for the current chunk starts a new one, sized for
+    // it when it's longer than a chunk
+    if (chunks_.empty() || chunkUsed_ + text.size() > STRING_CHUNK_BYTES) {
+        size_t size = std::max(STRING_CHUNK_BYTES, text.size());
+        chunks_.push_back(std::make_unique<char[]>(size));
+        chunkBytes_ += size;
+        chunkUsed_ = 0;
+    }
+    char* copy = chunks_.back().get() + chunkUsed_;
+    std::memcpy(copy, text.data(), text.size());
+    chunkUsed_ += text.size();
+    return add(std::string_view(copy, text.size()), slot);
+}
+
+uint32_t InternedStrings::internStatic(std::string_view text) {
+    size_t slot;
+    uint32_t id = find(text, slot);
+    return id != static_cast<uint32_t>(-1) ? id : add(text, slot);
+}
+
+uint32_t InternedStrings::find(std::string_view text, size_t& slot) const {
+    if (lookup_.empty()) {
+        slot = 0;
+        return static_cast<uint32_t>(-1);
+    }
+    size_t mask = lookup_.size() - 1;
+    for (slot = hashText(text) & mask; lookup_[slot] != 0; slot = (slot + 1) & mask) {
+        if (strings_[lookup_[slot] - 1] == text) {
+            return lookup_[slot] - 1;
+        }
+    }
+    return static_cast<uint32_t>(-1);
+}
+
+uint32_t InternedStrings::add(std::string_view stored, size_t slot) {
+    uint32_t id = static_cast<uint32_t>(strings_.size());
+    strings_.push_back(stored);
+
+    if (lookup_.empty() || strings_.size() * 2 > lookup_.size()) {
+        std::vector<uint32_t> lookup(std::max<size_t>(64, lookup_.size() * 2), 0);
+        size_t mask = lookup.size() - 1;
+        for (size_t s = 0; s < strings_.size(); ++s) {
+            size_t i = hashText(strings_[s]) & mask;
+            while (lookup[i] != 0) {
+                i = (i + 1) & mask;
+            }
+            lookup[i] = static_cast<uint32_t>(s + 1);
+        }
+        lookup_.swap(lookup);
+    } else {
+        lookup_[slot] = id + 1;
+    }
+    return id;
+}
+
+size_t InternedStrings::memoryBytes() const {
+    return strings_.capacity() * sizeof(std::string_view) +
+           chunks_.capacity() * sizeof(std::unique_ptr<char[]>) + chunkBytes_ +
+           lookup_.capacity() * sizeof(uint32_t);
+}
+
 DsnSchema::DsnSchema(const std::string& version)
     : version_(version) {}
 
-void DsnSchema::addAttribute(const DsnAttribute& attr) {
-    // Add to full name map
-    full_name_map_[attr.full_name] = attr;
+template <typename KeyOf>
+uint32_t DsnSchema::lookup(const Index& index, std::string_view key, KeyOf keyOf) {
+    if (index.slots.empty()) {
+        return NONE;
+    }
+    size_t mask = index.slots.size() - 1;
+    for (size_t i = hashText(key) & mask; index.slots[i] != 0; i = (i + 1) & mask) {
+        if (keyOf(index.slots[i] - 1) == key) {
+            return index.slots[i] - 1;
+        }
+    }
+    return NONE;
+}
+
+template <typename KeyOf>
+void DsnSchema::insert(Index& index, uint32_t entry, KeyOf keyOf) {
+    if ((index.count + 1) * 2 > index.slots.size()) {
+        std::vector<uint32_t> slots(std::max<size_t>(64, index.slots.size() * 2), 0);
+        size_t mask = slots.size() - 1;
+        for (uint32_t old : index.slots) {
+            if (old != 0) {
+                size_t i = hashText(keyOf(old - 1)) & mask;
+                while (slots[i] != 0) {
+                    i = (i + 1) & mask;
+                }
+                slots[i] = old;
+            }
+        }
+        index.slots.swap(slots);
+    }
 
-    // Add to shortcut map
-    shortcut_map_[attr.short_id].push_back(attr);
+    size_t mask = index.slots.size() - 1;
+    size_t i = hashText(keyOf(entry)) & mask;
+    while (index.slots[i] != 0) {
+        i = (i + 1) & mask;
+    }
+    index.slots[i] = entry + 1;
+    ++index.count;
+}
+
+void DsnSchema::reserve(size_t attributes) {
+    attributes_.reserve(attributes);
+    by_name_.reserve(attributes);
+    by_short_id_.reserve(attributes);
+}
+
+DsnSchema::AttributeId DsnSchema::addAttribute(const DsnAttribute& attr) {
+    return add(attr, false);
+}
+
+DsnSchema::AttributeId DsnSchema::addStaticAttribute(const DsnAttribute& attr) {
+    return add(attr, true);
+}
+
+DsnSchema::AttributeId DsnSchema::add(const DsnAttribute& attr, bool staticStrings) {
+    auto intern = [&](std::string_view text) {
+        return staticStrings ? strings_.internStatic(text) : strings_.intern(text);
+    };
+    auto fullNameOf = [this](AttributeId id) { return text(attributes_[id].full_name); };
+    auto shortIdOf = [this](AttributeId id) { return text(attributes_[id].short_id); };
+    auto blocNameOf = [this](AttributeId id) { return text(attributes_[id].bloc_name); };
+
+    AttributeId existing = lookup(name_index_, attr.full_name, fullNameOf);
+    if (existing != NONE) {
+        AttributeRecord& record = attributes_[existing];
+        record.bloc_label = intern(attr.bloc_label);
+        record.description = intern(attr.description);
+        record.type = intern(attr.type);
+        record.min_occurs = attr.min_occurs;
+        record.max_occurs = attr.max_occurs;
+        record.mandatory = attr.mandatory;
+        return existing;
+    }
+
+    AttributeId id = static_cast<AttributeId>(attributes_.size());
+    AttributeRecord record;
+    record.full_name = intern(attr.full_name);
+    record.short_id = intern(attr.short_id);
+    record.bloc_name = intern(attr.bloc_name);
+    record.bloc_label = intern(attr.bloc_label);
+    record.description = intern(attr.description);
+    record.type = intern(attr.type);
+    record.min_occurs = attr.min_occurs;
+    record.max_occurs = attr.max_occurs;
+    record.mandatory = attr.mandatory;
+    record.next_same_short_id = NONE;
+    record.next_same_bloc = NONE;
+    record.last_same_short_id = id;
+    record.last_same_bloc = id;
+    attributes_.push_back(record);
+
+    insert(name_index_, id, fullNameOf);
+
+    AttributeId head = lookup(short_id_index_, attr.short_id, shortIdOf);
+    if (head == NONE) {
+        insert(short_id_index_, id, shortIdOf);
+    } else {
+        attributes_[attributes_[head].last_same_short_id].next_same_short_id = id;
+        attributes_[head].last_same_short_id = id;
+    }
+
+    head = lookup(bloc_attr_index_, attr.bloc_name, blocNameOf);
+    if (head == NONE) {
+        insert(bloc_attr_index_, id, blocNameOf);
+    } else {
+        attributes_[attributes_[head].last_same_bloc].next_same_bloc = id;
+        attributes_[head].last_same_bloc = id;
+    }
+
+    by_name_.insert(std::upper_bound(by_name_.begin(), by_name_.end(), id,
+                                     [&](AttributeId a, AttributeId b) { return fullNameOf(a) < fullNameOf(b); }),
+                    id);
+    by_short_id_.insert(std::upper_bound(by_short_id_.begin(), by_short_id_.end(), id,
+                                         [&](AttributeId a, AttributeId b) { return shortIdOf(a) < shortIdOf(b); }),
+                        id);
+    return id;
 }
 
 void DsnSchema::addBloc(const DsnBloc& bloc) {
-    bloc_index_[bloc.name] = blocs_.size();
-    blocs_.push_back(bloc);
+    auto nameOf = [this](uint32_t index) { return text(blocs_[index].name); };
+
+    BlocRecord record;
+    record.name = strings_.intern(bloc.name);
+    record.label = strings_.intern(bloc.label);
+    record.description = strings_.intern(bloc.description);
+    record.min_occurs = bloc.min_occurs;
+    record.max_occurs = bloc.max_occurs;
+    record.mandatory = bloc.mandatory;
+
+    uint32_t existing = lookup(bloc_index_, bloc.name, nameOf);
+    if (existing != NONE) {
+        blocs_[existing] = record;
+        return;
+    }
+    blocs_.push_back(record);
+    insert(bloc_index_, static_cast<uint32_t>(blocs_.size() - 1), nameOf);
+}
+
+DsnAttribute DsnSchema::view(const AttributeRecord& record) const {
+    DsnAttribute attr;
+    attr.full_name = text(record.full_name);
+    attr.short_id = text(record.short_id);
+    attr.bloc_name = text(record.bloc_name);
+    attr.bloc_label = text(record.bloc_label);
+    attr.description = text(record.description);
+    attr.type = text(record.type);
+    attr.mandatory = record.mandatory;
+    attr.min_occurs = record.min_occurs;
+    attr.max_occurs = record.max_occurs;
+    return attr;
+}
+
+DsnAttribute DsnSchema::attribute(AttributeId id) const {
+    return view(attributes_[id]);
 }
 
-std::vector<DsnAttribute> DsnSchema::findByShortId(const std::string& short_id) const {
-    auto it = shortcut_map_.find(short_id);
-    if (it != shortcut_map_.end()) {
-        return it->second;
+std::vector<DsnAttribute> DsnSchema::findByShortId(std::string_view short_id) const {
+    std::vector<DsnAttribute> results;
+    AttributeId id = lookup(short_id_index_, short_id,
+                            [this](AttributeId a) { return text(attributes_[a].short_id); });
+    for (; id != NONE; id = attributes_[id].next_same_short_id) {
+        results.push_back(view(attributes_[id]));
     }
-    return {};
+    return results;
 }
 
-DsnAttribute* DsnSchema::findByFullName(const std::string& full_name) {
-    auto it = full_name_map_.find(full_name);
-    if (it != full_name_map_.end()) {
-        return &(it->second);
+std::optional<DsnAttribute> DsnSchema::findByFullName(std::string_view full_name) const {
+    AttributeId id = lookup(name_index_, full_name,
+                            [this](AttributeId a) { return text(attributes_[a].full_name); });
+    if (id != NONE) {
+        return view(attributes_[id]);
     }
-    return nullptr;
+    return std::nullopt;
 }
 
-const DsnAttribute* DsnSchema::findByFullName(const std::string& full_name) const {
-    auto it = full_name_map_.find(full_name);
-    if (it != full_name_map_.end()) {
-        return &(it->second);
+void DsnSchema::merge(const DsnSchema& other) {
+    attributes_.reserve(attributes_.size() + other.attributes_.size());
+    for (AttributeId id = 0; id < other.attributes_.size(); ++id) {
+        addAttribute(other.attribute(id));
     }
-    return nullptr;
+    for (size_t i = 0; i < other.blocs_.size(); ++i) {
+        addBloc(other.bloc(i));
+    }
+}
+
+DsnBloc DsnSchema::bloc(size_t index) const {
+    const BlocRecord& record = blocs_[index];
+    DsnBloc bloc;
+    bloc.name = text(record.name);
+    bloc.label = text(record.label);
+    bloc.description = text(record.description);
+    bloc.mandatory = record.mandatory;
+    bloc.min_occurs = record.min_occurs;
+    bloc.max_occurs = record.max_occurs;
+    return bloc;
 }
 
-const DsnBloc* DsnSchema::findBloc(const std::string& bloc_name) const {
-    auto it = bloc_index_.find(bloc_name);
-    if (it != bloc_index_.end()) {
-        return &blocs_[it->second];
+std::optional<DsnBloc> DsnSchema::findBloc(std::string_view bloc_name) const {
+    uint32_t index = lookup(bloc_index_, bloc_name,
+                            [this](uint32_t b) { return text(blocs_[b].name); });
+    if (index != NONE) {
+        return bloc(index);
     }
-    return nullptr;
+    return std::nullopt;
 }
 
-std::vector<const DsnBloc*> DsnSchema::findBlocsByPattern(const std::string& pattern) const {
-    std::vector<const DsnBloc*> results;
+std::vector<DsnBloc> DsnSchema::findBlocsByPattern(const std::string& pattern) const {
+    std::vector<DsnBloc> results;
     std::regex regex_pattern(pattern, std::regex::icase);
 
-    for (const auto& bloc : blocs_) {
-        if (std::regex_search(bloc.name, regex_pattern) ||
-            std::regex_search(bloc.label, regex_pattern)) {
-            results.push_back(&bloc);
+    for (size_t i = 0; i < blocs_.size(); ++i) {
+        DsnBloc candidate = bloc(i);
+        if (std::regex_search(candidate.name.begin(), candidate.name.end(), regex_pattern) ||
+            std::regex_search(candidate.label.begin(), candidate.label.end(), regex_pattern)) {
+            results.push_back(candidate);
         }
     }
 
     return results;
 }
 
-bool DsnSchema::isAmbiguous(const std::string& short_id) const {
-    auto it = shortcut_map_.find(short_id);
-    if (it != shortcut_map_.end()) {
-        return it->second.size() > 1;
+std::vector<DsnAttribute> DsnSchema::findBlocAttributes(std::string_view bloc_name) const {
+    std::vector<DsnAttribute> results;
+    AttributeId id = lookup(bloc_attr_index_, bloc_name,
+                            [this](AttributeId a) { return text(attributes_[a].bloc_name); });
+    for (; id != NONE; id = attributes_[id].next_same_bloc) {
+        results.push_back(view(attributes_[id]));
     }
-    return false;
+    return results;
+}
+
+bool DsnSchema::isAmbiguous(std::string_view short_id) const {
+    AttributeId id = lookup(short_id_index_, short_id,
+                            [this](AttributeId a) { return text(attributes_[a].short_id); });
+    return id != NONE && attributes_[id].next_same_short_id != NONE;
+}
+
+size_t DsnSchema::memoryBytes() const {
+    return strings_.memoryBytes() +
+           attributes_.capacity() * sizeof(AttributeRecord) +
+           (by_name_.capacity() + by_short_id_.capacity()) * sizeof(AttributeId) +
+           (name_index_.slots.capacity() + short_id_index_.slots.capacity() +
+            bloc_attr_index_.slots.capacity() + bloc_index_.slots.capacity()) * sizeof(uint32_t) +
+           blocs_.capacity() * sizeof(BlocRecord);
 }
 
 } // namespace ariane_xml
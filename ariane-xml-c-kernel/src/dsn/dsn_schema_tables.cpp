@@ -0,0 +1,80 @@
+#include "dsn/dsn_schema_tables.h"
+#include "dsn/dsn_parser.h"
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <system_error>
+
+namespace ariane_xml {
+
+const DsnSchemaTables* findBundledDsnSchema(const std::string& schemaDir) {
+    // Sizes first: a directory whose files don't even have the right
+    // names and sizes is rejected without reading anything
+    std::map<std::string, uint64_t> sizes;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(schemaDir, ec)) {
+        if (entry.path().extension() == ".xsd") {
+            sizes[entry.path().filename().string()] = entry.file_size(ec);
+            if (ec) {
+                return nullptr;
+            }
+        }
+    }
+    if (ec || sizes.empty()) {
+        return nullptr;
+    }
+
+    for (const DsnSchemaTables* tables = BUNDLED_DSN_SCHEMAS; tables->version; ++tables) {
+        if (tables->file_count != sizes.size()) {
+            continue;
+        }
+        bool sameFiles = true;
+        for (size_t i = 0; i < tables->file_count && sameFiles; ++i) {
+            auto it = sizes.find(tables->files[i].name);
+            sameFiles = it != sizes.end() && it->second == tables->files[i].size;
+        }
+        if (!sameFiles) {
+            continue;
+        }
+
+        for (size_t i = 0; i < tables->file_count && sameFiles; ++i) {
+            std::ifstream file(std::filesystem::path(schemaDir) / tables->files[i].name, std::ios::binary);
+            std::string contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+            sameFiles = file.good() || file.eof();
+            sameFiles = sameFiles && hashDsnSchemaFile(contents) == tables->files[i].hash;
+        }
+        if (sameFiles) {
+            return tables;
+        }
+    }
+    return nullptr;
+}
+
+std::shared_ptr<DsnSchema> loadDsnSchemaDirectory(const std::string& schemaDir, const std::string& version,
+                                                  ThreadPool* pool) {
+    const DsnSchemaTables* tables = findBundledDsnSchema(schemaDir);
+    if (!tables) {
+        return DsnParser::parseDirectory(schemaDir, version, pool);
+    }
+
+    auto schema = std::make_shared<DsnSchema>(version);
+    schema->reserve(tables->attribute_count);
+    for (size_t i = 0; i < tables->attribute_count; ++i) {
+        const DsnAttributeRecord& record = tables->attributes[i];
+        DsnAttribute attr;
+        attr.full_name = record.full_name;
+        attr.short_id = record.short_id;
+        attr.bloc_name = record.bloc_name;
+        attr.bloc_label = record.bloc_label;
+        attr.description = record.description;
+        attr.type = record.type;
+        attr.min_occurs = record.min_occurs;
+        attr.max_occurs = record.max_occurs;
+        attr.mandatory = record.mandatory;
+        schema->addStaticAttribute(attr);
+    }
+    return schema;
+}
+
+} // namespace ariane_xml
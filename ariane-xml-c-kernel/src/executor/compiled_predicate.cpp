@@ -0,0 +1,217 @@
+#include "executor/compiled_predicate.h"
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+namespace ariane_xml {
+
+namespace {
+
+// strtod/strtoull need a terminated string; values are short, so copy onto
+// the stack unless they aren't
+template <typename Parse>
+bool parseTerminated(std::string_view text, Parse&& parse) {
+    char buffer[64];
+    std::string heap;
+    const char* begin;
+    if (text.size() < sizeof(buffer)) {
+        std::memcpy(buffer, text.data(), text.size());
+        buffer[text.size()] = '\0';
+        begin = buffer;
+    } else {
+        heap.assign(text.data(), text.size());
+        begin = heap.c_str();
+    }
+
+    char* end = nullptr;
+    errno = 0;
+    parse(begin, &end);
+    return end != begin && errno != ERANGE;
+}
+
+template <typename T>
+bool compareOrdered(const T& left, const T& right, ComparisonOp op) {
+    switch (op) {
+        case ComparisonOp::EQUALS:
+            return left == right;
+        case ComparisonOp::NOT_EQUALS:
+            return left != right;
+        case ComparisonOp::LESS_THAN:
+            return left < right;
+        case ComparisonOp::GREATER_THAN:
+            return left > right;
+        case ComparisonOp::LESS_EQUAL:
+            return left <= right;
+        case ComparisonOp::GREATER_EQUAL:
+            return left >= right;
+        default:
+            return false;
+    }
+}
+
+} // namespace
+
+bool CompiledPredicate::parseNumber(std::string_view text, double& number) {
+    return parseTerminated(text, [&number](const char* begin, char** end) {
+        number = std::strtod(begin, end);
+    });
+}
+
+bool CompiledPredicate::parseUnsigned(std::string_view text, unsigned long long& number) {
+    return parseTerminated(text, [&number](const char* begin, char** end) {
+        number = std::strtoull(begin, end, 10);
+    });
+}
+
+CompiledPredicate::CompiledPredicate(const WhereExpr* expr) {
+    if (expr) {
+        root_ = lower(expr);
+    }
+}
+
+uint32_t CompiledPredicate::lower(const WhereExpr* expr) {
+    Node node{NodeKind::NEVER};
+
+    if (!expr) {
+        node.kind = NodeKind::ALWAYS;  // Missing operand, as evaluateWhereExpr(nullptr)
+    } else if (const auto* condition = dynamic_cast<const WhereCondition*>(expr)) {
+        Condition compiled;
+        compiled.source_ = condition;
+
+        const FieldPath& field = condition->field;
+        for (size_t i = 0; i < field.components.size(); ++i) {
+            if (i > 0) compiled.columnName_ += ".";
+            compiled.columnName_ += field.components[i];
+        }
+        if (field.is_variable_ref) {
+            compiled.boundField_ = field;
+            if (compiled.boundField_.components.size() > 1) {
+                compiled.boundField_.components.erase(compiled.boundField_.components.begin());
+            } else {
+                compiled.boundField_.components.clear();
+            }
+        }
+
+        compiled.hasNumber_ = parseNumber(condition->value, compiled.number_);
+        compiled.hasPosition_ = parseUnsigned(condition->value, compiled.position_);
+
+        if (condition->op == ComparisonOp::LIKE || condition->op == ComparisonOp::NOT_LIKE) {
+            try {
+                compiled.pattern_ = std::make_unique<RegexMatcher>(condition->value);
+            } catch (const std::regex_error&) {
+                // Invalid pattern: the condition never matches
+            }
+        }
+
+        if (condition->op == ComparisonOp::IN || condition->op == ComparisonOp::NOT_IN) {
+            compiled.members_.reserve(condition->values.size());
+            for (const auto& value : condition->values) {
+                compiled.members_.insert(value);
+            }
+        }
+
+        node.kind = NodeKind::CONDITION;
+        node.left = static_cast<uint32_t>(conditions_.size());
+        conditions_.push_back(std::move(compiled));
+    } else if (const auto* logical = dynamic_cast<const WhereLogical*>(expr)) {
+        if (logical->op == LogicalOp::AND || logical->op == LogicalOp::OR) {
+            node.kind = logical->op == LogicalOp::AND ? NodeKind::AND : NodeKind::OR;
+            node.left = lower(logical->left.get());
+            node.right = lower(logical->right.get());
+        }
+    }
+
+    nodes_.push_back(node);
+    return static_cast<uint32_t>(nodes_.size() - 1);
+}
+
+bool CompiledPredicate::Condition::test(std::string_view value) const {
+    const WhereCondition& condition = *source_;
+
+    switch (condition.op) {
+        case ComparisonOp::IS_NULL:
+            return value.empty();
+        case ComparisonOp::IS_NOT_NULL:
+            return !value.empty();
+        default:
+            break;
+    }
+
+    if (value.empty()) {
+        return false;
+    }
+
+    switch (condition.op) {
+        case ComparisonOp::IN:
+            return members_.count(value) > 0;
+        case ComparisonOp::NOT_IN:
+            return members_.count(value) == 0;
+        case ComparisonOp::LIKE:
+        case ComparisonOp::NOT_LIKE: {
+            if (!pattern_) {
+                return false;
+            }
+            bool matches = pattern_->search(value);
+            return (condition.op == ComparisonOp::LIKE) ? matches : !matches;
+        }
+        default:
+            break;
+    }
+
+    if (condition.is_numeric) {
+        double number;
+        if (!hasNumber_ || !parseNumber(value, number)) {
+            return false;
+        }
+        return compareOrdered(number, number_, condition.op);
+    }
+
+    return compareOrdered(value, std::string_view(condition.value), condition.op);
+}
+
+bool CompiledPredicate::Condition::testAggregate(std::string_view value) const {
+    const WhereCondition& condition = *source_;
+
+    switch (condition.op) {
+        case ComparisonOp::EQUALS:
+        case ComparisonOp::NOT_EQUALS:
+            return compareOrdered(value, std::string_view(condition.value), condition.op);
+        case ComparisonOp::LESS_THAN:
+        case ComparisonOp::GREATER_THAN:
+        case ComparisonOp::LESS_EQUAL:
+        case ComparisonOp::GREATER_EQUAL: {
+            // Numerically when both sides are numbers, as text otherwise
+            double number;
+            if (hasNumber_ && parseNumber(value, number)) {
+                return compareOrdered(number, number_, condition.op);
+            }
+            return compareOrdered(value, std::string_view(condition.value), condition.op);
+        }
+        case ComparisonOp::IS_NULL:
+            return value.empty();
+        case ComparisonOp::IS_NOT_NULL:
+            return !value.empty();
+        default:
+            return false;
+    }
+}
+
+bool CompiledPredicate::Condition::testPosition(size_t position) const {
+    const WhereCondition& condition = *source_;
+
+    switch (condition.op) {
+        case ComparisonOp::EQUALS:
+            return std::to_string(position) == condition.value;
+        case ComparisonOp::NOT_EQUALS:
+            return std::to_string(position) != condition.value;
+        case ComparisonOp::LESS_THAN:
+        case ComparisonOp::GREATER_THAN:
+        case ComparisonOp::LESS_EQUAL:
+        case ComparisonOp::GREATER_EQUAL:
+            return hasPosition_ && compareOrdered<unsigned long long>(position, position_, condition.op);
+        default:
+            return false;
+    }
+}
+
+} // namespace ariane_xml
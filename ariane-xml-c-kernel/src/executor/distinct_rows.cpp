@@ -0,0 +1,227 @@
+#include "executor/distinct_rows.h"
+#include <algorithm>
+#include <cstring>
+
+namespace ariane_xml {
+
+namespace {
+
+// MurmurHash3 x64/128, fed incrementally
+class Murmur128 {
+public:
+    void add(const void* data, size_t size) {
+        const auto* bytes = static_cast<const unsigned char*>(data);
+        length_ += size;
+        while (size > 0) {
+            size_t take = std::min(size, sizeof(buffer_) - buffered_);
+            std::memcpy(buffer_ + buffered_, bytes, take);
+            buffered_ += take;
+            bytes += take;
+            size -= take;
+            if (buffered_ == sizeof(buffer_)) {
+                uint64_t k1, k2;
+                std::memcpy(&k1, buffer_, 8);
+                std::memcpy(&k2, buffer_ + 8, 8);
+                mixBlock(k1, k2);
+                buffered_ = 0;
+            }
+        }
+    }
+
+    RowHash finish() {
+        // Tail: zero padded, mixed without the block rotation
+        uint64_t k1 = 0, k2 = 0;
+        unsigned char tail[16] = {};
+        std::memcpy(tail, buffer_, buffered_);
+        std::memcpy(&k1, tail, 8);
+        std::memcpy(&k2, tail + 8, 8);
+        if (buffered_ > 8) {
+            k2 *= C2; k2 = rotl(k2, 33); k2 *= C1; h2_ ^= k2;
+        }
+        if (buffered_ > 0) {
+            k1 *= C1; k1 = rotl(k1, 31); k1 *= C2; h1_ ^= k1;
+        }
+
+        h1_ ^= length_;
+        h2_ ^= length_;
+        h1_ += h2_;
+        h2_ += h1_;
+        h1_ = fmix(h1_);
+        h2_ = fmix(h2_);
+        h1_ += h2_;
+        h2_ += h1_;
+        return {h1_, h2_};
+    }
+
+private:
+    static constexpr uint64_t C1 = 0x87c37b91114253d5ULL;
+    static constexpr uint64_t C2 = 0x4cf5ad432745937fULL;
+
+    static uint64_t rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+    static uint64_t fmix(uint64_t k) {
+        k ^= k >> 33;
+        k *= 0xff51afd7ed558ccdULL;
+        k ^= k >> 33;
+        k *= 0xc4ceb9fe1a85ec53ULL;
+        k ^= k >> 33;
+        return k;
+    }
+
+    void mixBlock(uint64_t k1, uint64_t k2) {
+        k1 *= C1; k1 = rotl(k1, 31); k1 *= C2; h1_ ^= k1;
+        h1_ = rotl(h1_, 27); h1_ += h2_; h1_ = h1_ * 5 + 0x52dce729;
+        k2 *= C2; k2 = rotl(k2, 33); k2 *= C1; h2_ ^= k2;
+        h2_ = rotl(h2_, 31); h2_ += h1_; h2_ = h2_ * 5 + 0x38495ab5;
+    }
+
+    uint64_t h1_ = 0;
+    uint64_t h2_ = 0;
+    uint64_t length_ = 0;
+    unsigned char buffer_[16];
+    size_t buffered_ = 0;
+};
+
+// Length-prefixed values valueAt(0) .. valueAt(count - 1)
+template <typename ValueAt>
+RowHash hashValues(size_t count, ValueAt valueAt) {
+    Murmur128 hash;
+    for (size_t c = 0; c < count; ++c) {
+        std::string_view value = valueAt(c);
+        uint64_t size = value.size();
+        hash.add(&size, sizeof(size));
+        hash.add(value.data(), value.size());
+    }
+    return hash.finish();
+}
+
+} // namespace
+
+RowHash RowHash::of(const ResultRow& row) {
+    return of(row, 0, row.size());
+}
+
+RowHash RowHash::of(const ResultRow& row, size_t begin, size_t end) {
+    return hashValues(end - begin, [&](size_t c) { return std::string_view(row[begin + c].second); });
+}
+
+RowHash RowHash::of(const ResultBatch& batch, size_t row) {
+    return hashValues(batch.columnCount(), [&](size_t c) { return batch.value(row, c); });
+}
+
+template <typename ValueAt>
+DistinctRows::Slot& DistinctRows::find(const RowHash& hash, ValueAt valueAt) {
+    if (slots_.empty()) {
+        slots_.resize(64);
+    }
+    size_t mask = slots_.size() - 1;
+    for (size_t i = hash.low & mask;; i = (i + 1) & mask) {
+        Slot& slot = slots_[i];
+        if (slot.row == 0) {
+            return slot;
+        }
+        if (slot.hash == hash) {
+            bool same = true;
+            for (size_t c = 0; c < batch_->columnCount() && same; ++c) {
+                same = batch_->value(slot.row - 1, c) == valueAt(c);
+            }
+            if (same) {
+                return slot;
+            }
+        }
+    }
+}
+
+void DistinctRows::claim(Slot& slot, const RowHash& hash, size_t row, size_t fileIndex) {
+    slot = Slot{hash, row + 1, fileIndex};
+    if (++size_ * 2 <= slots_.size()) {
+        return;
+    }
+
+    // Rehash: kept rows are all different, so only the hashes are needed
+    std::vector<Slot> old(slots_.size() * 2);
+    old.swap(slots_);
+    size_t mask = slots_.size() - 1;
+    for (const Slot& entry : old) {
+        if (entry.row == 0) {
+            continue;
+        }
+        size_t i = entry.hash.low & mask;
+        while (slots_[i].row != 0) {
+            i = (i + 1) & mask;
+        }
+        slots_[i] = entry;
+    }
+}
+
+void DistinctRows::append(const ResultRow& row, size_t fileIndex) {
+    if (batch_->columnCount() == 0 && batch_->empty()) {
+        // The first row sets the batch's columns
+        batch_->append(row);
+        dropped_.push_back(false);
+        RowHash hash = RowHash::of(*batch_, 0);
+        claim(find(hash, [&](size_t c) { return batch_->value(0, c); }), hash, 0, fileIndex);
+        return;
+    }
+
+    // As the batch will store it: missing values empty, extra ones dropped
+    auto valueAt = [&](size_t c) {
+        return c < row.size() ? std::string_view(row[c].second) : std::string_view();
+    };
+    RowHash hash = hashValues(batch_->columnCount(), valueAt);
+    Slot& slot = find(hash, valueAt);
+    if (slot.row != 0 && slot.fileIndex <= fileIndex) {
+        return;
+    }
+
+    size_t index = batch_->rowCount();
+    batch_->append(row);
+    dropped_.push_back(false);
+    if (slot.row == 0) {
+        claim(slot, hash, index, fileIndex);
+    } else {
+        // Seen only in a later file: this copy comes first
+        dropped_[slot.row - 1] = true;
+        slot.row = index + 1;
+        slot.fileIndex = fileIndex;
+    }
+}
+
+void DistinctRows::append(const ResultBatch& other, size_t row, ResultBatch::CodeMap& codes) {
+    if (batch_->columnCount() == 0 && batch_->empty()) {
+        // The first row sets the batch's columns
+        batch_->append(other, row, row + 1, codes);
+        dropped_.push_back(false);
+        RowHash hash = RowHash::of(*batch_, 0);
+        claim(find(hash, [&](size_t c) { return batch_->value(0, c); }), hash, 0, 0);
+        return;
+    }
+
+    auto valueAt = [&](size_t c) {
+        return c < other.columnCount() ? other.value(row, c) : std::string_view();
+    };
+    RowHash hash = hashValues(batch_->columnCount(), valueAt);
+    Slot& slot = find(hash, valueAt);
+    if (slot.row != 0) {
+        return;
+    }
+
+    size_t index = batch_->rowCount();
+    batch_->append(other, row, row + 1, codes);
+    dropped_.push_back(false);
+    claim(slot, hash, index, 0);
+}
+
+void DistinctRows::removeDuplicates(ResultBatch& batch) {
+    ResultBatch kept(batch.columnNames());
+    DistinctRows seen(kept);
+    ResultBatch::CodeMap codes;
+    for (size_t r = 0; r < batch.rowCount(); ++r) {
+        seen.append(batch, r, codes);
+    }
+    if (kept.rowCount() != batch.rowCount()) {
+        batch = std::move(kept);
+    }
+}
+
+} // namespace ariane_xml
@@ -0,0 +1,149 @@
+#include "executor/field_collector.h"
+
+namespace ariane_xml {
+
+static std::string joinPath(const std::vector<std::string>& components, size_t count) {
+    std::string joined;
+    for (size_t i = 0; i < count; ++i) {
+        if (i > 0) joined += ".";
+        joined += components[i];
+    }
+    return joined;
+}
+
+FieldCollector::FieldCollector(const std::vector<FieldPath>& fields, size_t limit) : limit_(limit) {
+    size_t collecting = 0;
+    for (size_t f = 0; f < fields.size(); ++f) {
+        const FieldPath& field = fields[f];
+        FieldState state;
+        state.field = &field;
+
+        if (field.include_filename) {
+            state.kind = FieldKind::FILENAME;
+        } else if (field.is_attribute) {
+            state.kind = FieldKind::ATTRIBUTE;
+            attributeFields_.push_back(f);
+            ++collecting;
+        } else if (!field.components.empty()) {
+            // A single name without leading dot only matches the document
+            // element; everything else is suffix matching
+            state.kind = FieldKind::ELEMENT;
+            state.anchored = field.components.size() == 1 && !field.is_partial_path;
+            automaton_.addPattern(field.components, state.anchored);
+            patternField_.push_back(f);
+            ++collecting;
+        }
+
+        fields_.push_back(std::move(state));
+    }
+
+    // Only fields read from the document can fill up
+    if (limit_ != NO_LIMIT && collecting > 0) {
+        openFields_ = collecting;
+    }
+}
+
+void FieldCollector::settle(size_t f) {
+    FieldState& state = fields_[f];
+    if (!state.done && limit_ != NO_LIMIT && state.filled >= limit_ && state.pending == 0) {
+        state.done = true;
+        --openFields_;
+    }
+}
+
+void FieldCollector::enterElement(std::string_view name) {
+    PathAutomaton::State parentState = depth_ > 0 ? frames_[depth_ - 1].state : PathAutomaton::START;
+
+    if (frames_.size() <= depth_) {
+        frames_.emplace_back();
+        path_.emplace_back();
+    }
+    Frame& frame = frames_[depth_];
+    path_[depth_].assign(name.data(), name.size());
+    ++depth_;
+
+    frame.waiting.clear();
+    frame.hasText = false;
+    frame.state = automaton_.patternCount() > 0 ? automaton_.step(parentState, name) : PathAutomaton::START;
+    if (automaton_.patternCount() == 0) {
+        return;
+    }
+
+    // pugixml accepts several top-level elements, but only the first one is
+    // the document element
+    bool laterTopLevel = depth_ == 1 && sawDocumentElement_;
+    if (depth_ == 1) {
+        sawDocumentElement_ = true;
+    }
+
+    for (uint32_t pattern : automaton_.accepted(frame.state)) {
+        size_t f = patternField_[pattern];
+        FieldState& state = fields_[f];
+        if (state.anchored && laterTopLevel) {
+            continue;
+        }
+        if (state.field->is_partial_path) {
+            state.fullPaths.insert(joinPath(path_, depth_));
+        }
+        frame.waiting.push_back({f, state.values.size()});
+        state.values.emplace_back();
+        ++state.pending;
+    }
+}
+
+void FieldCollector::text(std::string_view value) {
+    if (depth_ == 0) {
+        return;
+    }
+    Frame& frame = frames_[depth_ - 1];
+    if (!frame.hasText) {
+        frame.hasText = true;
+        for (const auto& [f, slot] : frame.waiting) {
+            fields_[f].values[slot].assign(value.data(), value.size());
+            --fields_[f].pending;
+            if (!value.empty()) {
+                ++fields_[f].filled;
+            }
+            settle(f);
+        }
+    }
+}
+
+void FieldCollector::endElement() {
+    if (depth_ > 0) {
+        --depth_;
+        // Slots of an element without text stay empty
+        Frame& frame = frames_[depth_];
+        if (!frame.hasText) {
+            for (const auto& [f, slot] : frame.waiting) {
+                --fields_[f].pending;
+                settle(f);
+            }
+        }
+    }
+}
+
+void FieldCollector::finish(const std::string& filename, std::vector<std::vector<XmlResult>>& values) {
+    values.clear();
+    for (auto& state : fields_) {
+        const FieldPath& field = *state.field;
+        std::vector<XmlResult> results;
+
+        if (state.kind == FieldKind::FILENAME) {
+            results.push_back({filename, filename});
+        } else {
+            if (state.kind == FieldKind::ELEMENT && field.is_partial_path && state.fullPaths.size() > 1) {
+                throw XmlNavigator::ambiguousPathError(
+                    joinPath(field.components, field.components.size()), state.fullPaths);
+            }
+            for (auto& value : state.values) {
+                if (!value.empty()) {
+                    results.push_back({filename, std::move(value)});
+                }
+            }
+        }
+        values.push_back(std::move(results));
+    }
+}
+
+} // namespace ariane_xml
@@ -0,0 +1,102 @@
+#include "executor/file_scheduler.h"
+#include <algorithm>
+#include <numeric>
+
+namespace ariane_xml {
+
+FileScheduler::FileScheduler(const std::vector<uintmax_t>& fileSizes, size_t workerCount, Order dispatch)
+    : sizes_(fileSizes), order_(dispatch) {
+    workerCount = std::max<size_t>(1, workerCount);
+    for (size_t i = 0; i < workerCount; ++i) {
+        queues_.push_back(std::make_unique<WorkerQueue>());
+    }
+
+    if (order_ == Order::FILE_ORDER) {
+        // Round-robin: together the queue fronts are the next files in order
+        for (size_t fileIdx = 0; fileIdx < sizes_.size(); ++fileIdx) {
+            WorkerQueue& queue = *queues_[fileIdx % workerCount];
+            queue.files.push_back(fileIdx);
+            queue.pendingBytes += sizes_[fileIdx];
+        }
+        return;
+    }
+
+    // Largest files first; ties keep directory order so runs are reproducible
+    std::vector<size_t> order(sizes_.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+        return sizes_[a] > sizes_[b];
+    });
+
+    // Greedy LPT assignment: each file goes to the least-loaded worker
+    std::vector<uintmax_t> assigned(workerCount, 0);
+    for (size_t fileIdx : order) {
+        size_t target = std::min_element(assigned.begin(), assigned.end()) - assigned.begin();
+        queues_[target]->files.push_back(fileIdx);
+        queues_[target]->pendingBytes += sizes_[fileIdx];
+        // Count empty files as one byte so they still spread across workers
+        assigned[target] += std::max<uintmax_t>(sizes_[fileIdx], 1);
+    }
+}
+
+bool FileScheduler::popFront(WorkerQueue& queue, size_t& fileIndex) {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.files.empty()) {
+        return false;
+    }
+    fileIndex = queue.files.front();
+    queue.files.pop_front();
+    queue.pendingBytes -= sizes_[fileIndex];
+    return true;
+}
+
+bool FileScheduler::next(size_t workerId, size_t& fileIndex, bool& stolen) {
+    stolen = false;
+
+    // Own queue first
+    if (popFront(*queues_[workerId % queues_.size()], fileIndex)) {
+        return true;
+    }
+
+    // Steal: no files are ever added after construction, so keep trying
+    // victims until every queue has been observed empty
+    while (true) {
+        WorkerQueue* victim = nullptr;
+        uintmax_t victimBytes = 0;
+        size_t victimFirst = 0;
+        bool anyPending = false;
+
+        for (auto& queue : queues_) {
+            std::lock_guard<std::mutex> lock(queue->mutex);
+            if (queue->files.empty()) {
+                continue;
+            }
+            anyPending = true;
+            if (order_ == Order::FILE_ORDER) {
+                // The queue holding the lowest pending index
+                if (!victim || queue->files.front() < victimFirst) {
+                    victim = queue.get();
+                    victimFirst = queue->files.front();
+                }
+                continue;
+            }
+            uintmax_t pending = queue->pendingBytes;
+            if (!victim || pending > victimBytes) {
+                victim = queue.get();
+                victimBytes = pending;
+            }
+        }
+
+        if (!anyPending) {
+            return false;
+        }
+
+        if (popFront(*victim, fileIndex)) {
+            stolen = true;
+            return true;
+        }
+        // Lost the race for that victim's last file - rescan
+    }
+}
+
+} // namespace ariane_xml
@@ -0,0 +1,408 @@
+#include "executor/hash_aggregator.h"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+
+namespace ariane_xml {
+
+namespace {
+
+// Accepts what std::stod accepts (leading blanks, trailing text ignored,
+// out of range rejected) without throwing for non-numeric values
+bool parseValue(const std::string& text, double& value) {
+    const char* begin = text.c_str();
+    char* end = nullptr;
+    errno = 0;
+    value = std::strtod(begin, &end);
+    return end != begin && errno != ERANGE;
+}
+
+const char* functionName(AggregateFunc func) {
+    switch (func) {
+        case AggregateFunc::COUNT: return "COUNT";
+        case AggregateFunc::SUM:   return "SUM";
+        case AggregateFunc::AVG:   return "AVG";
+        case AggregateFunc::MIN:   return "MIN";
+        case AggregateFunc::MAX:   return "MAX";
+        default:                   return "";
+    }
+}
+
+// Column name of a SELECT field: the alias, else FUNC(path) for an
+// aggregate, else the name the scan gives the field
+std::string columnName(const FieldPath& field) {
+    if (field.aggregate == AggregateFunc::NONE) {
+        if (field.include_filename) {
+            return "FILE_NAME";
+        }
+        if (field.is_attribute) {
+            return "@" + field.attribute_name;
+        }
+        return field.components.empty() ? "unknown" : field.components.back();
+    }
+    if (!field.alias.empty()) {
+        return field.alias;
+    }
+
+    std::string path = field.is_partial_path ? "." : "";
+    if (field.is_attribute) {
+        path += "@" + field.attribute_name;
+    } else if (!field.aggregate_arg.empty()) {
+        path += field.aggregate_arg;
+    } else {
+        for (size_t i = 0; i < field.components.size(); ++i) {
+            if (i > 0) path += ".";
+            path += field.components[i];
+        }
+    }
+    return std::string(functionName(field.aggregate)) + "(" + path + ")";
+}
+
+std::string joinedPath(const FieldPath& field) {
+    std::string path;
+    for (size_t i = 0; i < field.components.size(); ++i) {
+        if (i > 0) path += ".";
+        path += field.components[i];
+    }
+    return path;
+}
+
+// What an aggregate is computed over, written the same way for a SELECT
+// field (argument kept as text) and a HAVING field (argument split up)
+std::string aggregateArgument(const FieldPath& field) {
+    if (field.is_attribute) {
+        return "@" + field.attribute_name;
+    }
+    return field.aggregate_arg.empty() ? joinedPath(field) : field.aggregate_arg;
+}
+
+std::string lastComponent(const std::string& path) {
+    size_t dot = path.rfind('.');
+    return dot == std::string::npos ? path : path.substr(dot + 1);
+}
+
+// Find the value a HAVING condition refers to. FUNC(path) is the SELECT
+// aggregate with the same function and argument. A plain name is, in
+// order: a SELECT alias, a GROUP BY field or plain SELECT field by its
+// full path, then one of those by its last component ("name" for
+// "dept.name").
+bool resolveHaving(const AggregatePlan& plan, const CompiledPredicate::Condition& condition,
+                   AggregatePlan::HavingSource& source) {
+    const FieldPath& field = condition.field();
+    const auto& columns = plan.columns;
+
+    if (field.aggregate != AggregateFunc::NONE) {
+        std::string argument = aggregateArgument(field);
+        for (size_t c = 0; c < columns.size(); ++c) {
+            if (columns[c].func == field.aggregate && aggregateArgument(columns[c].field) == argument) {
+                source = {false, c};
+                return true;
+            }
+        }
+        return false;
+    }
+
+    const std::string& name = condition.columnName();
+    for (size_t c = 0; c < columns.size(); ++c) {
+        if (!columns[c].field.alias.empty() && columns[c].field.alias == name) {
+            source = {false, c};
+            return true;
+        }
+    }
+    for (size_t i = 0; i < plan.groupFields.size(); ++i) {
+        if (plan.groupFields[i] == name) {
+            source = {true, i};
+            return true;
+        }
+    }
+    for (size_t c = 0; c < columns.size(); ++c) {
+        if (columns[c].func == AggregateFunc::NONE && joinedPath(columns[c].field) == name) {
+            source = {false, c};
+            return true;
+        }
+    }
+    for (size_t i = 0; i < plan.groupFields.size(); ++i) {
+        if (lastComponent(plan.groupFields[i]) == name) {
+            source = {true, i};
+            return true;
+        }
+    }
+    for (size_t c = 0; c < columns.size(); ++c) {
+        if (columns[c].func == AggregateFunc::NONE && columns[c].name == name) {
+            source = {false, c};
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+AggregatePlan::AggregatePlan(const Query& query)
+    : groupColumns(query.group_by_fields.size()), having(query.having.get()) {
+    for (const auto& groupField : query.group_by_fields) {
+        groupFields.push_back(groupField.compare(0, 1, ".") == 0 ? groupField.substr(1) : groupField);
+    }
+
+    bool plain = false;
+    for (const auto& field : query.select_fields) {
+        columns.push_back({field.aggregate, columnName(field), field});
+        if (field.aggregate == AggregateFunc::NONE) {
+            plain = true;
+        }
+    }
+    columnwise = query.for_clauses.empty() && groupColumns == 0 && !plain;
+
+    for (const auto& condition : having.conditions()) {
+        HavingSource source;
+        if (resolveHaving(*this, condition, source)) {
+            havingSources.emplace(&condition.source(), source);
+        }
+    }
+}
+
+void HashAggregator::Accumulator::add(const std::string& value, bool numeric) {
+    if (value.empty()) {
+        return;
+    }
+    ++count;
+    double number = 0.0;
+    if (numeric && parseValue(value, number)) {
+        addNumber(number);
+    }
+}
+
+void HashAggregator::Accumulator::addNumber(double value) {
+    if (numbers == 0) {
+        min = value;
+        max = value;
+    } else {
+        if (value < min) min = value;
+        if (value > max) max = value;
+    }
+    ++numbers;
+    addToSum(value);
+}
+
+void HashAggregator::Accumulator::addToSum(double value) {
+    // Neumaier summation
+    double total = sum + value;
+    if (std::fabs(sum) >= std::fabs(value)) {
+        compensation += (sum - total) + value;
+    } else {
+        compensation += (value - total) + sum;
+    }
+    sum = total;
+}
+
+void HashAggregator::Accumulator::merge(const Accumulator& other) {
+    if (other.numbers > 0) {
+        if (numbers == 0) {
+            min = other.min;
+            max = other.max;
+        } else {
+            if (other.min < min) min = other.min;
+            if (other.max > max) max = other.max;
+        }
+        numbers += other.numbers;
+        addToSum(other.sum);
+        compensation += other.compensation;
+    }
+    count += other.count;
+}
+
+std::string HashAggregator::Accumulator::result(AggregateFunc func) const {
+    // Empty input gives "0" for SUM/AVG and "" for MIN/MAX
+    switch (func) {
+        case AggregateFunc::COUNT:
+            return std::to_string(count);
+        case AggregateFunc::SUM:
+            return numbers == 0 ? "0" : std::to_string(sum + compensation);
+        case AggregateFunc::AVG:
+            return numbers == 0 ? "0" : std::to_string((sum + compensation) / numbers);
+        case AggregateFunc::MIN:
+            return numbers == 0 ? "" : std::to_string(min);
+        case AggregateFunc::MAX:
+            return numbers == 0 ? "" : std::to_string(max);
+        default:
+            return "";
+    }
+}
+
+HashAggregator::HashAggregator(const AggregatePlan& plan) : plan_(&plan), slots_(64, 0) {
+    // Without GROUP BY the single group exists from the start
+    if (plan.groupColumns == 0) {
+        RowHash hash = RowHash::of(ResultRow());
+        addGroup(hash.low & (slots_.size() - 1), hash, {}, std::numeric_limits<size_t>::max());
+    }
+}
+
+template <typename SameKey>
+size_t HashAggregator::findSlot(const RowHash& hash, SameKey sameKey) const {
+    size_t mask = slots_.size() - 1;
+    for (size_t i = hash.low & mask;; i = (i + 1) & mask) {
+        size_t entry = slots_[i];
+        if (entry == 0) {
+            return i;
+        }
+        const Group& group = groups_[entry - 1];
+        if (group.hash == hash && sameKey(group)) {
+            return i;
+        }
+    }
+}
+
+HashAggregator::Group& HashAggregator::addGroup(size_t slot, const RowHash& hash,
+                                                std::vector<std::string> key, size_t fileIndex) {
+    Group group;
+    group.hash = hash;
+    group.key = std::move(key);
+    group.accumulators.resize(plan_->columns.size());
+    group.firstValues.resize(plan_->columns.size());
+    group.firstFile = fileIndex;
+    groups_.push_back(std::move(group));
+    slots_[slot] = groups_.size();
+
+    if (groups_.size() * 2 > slots_.size()) {
+        // Rehash from the stored hashes; every group key is different
+        std::vector<size_t> old(slots_.size() * 2, 0);
+        old.swap(slots_);
+        size_t mask = slots_.size() - 1;
+        for (size_t g = 0; g < groups_.size(); ++g) {
+            size_t i = groups_[g].hash.low & mask;
+            while (slots_[i] != 0) {
+                i = (i + 1) & mask;
+            }
+            slots_[i] = g + 1;
+        }
+    }
+    return groups_.back();
+}
+
+void HashAggregator::add(const std::vector<ResultRow>& rows, size_t fileIndex) {
+    const size_t groupColumns = plan_->groupColumns;
+    const size_t columnCount = plan_->columns.size();
+
+    for (const auto& row : rows) {
+        if (row.size() < groupColumns + columnCount) {
+            continue;
+        }
+
+        RowHash hash = RowHash::of(row, 0, groupColumns);
+        size_t slot = findSlot(hash, [&](const Group& group) {
+            for (size_t i = 0; i < groupColumns; ++i) {
+                if (group.key[i] != row[i].second) {
+                    return false;
+                }
+            }
+            return true;
+        });
+
+        Group* group;
+        bool first;
+        if (slots_[slot] == 0) {
+            std::vector<std::string> key;
+            key.reserve(groupColumns);
+            for (size_t i = 0; i < groupColumns; ++i) {
+                key.push_back(row[i].second);
+            }
+            group = &addGroup(slot, hash, std::move(key), fileIndex);
+            first = true;
+        } else {
+            group = &groups_[slots_[slot] - 1];
+            first = fileIndex < group->firstFile;
+            if (first) {
+                group->firstFile = fileIndex;
+            }
+        }
+
+        for (size_t c = 0; c < columnCount; ++c) {
+            const std::string& value = row[groupColumns + c].second;
+            AggregateFunc func = plan_->columns[c].func;
+            if (func != AggregateFunc::NONE) {
+                group->accumulators[c].add(value, func != AggregateFunc::COUNT);
+            } else if (first) {
+                group->firstValues[c] = value;
+            }
+        }
+    }
+}
+
+void HashAggregator::addColumns(const std::vector<std::vector<XmlResult>>& columns) {
+    // Rows zipped from these would pad short columns with empty values,
+    // which no aggregate counts
+    Group& group = groups_[0];
+    for (size_t c = 0; c < columns.size() && c < plan_->columns.size(); ++c) {
+        Accumulator& accumulator = group.accumulators[c];
+        bool numeric = plan_->columns[c].func != AggregateFunc::COUNT;
+        for (const auto& result : columns[c]) {
+            accumulator.add(result.value, numeric);
+        }
+    }
+}
+
+void HashAggregator::merge(const HashAggregator& other) {
+    for (const Group& theirs : other.groups_) {
+        size_t slot = findSlot(theirs.hash, [&](const Group& group) { return group.key == theirs.key; });
+        if (slots_[slot] == 0) {
+            Group& group = addGroup(slot, theirs.hash, theirs.key, theirs.firstFile);
+            group.accumulators = theirs.accumulators;
+            group.firstValues = theirs.firstValues;
+            continue;
+        }
+
+        Group& group = groups_[slots_[slot] - 1];
+        for (size_t c = 0; c < group.accumulators.size(); ++c) {
+            group.accumulators[c].merge(theirs.accumulators[c]);
+        }
+        if (theirs.firstFile < group.firstFile) {
+            group.firstFile = theirs.firstFile;
+            group.firstValues = theirs.firstValues;
+        }
+    }
+}
+
+std::vector<ResultRow> HashAggregator::take() {
+    std::vector<Group*> ordered;
+    ordered.reserve(groups_.size());
+    for (auto& group : groups_) {
+        ordered.push_back(&group);
+    }
+    std::sort(ordered.begin(), ordered.end(),
+              [](const Group* a, const Group* b) { return a->key < b->key; });
+
+    std::vector<ResultRow> rows;
+    rows.reserve(ordered.size());
+    for (Group* group : ordered) {
+        ResultRow row;
+        row.reserve(plan_->columns.size());
+        for (size_t c = 0; c < plan_->columns.size(); ++c) {
+            const auto& column = plan_->columns[c];
+            if (column.func != AggregateFunc::NONE) {
+                row.push_back({column.name, group->accumulators[c].result(column.func)});
+            } else {
+                row.push_back({column.name, std::move(group->firstValues[c])});
+            }
+        }
+
+        bool kept = plan_->having.evaluate([&](const CompiledPredicate::Condition& condition) {
+            auto it = plan_->havingSources.find(&condition.source());
+            if (it == plan_->havingSources.end()) {
+                return false;
+            }
+            const AggregatePlan::HavingSource& source = it->second;
+            return condition.testAggregate(source.groupKey ? group->key[source.index] : row[source.index].second);
+        });
+        if (kept) {
+            rows.push_back(std::move(row));
+        }
+    }
+
+    groups_.clear();
+    slots_.assign(slots_.size(), 0);
+    return rows;
+}
+
+} // namespace ariane_xml
@@ -0,0 +1,90 @@
+#include "executor/path_automaton.h"
+#include <algorithm>
+
+namespace ariane_xml {
+
+size_t PathAutomaton::addPattern(const std::vector<std::string>& components, bool anchored) {
+    Pattern pattern;
+    pattern.anchored = anchored;
+    for (const auto& component : components) {
+        auto it = symbols_.find(std::string_view(component));
+        if (it == symbols_.end()) {
+            names_.push_back(component);
+            it = symbols_.emplace(std::string_view(names_.back()),
+                                  static_cast<uint32_t>(names_.size())).first;
+        }
+        pattern.symbols.push_back(it->second);
+    }
+    patterns_.push_back(std::move(pattern));
+    return patterns_.size() - 1;
+}
+
+uint32_t PathAutomaton::symbolOf(std::string_view name) const {
+    auto it = symbols_.find(name);
+    return it == symbols_.end() ? OTHER_SYMBOL : it->second;
+}
+
+PathAutomaton::State PathAutomaton::intern(std::vector<Item> items) {
+    std::sort(items.begin(), items.end());
+    items.erase(std::unique(items.begin(), items.end()), items.end());
+
+    auto it = stateIds_.find(items);
+    if (it != stateIds_.end()) {
+        return it->second;
+    }
+
+    State id = static_cast<State>(states_.size());
+    std::vector<uint32_t> accepts;
+    for (const auto& [pattern, matched] : items) {
+        if (matched == patterns_[pattern].symbols.size()) {
+            accepts.push_back(pattern);
+        }
+    }
+    stateIds_.emplace(items, id);
+    states_.push_back(std::move(items));
+    accepts_.push_back(std::move(accepts));
+    transitions_.emplace_back(names_.size() + 1, UNKNOWN);
+    return id;
+}
+
+PathAutomaton::State PathAutomaton::step(State state, std::string_view name) {
+    if (states_.empty()) {
+        // Anchored patterns can only start from the document level
+        std::vector<Item> start;
+        for (uint32_t p = 0; p < patterns_.size(); ++p) {
+            if (patterns_[p].anchored) {
+                start.push_back({p, 0});
+            }
+        }
+        intern(std::move(start));
+    }
+
+    uint32_t symbol = symbolOf(name);
+    State cached = transitions_[state][symbol];
+    if (cached != UNKNOWN) {
+        return cached;
+    }
+
+    std::vector<Item> next;
+    if (symbol != OTHER_SYMBOL) {
+        for (const auto& [pattern, matched] : states_[state]) {
+            const auto& symbols = patterns_[pattern].symbols;
+            if (matched < symbols.size() && symbols[matched] == symbol) {
+                next.push_back({pattern, matched + 1});
+            }
+        }
+        // Unanchored patterns may start at any element
+        for (uint32_t p = 0; p < patterns_.size(); ++p) {
+            const auto& pattern = patterns_[p];
+            if (!pattern.anchored && !pattern.symbols.empty() && pattern.symbols[0] == symbol) {
+                next.push_back({p, 1});
+            }
+        }
+    }
+
+    State target = intern(std::move(next));
+    transitions_[state][symbol] = target;  // intern() may have grown transitions_
+    return target;
+}
+
+} // namespace ariane_xml
@@ -1,5 +1,12 @@
 #include "executor/query_executor.h"
+#include "executor/stream_scanner.h"
+#include "executor/row_sorter.h"
+#include "executor/distinct_rows.h"
+#include "executor/hash_aggregator.h"
 #include "utils/xml_loader.h"
+#include "utils/thread_pool.h"
+#include "utils/document_cache.h"
+#include "utils/element_index.h"
 #include "error/error_codes.h"
 #include <filesystem>
 #include <iostream>
@@ -7,10 +14,12 @@
 #include <functional>
 #include <thread>
 #include <mutex>
+#include <condition_variable>
+#include <memory>
 #include <atomic>
 #include <chrono>
 #include <limits>
-#include <set>
+#include <iterator>
 
 namespace ariane_xml {
 
@@ -33,310 +42,322 @@ static FieldPath extractFieldPathFromWhere(const WhereExpr* expr) {
     return FieldPath();
 }
 
-std::vector<ResultRow> QueryExecutor::execute(const Query& query) {
-    std::vector<ResultRow> allResults;
-
-    // Get all XML files from the directory
-    std::vector<std::string> xmlFiles = getXmlFiles(query.from_path);
-
-    if (xmlFiles.empty()) {
-        std::cerr << "Warning: No XML files found in " << query.from_path << std::endl;
-        return allResults;
+// Stat an explicit file list so the scheduler can order it by size
+static std::vector<XmlFileInfo> statXmlFiles(const std::vector<std::string>& paths) {
+    std::vector<XmlFileInfo> files;
+    files.reserve(paths.size());
+    for (const auto& path : paths) {
+        std::error_code ec;
+        uintmax_t size = std::filesystem::file_size(path, ec);
+        files.push_back({path, ec ? 0 : size});
     }
+    return files;
+}
 
-    // Check if any aggregate functions are used
-    bool hasAggregates = false;
-    for (const auto& field : query.select_fields) {
-        if (field.aggregate != AggregateFunc::NONE) {
-            hasAggregates = true;
-            break;
+// Rows one worker produced for one file: rows [begin, end) of its batch
+struct ResultChunk {
+    size_t fileIndex;
+    size_t begin;
+    size_t end;
+};
+
+// Rows one worker produced, file after file in the order it scanned them
+struct WorkerResults {
+    ResultBatch rows;
+    std::vector<ResultChunk> chunks;
+    std::vector<bool> dropped;  // DISTINCT: superseded by an earlier file's copy
+};
+
+// Concatenate per-worker results in file order. Runs after the workers have
+// joined, so no locking is needed, and the output matches a serial scan row
+// for row. For DISTINCT, rows a worker already dropped are skipped, and when
+// there are several workers the merge itself goes through one DistinctRows
+// table, so a row kept by more than one of them is appended once, at its
+// first place in file order.
+static ResultBatch mergeResultChunks(
+    std::vector<WorkerResults>& workers,
+    size_t fileCount,
+    bool distinct = false
+) {
+    std::vector<std::pair<const WorkerResults*, const ResultChunk*>> byFile(fileCount, {nullptr, nullptr});
+    WorkerResults* only = nullptr;
+    size_t producers = 0;
+    for (auto& worker : workers) {
+        for (const auto& chunk : worker.chunks) {
+            byFile[chunk.fileIndex] = {&worker, &chunk};
+        }
+        if (!worker.chunks.empty()) {
+            only = &worker;
+            producers++;
         }
     }
 
-    // Process each file - for aggregates, we need to build a modified query
-    if (hasAggregates) {
-        // For aggregate queries, build a temporary query to extract fields
-        Query tempQuery;
-        tempQuery.from_path = query.from_path;
-        tempQuery.where = nullptr;  // We'll handle WHERE separately for now
-        tempQuery.distinct = false;
-        tempQuery.limit = -1;
-        tempQuery.offset = -1;
+    if (producers == 0) {
+        return ResultBatch();
+    }
 
-        // Convert aggregate fields to regular fields for extraction
-        for (const auto& field : query.select_fields) {
-            if (field.aggregate != AggregateFunc::NONE) {
-                // Extract the underlying field for aggregation
-                FieldPath extractField;
-                extractField.aggregate = AggregateFunc::NONE;
-
-                // If aggregate_arg is set, parse it into components
-                if (!field.aggregate_arg.empty()) {
-                    // Copy the is_partial_path flag from the original field
-                    // (the parser sets this when it encounters a leading dot)
-                    extractField.is_partial_path = field.is_partial_path;
-
-                    // Parse the aggregate_arg into components
-                    // Note: leading dot is already consumed by parser, so aggregate_arg doesn't include it
-                    std::string argToParse = field.aggregate_arg;
-                    size_t start = 0;
-                    size_t dot = argToParse.find('.');
-                    while (dot != std::string::npos) {
-                        std::string component = argToParse.substr(start, dot - start);
-                        if (!component.empty()) {
-                            extractField.components.push_back(component);
-                        }
-                        start = dot + 1;
-                        dot = argToParse.find('.', start);
-                    }
-                    std::string lastComponent = argToParse.substr(start);
-                    if (!lastComponent.empty()) {
-                        extractField.components.push_back(lastComponent);
-                    }
-                } else {
-                    // Otherwise use the existing components
-                    extractField.components = field.components;
-                    extractField.is_attribute = field.is_attribute;
-                    extractField.attribute_name = field.attribute_name;
-                    extractField.is_partial_path = field.is_partial_path;
-                }
+    // A single worker that scanned its files in order hands over its batch
+    if (producers == 1 &&
+        std::is_sorted(only->chunks.begin(), only->chunks.end(),
+                       [](const ResultChunk& a, const ResultChunk& b) { return a.fileIndex < b.fileIndex; }) &&
+        std::find(only->dropped.begin(), only->dropped.end(), true) == only->dropped.end()) {
+        return std::move(only->rows);
+    }
 
-                tempQuery.select_fields.push_back(extractField);
-            }
+    // Each worker's dictionary codes are translated once, not per row
+    ResultBatch merged;
+    DistinctRows unique(merged);
+    std::vector<ResultBatch::CodeMap> codes(workers.size());
+    for (const auto& [worker, chunk] : byFile) {
+        if (!worker) {
+            continue;
         }
-
-        // Process files to extract field values
-        for (const auto& filepath : xmlFiles) {
-            try {
-                auto fileResults = processFile(filepath, tempQuery);
-                allResults.insert(allResults.end(), fileResults.begin(), fileResults.end());
-            } catch (const std::exception& e) {
-                std::cerr << "Error processing file " << filepath << ": " << e.what() << std::endl;
+        ResultBatch::CodeMap& workerCodes = codes[worker - workers.data()];
+        if (distinct && producers > 1) {
+            for (size_t row = chunk->begin; row < chunk->end; ++row) {
+                if (worker->dropped.empty() || !worker->dropped[row]) {
+                    unique.append(worker->rows, row, workerCodes);
+                }
             }
+            continue;
         }
-
-        // Now compute aggregates
-        ResultRow aggregateRow;
-        for (const auto& field : query.select_fields) {
-            std::string fieldName;
-            std::string path;
-
-            // Add leading dot for partial paths
-            if (field.is_partial_path) {
-                path = ".";
-            }
-
-            if (field.is_attribute) {
-                path += "@" + field.attribute_name;
-            } else if (!field.aggregate_arg.empty()) {
-                // Use aggregate_arg if it was set by parseSelectField()
-                path += field.aggregate_arg;
-            } else {
-                for (size_t i = 0; i < field.components.size(); ++i) {
-                    if (i > 0) path += ".";
-                    path += field.components[i];
-                }
+        // Copy runs of rows that weren't dropped
+        size_t row = chunk->begin;
+        while (row < chunk->end) {
+            size_t end = row;
+            while (end < chunk->end && (worker->dropped.empty() || !worker->dropped[end])) {
+                ++end;
             }
+            merged.append(worker->rows, row, end, workerCodes);
+            row = end + 1;
+        }
+    }
+    return merged;
+}
 
-            switch (field.aggregate) {
-                case AggregateFunc::COUNT: fieldName = "COUNT(" + path + ")"; break;
-                case AggregateFunc::SUM:   fieldName = "SUM(" + path + ")"; break;
-                case AggregateFunc::AVG:   fieldName = "AVG(" + path + ")"; break;
-                case AggregateFunc::MIN:   fieldName = "MIN(" + path + ")"; break;
-                case AggregateFunc::MAX:   fieldName = "MAX(" + path + ")"; break;
-                default: break;
+// The first K rows in ORDER BY order, kept in a bounded heap whose top is
+// the row that would be dropped next. Ties go to the earlier scan position
+// (file, then row), so the result matches a full sort + truncate.
+class TopKRows {
+public:
+    TopKRows(const RowOrder& order, size_t k) : order_(&order), k_(k) {}
+
+    void push(ResultRow&& row, size_t fileIndex, size_t rowIndex) {
+        candidate_.keys.resize(order_->keyCount());
+        order_->decode(row, candidate_.keys.data());
+        candidate_.fileIndex = fileIndex;
+        candidate_.rowIndex = rowIndex;
+
+        if (heap_.size() >= k_) {
+            if (!before(candidate_, heap_.front())) {
+                return;
             }
-
-            std::string aggregateValue = computeAggregate(field, allResults);
-            aggregateRow.push_back({fieldName, aggregateValue});
+            std::pop_heap(heap_.begin(), heap_.end(), comparator());
+            heap_.pop_back();
         }
-
-        return {aggregateRow};
+        // Moving the row keeps its strings in place, so the keys stay valid
+        candidate_.row = std::move(row);
+        heap_.push_back(std::move(candidate_));
+        std::push_heap(heap_.begin(), heap_.end(), comparator());
+        candidate_ = Entry();
     }
 
-    // Non-aggregate query - process normally
-    // Create a modified select_fields list that includes ORDER BY fields (for sorting)
-    std::vector<FieldPath> modifiedSelectFields = query.select_fields;
-    std::vector<std::string> tempOrderByFields;  // Track which fields we added temporarily
-
-    if (!query.order_by_fields.empty() && !hasAggregates) {
-        for (const auto& orderByField : query.order_by_fields) {
-            // Check if this ORDER BY field is already in SELECT clause
-            bool alreadyInSelect = false;
-            for (const auto& selectField : query.select_fields) {
-                std::string selectFieldName;
-                if (selectField.is_attribute) {
-                    selectFieldName = selectField.attribute_name;
-                } else if (!selectField.components.empty()) {
-                    selectFieldName = selectField.components.back();
-                }
-
-                if (selectFieldName == orderByField.field_name) {
-                    alreadyInSelect = true;
-                    break;
+    void merge(TopKRows& other) {
+        for (auto& entry : other.heap_) {
+            if (heap_.size() >= k_) {
+                if (!before(entry, heap_.front())) {
+                    continue;
                 }
+                std::pop_heap(heap_.begin(), heap_.end(), comparator());
+                heap_.pop_back();
             }
+            heap_.push_back(std::move(entry));
+            std::push_heap(heap_.begin(), heap_.end(), comparator());
+        }
+        other.heap_.clear();
+    }
 
-            // If not in SELECT, add it temporarily
-            if (!alreadyInSelect) {
-                FieldPath tempField;
-                tempField.is_partial_path = true;  // Use partial path (leading dot)
-                tempField.components.push_back(orderByField.field_name);
-                modifiedSelectFields.push_back(tempField);
-                tempOrderByFields.push_back(orderByField.field_name);
-            }
+    // The kept rows in order
+    ResultBatch take() {
+        std::sort_heap(heap_.begin(), heap_.end(), comparator());
+        ResultBatch rows;
+        for (const auto& entry : heap_) {
+            rows.append(entry.row);
         }
+        heap_.clear();
+        return rows;
     }
 
-    // Temporarily modify select_fields (we'll use const_cast since we restore it immediately after)
-    auto& mutableQuery = const_cast<Query&>(query);
-    auto originalSelectFields = mutableQuery.select_fields;
-    mutableQuery.select_fields = modifiedSelectFields;
+private:
+    struct Entry {
+        std::vector<RowOrder::Key> keys;  // Views into 'row'
+        size_t fileIndex = 0;
+        size_t rowIndex = 0;
+        ResultRow row;
+    };
 
-    for (const auto& filepath : xmlFiles) {
-        try {
-            auto fileResults = processFile(filepath, query);
-            allResults.insert(allResults.end(), fileResults.begin(), fileResults.end());
-        } catch (const std::exception& e) {
-            std::cerr << "Error processing file " << filepath << ": " << e.what() << std::endl;
+    // True if 'a' comes before 'b' in the output
+    bool before(const Entry& a, const Entry& b) const {
+        int result = order_->compare(a.keys.data(), b.keys.data());
+        if (result != 0) {
+            return result < 0;
+        }
+        if (a.fileIndex != b.fileIndex) {
+            return a.fileIndex < b.fileIndex;
         }
+        return a.rowIndex < b.rowIndex;
     }
 
-    // Restore original select_fields
-    mutableQuery.select_fields = originalSelectFields;
-
-    // Apply DISTINCT if specified
-    if (query.distinct && !allResults.empty()) {
-        std::vector<ResultRow> uniqueResults;
-        std::set<std::string> seen;
-
-        for (const auto& row : allResults) {
-            // Build a unique key from all field values in the row
-            std::string rowKey;
-            for (const auto& [field, value] : row) {
-                if (!rowKey.empty()) rowKey += "|||";
-                rowKey += value;
-            }
+    // Heap order: the entry that comes last in the output is on top
+    struct Comparator {
+        const TopKRows* rows;
+        bool operator()(const Entry& a, const Entry& b) const { return rows->before(a, b); }
+    };
 
-            // Only add if we haven't seen this combination before
-            if (seen.find(rowKey) == seen.end()) {
-                seen.insert(rowKey);
-                uniqueResults.push_back(row);
-            }
+    Comparator comparator() const { return Comparator{this}; }
+
+    const RowOrder* order_;
+    size_t k_;
+    Entry candidate_;  // Decoded before deciding whether the row is kept
+    std::vector<Entry> heap_;
+};
+
+// LIMIT without ORDER BY keeps the first rows in file order. Rows found so
+// far are counted per file (Fenwick tree over file indices): once the files
+// before a file have produced 'limit' rows, that file can't contribute and
+// is skipped, and no file needs more rows than the earlier ones leave over.
+// Workers finish files out of order, so only completed files are counted.
+class RowQuota {
+public:
+    RowQuota(size_t fileCount, size_t limit) : limit_(limit), counts_(fileCount + 1, 0) {}
+
+    // Rows file 'fileIndex' may still add to the result (0: skip the file)
+    size_t remaining(size_t fileIndex) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t before = 0;
+        for (size_t i = fileIndex; i > 0; i &= i - 1) {
+            before += counts_[i];
         }
+        return before >= limit_ ? 0 : limit_ - before;
+    }
 
-        allResults = std::move(uniqueResults);
+    void record(size_t fileIndex, size_t rows) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (size_t i = fileIndex + 1; i < counts_.size(); i += i & (~i + 1)) {
+            counts_[i] += rows;
+        }
     }
 
-    // Apply ORDER BY if specified
-    if (!query.order_by_fields.empty()) {
-        const OrderByField& orderByField = query.order_by_fields[0]; // For now, support first field only
-        const std::string& orderField = orderByField.field_name;
-        bool descending = (orderByField.direction == SortDirection::DESC);
-
-        std::sort(allResults.begin(), allResults.end(),
-            [&orderField, descending](const ResultRow& a, const ResultRow& b) {
-                // Find the field in both rows
-                std::string aValue, bValue;
-
-                for (const auto& [field, value] : a) {
-                    if (field == orderField) {
-                        aValue = value;
-                        break;
-                    }
-                }
+private:
+    size_t limit_;
+    std::vector<size_t> counts_;
+    mutable std::mutex mutex_;
+};
+
+// Apply OFFSET (skip the first N rows), then LIMIT
+static void applyOffsetAndLimit(ResultBatch& rows, const Query& query) {
+    size_t begin = query.offset >= 0 ? std::min(static_cast<size_t>(query.offset), rows.rowCount()) : 0;
+    size_t end = rows.rowCount();
+    if (query.limit >= 0) {
+        end = std::min(end, begin + static_cast<size_t>(query.limit));
+    }
+    if (begin > 0 || end < rows.rowCount()) {
+        rows = rows.slice(begin, end);
+    }
+}
 
-                for (const auto& [field, value] : b) {
-                    if (field == orderField) {
-                        bValue = value;
-                        break;
-                    }
-                }
+ResultBatch QueryExecutor::execute(const Query& query, ThreadPool* pool, DocumentCache* cache) {
+    // Get all XML files from the directory
+    std::vector<XmlFileInfo> xmlFiles = scanXmlFiles(query.from_path);
 
-                // Try numeric comparison first
-                try {
-                    double aNum = std::stod(aValue);
-                    double bNum = std::stod(bValue);
-                    // For descending, we want larger values first (a > b means a before b)
-                    // For ascending, we want smaller values first (a < b means a before b)
-                    return descending ? (aNum > bNum) : (aNum < bNum);
-                } catch (...) {
-                    // Fall back to string comparison
-                    return descending ? (aValue > bValue) : (aValue < bValue);
-                }
-            }
-        );
+    if (xmlFiles.empty()) {
+        std::cerr << "Warning: No XML files found in " << query.from_path << std::endl;
+        return ResultBatch();
     }
 
-    // Remove temporary ORDER BY fields that were added for sorting
-    if (!tempOrderByFields.empty()) {
-        for (auto& row : allResults) {
-            ResultRow filteredRow;
-            for (const auto& [field, value] : row) {
-                // Keep field only if it's not a temporary ORDER BY field
-                bool isTemp = false;
-                for (const auto& tempField : tempOrderByFields) {
-                    if (field == tempField) {
-                        isTemp = true;
-                        break;
-                    }
-                }
-                if (!isTemp) {
-                    filteredRow.push_back({field, value});
-                }
-            }
-            row = std::move(filteredRow);
-        }
-    }
+    return executePipeline(query, xmlFiles, nullptr, nullptr, pool, cache);
+}
 
-    // Apply DISTINCT if specified (remove duplicate rows)
-    if (query.distinct) {
-        std::vector<ResultRow> uniqueResults;
-        std::set<std::string> seen;  // Store serialized rows for comparison
+ResultBatch QueryExecutor::executeWithFiles(
+    const Query& query,
+    const std::vector<std::string>& xmlFiles,
+    ThreadPool* pool,
+    DocumentCache* cache
+) {
+    if (xmlFiles.empty()) {
+        return ResultBatch();
+    }
 
-        for (const auto& row : allResults) {
-            // Serialize the row for comparison
-            std::string rowKey;
-            for (const auto& [field, value] : row) {
-                rowKey += field + ":" + value + "|";
-            }
+    return executePipeline(query, statXmlFiles(xmlFiles), nullptr, nullptr, pool, cache);
+}
 
-            // Only add if we haven't seen this row before
-            if (seen.find(rowKey) == seen.end()) {
-                seen.insert(rowKey);
-                uniqueResults.push_back(row);
-            }
-        }
+ResultBatch QueryExecutor::executeWithProgress(
+    const Query& query,
+    ProgressCallback progressCallback,
+    ExecutionStats* stats,
+    ThreadPool* pool,
+    DocumentCache* cache
+) {
+    // Get all XML files
+    std::vector<XmlFileInfo> xmlFiles = scanXmlFiles(query.from_path);
 
-        allResults = std::move(uniqueResults);
+    if (xmlFiles.empty()) {
+        std::cerr << "Warning: No XML files found in " << query.from_path << std::endl;
+        return ResultBatch();
     }
 
-    // Apply OFFSET if specified (skip first N results)
-    if (query.offset >= 0 && static_cast<size_t>(query.offset) < allResults.size()) {
-        allResults.erase(allResults.begin(), allResults.begin() + query.offset);
-    } else if (query.offset >= 0 && static_cast<size_t>(query.offset) >= allResults.size()) {
-        // Offset is beyond the result set, return empty
-        allResults.clear();
-    }
+    return executePipeline(query, xmlFiles, progressCallback, stats, pool, cache);
+}
 
-    // Apply LIMIT if specified (after offset)
-    if (query.limit >= 0 && static_cast<size_t>(query.limit) < allResults.size()) {
-        allResults.resize(query.limit);
+ResultBatch QueryExecutor::executeWithProgressAndFiles(
+    const Query& query,
+    const std::vector<std::string>& xmlFiles,
+    ProgressCallback progressCallback,
+    ExecutionStats* stats,
+    ThreadPool* pool,
+    DocumentCache* cache
+) {
+    if (xmlFiles.empty()) {
+        return ResultBatch();
     }
 
-    return allResults;
+    return executePipeline(query, statXmlFiles(xmlFiles), progressCallback, stats, pool, cache);
 }
 
-std::vector<ResultRow> QueryExecutor::executeWithFiles(
+ResultBatch QueryExecutor::executePipeline(
     const Query& query,
-    const std::vector<std::string>& xmlFiles
+    const std::vector<XmlFileInfo>& xmlFiles,
+    ProgressCallback progressCallback,
+    ExecutionStats* stats,
+    ThreadPool* pool,
+    DocumentCache* cache
 ) {
-    std::vector<ResultRow> allResults;
+    auto startTime = std::chrono::high_resolution_clock::now();
 
-    if (xmlFiles.empty()) {
-        return allResults;
+    size_t fileCount = xmlFiles.size();
+    bool useThreading = shouldUseThreading(fileCount);
+    size_t threadCount = useThreading ? getOptimalThreadCount() : 1;
+    if (pool) {
+        threadCount = std::min(threadCount, pool->size());
+    }
+
+    // Update stats if provided
+    if (stats) {
+        stats->total_files = fileCount;
+        stats->thread_count = threadCount;
+        stats->used_threading = useThreading;
     }
 
+    auto finish = [&](ResultBatch results) {
+        if (stats) {
+            auto endTime = std::chrono::high_resolution_clock::now();
+            stats->execution_time_seconds = std::chrono::duration<double>(endTime - startTime).count();
+        }
+        return results;
+    };
+
+    ResultBatch allResults;
+
     // Check if any aggregate functions are used
     bool hasAggregates = false;
     for (const auto& field : query.select_fields) {
@@ -346,18 +367,106 @@ std::vector<ResultRow> QueryExecutor::executeWithFiles(
         }
     }
 
-    // For aggregates, use the standard execute with from_path
-    // (filtering doesn't make sense for aggregates across mixed files)
+    // Aggregate queries: the scan folds its rows into per-group partial
+    // aggregates (see HashAggregator) and returns one row per group. FOR
+    // queries produce the GROUP BY and SELECT columns themselves.
     if (hasAggregates) {
-        return execute(query);
+        Query tempQuery;
+        const Query* scanQuery = &query;
+        if (query.for_clauses.empty()) {
+            // For aggregate queries, build a temporary query to extract fields
+            tempQuery.from_path = query.from_path;
+            tempQuery.where = nullptr;  // We'll handle WHERE separately for now
+            tempQuery.distinct = false;
+            tempQuery.limit = -1;
+            tempQuery.offset = -1;
+
+            // GROUP BY fields come first, searched like partial paths
+            for (const auto& groupField : query.group_by_fields) {
+                FieldPath groupPath;
+                size_t start = 0;
+                for (size_t dot = groupField.find('.'); dot != std::string::npos; dot = groupField.find('.', start)) {
+                    if (dot > start) {
+                        groupPath.components.push_back(groupField.substr(start, dot - start));
+                    }
+                    start = dot + 1;
+                }
+                if (start < groupField.size()) {
+                    groupPath.components.push_back(groupField.substr(start));
+                }
+                groupPath.is_partial_path = true;
+                tempQuery.select_fields.push_back(groupPath);
+            }
+
+            // Convert aggregate fields to regular fields for extraction; plain
+            // fields are scanned as they are
+            for (const auto& field : query.select_fields) {
+                if (field.aggregate == AggregateFunc::NONE) {
+                    tempQuery.select_fields.push_back(field);
+                } else {
+                    // Extract the underlying field for aggregation
+                    FieldPath extractField;
+                    extractField.aggregate = AggregateFunc::NONE;
+
+                    // If aggregate_arg is set, parse it into components
+                    if (!field.aggregate_arg.empty()) {
+                        // Copy the is_partial_path flag from the original field
+                        // (the parser sets this when it encounters a leading dot)
+                        extractField.is_partial_path = field.is_partial_path;
+
+                        // Parse the aggregate_arg into components
+                        // Note: leading dot is already consumed by parser, so aggregate_arg doesn't include it
+                        std::string argToParse = field.aggregate_arg;
+                        size_t start = 0;
+                        size_t dot = argToParse.find('.');
+                        while (dot != std::string::npos) {
+                            std::string component = argToParse.substr(start, dot - start);
+                            if (!component.empty()) {
+                                extractField.components.push_back(component);
+                            }
+                            start = dot + 1;
+                            dot = argToParse.find('.', start);
+                        }
+                        std::string lastComponent = argToParse.substr(start);
+                        if (!lastComponent.empty()) {
+                            extractField.components.push_back(lastComponent);
+                        }
+                    } else {
+                        // Otherwise use the existing components
+                        extractField.components = field.components;
+                        extractField.is_attribute = field.is_attribute;
+                        extractField.attribute_name = field.attribute_name;
+                        extractField.is_partial_path = field.is_partial_path;
+                    }
+
+                    tempQuery.select_fields.push_back(extractField);
+                }
+            }
+
+            scanQuery = &tempQuery;
+        }
+
+        AggregatePlan plan(query);
+        allResults = scanFiles(xmlFiles, *scanQuery, threadCount, progressCallback, stats, pool, cache,
+                               0, NO_ROW_LIMIT, &plan);
+
+        // The aggregator already dropped the groups HAVING rejects; ORDER BY,
+        // OFFSET and LIMIT apply to the remaining groups
+        if (!query.order_by_fields.empty()) {
+            RowSorter(query.order_by_fields, pool).sort(allResults);
+        }
+        applyOffsetAndLimit(allResults, query);
+        return finish(std::move(allResults));
     }
 
-    // Non-aggregate query - process the provided files
+    // Non-aggregate query - process normally
+    // Create a modified select_fields list that includes ORDER BY fields (for sorting)
     std::vector<FieldPath> modifiedSelectFields = query.select_fields;
-    std::vector<std::string> tempOrderByFields;
+    std::vector<std::string> tempOrderByFields;  // Track which fields we added temporarily
 
     if (!query.order_by_fields.empty()) {
         for (const auto& orderByField : query.order_by_fields) {
+            // Check if this ORDER BY field is already in SELECT clause
             bool alreadyInSelect = false;
             for (const auto& selectField : query.select_fields) {
                 std::string selectFieldName;
@@ -366,14 +475,17 @@ std::vector<ResultRow> QueryExecutor::executeWithFiles(
                 } else if (!selectField.components.empty()) {
                     selectFieldName = selectField.components.back();
                 }
+
                 if (selectFieldName == orderByField.field_name) {
                     alreadyInSelect = true;
                     break;
                 }
             }
+
+            // If not in SELECT, add it temporarily
             if (!alreadyInSelect) {
                 FieldPath tempField;
-                tempField.is_partial_path = true;
+                tempField.is_partial_path = true;  // Use partial path (leading dot)
                 tempField.components.push_back(orderByField.field_name);
                 modifiedSelectFields.push_back(tempField);
                 tempOrderByFields.push_back(orderByField.field_name);
@@ -381,154 +493,81 @@ std::vector<ResultRow> QueryExecutor::executeWithFiles(
         }
     }
 
+    // Temporarily modify select_fields (we'll use const_cast since we restore it immediately after).
+    // Workers only read the query, so the swap must happen before scanning starts.
     auto& mutableQuery = const_cast<Query&>(query);
     auto originalSelectFields = mutableQuery.select_fields;
     mutableQuery.select_fields = modifiedSelectFields;
 
-    for (const auto& filepath : xmlFiles) {
-        try {
-            auto fileResults = processFile(filepath, query);
-            allResults.insert(allResults.end(), fileResults.begin(), fileResults.end());
-        } catch (const std::exception& e) {
-            std::cerr << "Error processing file " << filepath << ": " << e.what() << std::endl;
-        }
+    // ORDER BY ... LIMIT only needs the first OFFSET + LIMIT rows, which the
+    // scan keeps in bounded heaps instead of materialising every row
+    size_t topK = 0;
+    if (!query.order_by_fields.empty() && query.limit > 0 && !query.distinct) {
+        topK = static_cast<size_t>(query.limit) + static_cast<size_t>(std::max(query.offset, 0));
     }
 
-    mutableQuery.select_fields = originalSelectFields;
-
-    // Apply DISTINCT
-    if (query.distinct && !allResults.empty()) {
-        std::vector<ResultRow> uniqueResults;
-        std::set<std::string> seen;
-        for (const auto& row : allResults) {
-            std::string rowKey;
-            for (const auto& [field, value] : row) {
-                if (!rowKey.empty()) rowKey += "|||";
-                rowKey += value;
-            }
-            if (seen.find(rowKey) == seen.end()) {
-                seen.insert(rowKey);
-                uniqueResults.push_back(row);
-            }
-        }
-        allResults = std::move(uniqueResults);
-    }
-
-    // Apply ORDER BY
-    if (!query.order_by_fields.empty() && !allResults.empty()) {
-        const OrderByField& orderByField = query.order_by_fields[0];
-        const std::string& orderField = orderByField.field_name;
-        bool descending = (orderByField.direction == SortDirection::DESC);
-
-        std::sort(allResults.begin(), allResults.end(),
-            [&orderField, descending](const ResultRow& a, const ResultRow& b) {
-                std::string valA, valB;
-                for (const auto& [field, value] : a) {
-                    if (field.find(orderField) != std::string::npos ||
-                        field == orderField) {
-                        valA = value;
-                        break;
-                    }
-                }
-                for (const auto& [field, value] : b) {
-                    if (field.find(orderField) != std::string::npos ||
-                        field == orderField) {
-                        valB = value;
-                        break;
-                    }
-                }
-                if (descending) {
-                    return valA > valB;
-                }
-                return valA < valB;
-            });
-
-        // Remove temporary ORDER BY fields
-        if (!tempOrderByFields.empty()) {
-            for (auto& row : allResults) {
-                row.erase(
-                    std::remove_if(row.begin(), row.end(),
-                        [&tempOrderByFields](const std::pair<std::string, std::string>& p) {
-                            for (const auto& tempField : tempOrderByFields) {
-                                if (p.first.find(tempField) != std::string::npos) {
-                                    return true;
-                                }
-                            }
-                            return false;
-                        }),
-                    row.end());
-            }
-        }
-    }
-
-    // Apply OFFSET
-    if (query.offset > 0 && static_cast<size_t>(query.offset) < allResults.size()) {
-        allResults.erase(allResults.begin(), allResults.begin() + query.offset);
-    } else if (query.offset > 0) {
-        allResults.clear();
+    // Without ORDER BY, DISTINCT or grouping, LIMIT keeps the first rows in
+    // file order, so the scan can stop once OFFSET + LIMIT of them exist
+    size_t rowLimit = NO_ROW_LIMIT;
+    if (query.limit >= 0 && query.order_by_fields.empty() && !query.distinct &&
+        !query.has_aggregates && query.group_by_fields.empty()) {
+        rowLimit = static_cast<size_t>(query.limit) + static_cast<size_t>(std::max(query.offset, 0));
     }
 
-    // Apply LIMIT
-    if (query.limit >= 0 && static_cast<size_t>(query.limit) < allResults.size()) {
-        allResults.resize(query.limit);
-    }
-
-    return allResults;
-}
-
-std::vector<ResultRow> QueryExecutor::executeWithProgressAndFiles(
-    const Query& query,
-    const std::vector<std::string>& xmlFiles,
-    ProgressCallback progressCallback,
-    ExecutionStats* stats
-) {
-    auto startTime = std::chrono::high_resolution_clock::now();
-
-    if (xmlFiles.empty()) {
-        return std::vector<ResultRow>();
-    }
+    allResults = scanFiles(xmlFiles, query, threadCount, progressCallback, stats, pool, cache, topK, rowLimit);
 
-    size_t fileCount = xmlFiles.size();
-    bool useThreading = shouldUseThreading(fileCount);
-    size_t threadCount = useThreading ? getOptimalThreadCount() : 1;
+    // Restore original select_fields
+    mutableQuery.select_fields = originalSelectFields;
 
-    if (stats) {
-        stats->total_files = fileCount;
-        stats->thread_count = threadCount;
-        stats->used_threading = useThreading;
+    // Apply ORDER BY if specified (top-K scans come back sorted)
+    if (!query.order_by_fields.empty() && topK == 0) {
+        RowSorter(query.order_by_fields, pool).sort(allResults);
     }
 
-    // For simplicity, use executeWithFiles for now
-    // (threading with filtered files can be added later)
-    auto results = executeWithFiles(query, xmlFiles);
-
-    // Final progress update
-    if (progressCallback) {
-        progressCallback(fileCount, fileCount, threadCount);
+    // Remove temporary ORDER BY fields that were added for sorting
+    for (size_t column = allResults.columnCount(); column-- > 0;) {
+        const std::string& field = allResults.columnNames()[column];
+        if (std::find(tempOrderByFields.begin(), tempOrderByFields.end(), field) != tempOrderByFields.end()) {
+            allResults.removeColumn(column);
+        }
     }
 
-    auto endTime = std::chrono::high_resolution_clock::now();
-    if (stats) {
-        stats->execution_time_seconds = std::chrono::duration<double>(endTime - startTime).count();
+    // The scan applied DISTINCT including the temporary ORDER BY columns;
+    // rows that only differed there collapse now, keeping the first in order
+    if (query.distinct && !tempOrderByFields.empty()) {
+        DistinctRows::removeDuplicates(allResults);
     }
 
-    return results;
+    applyOffsetAndLimit(allResults, query);
+    return finish(std::move(allResults));
 }
 
 std::vector<std::string> QueryExecutor::getXmlFiles(const std::string& path) {
     std::vector<std::string> xmlFiles;
+    for (auto& file : scanXmlFiles(path)) {
+        xmlFiles.push_back(std::move(file.path));
+    }
+    return xmlFiles;
+}
+
+std::vector<XmlFileInfo> QueryExecutor::scanXmlFiles(const std::string& path) {
+    std::vector<XmlFileInfo> xmlFiles;
 
     try {
         if (std::filesystem::is_regular_file(path)) {
             // Single file
             if (XmlLoader::isXmlFile(path)) {
-                xmlFiles.push_back(path);
+                std::error_code ec;
+                uintmax_t size = std::filesystem::file_size(path, ec);
+                xmlFiles.push_back({path, ec ? 0 : size});
             }
         } else if (std::filesystem::is_directory(path)) {
-            // Directory - scan for XML files
+            // Directory - scan for XML files (sizes come from the directory entry)
             for (const auto& entry : std::filesystem::directory_iterator(path)) {
                 if (entry.is_regular_file() && XmlLoader::isXmlFile(entry.path().string())) {
-                    xmlFiles.push_back(entry.path().string());
+                    std::error_code ec;
+                    uintmax_t size = entry.file_size(ec);
+                    xmlFiles.push_back({entry.path().string(), ec ? 0 : size});
                 }
             }
         } else if (std::filesystem::exists(path)) {
@@ -552,15 +591,15 @@ std::vector<std::string> QueryExecutor::getXmlFiles(const std::string& path) {
     return xmlFiles;
 }
 
-// Forward declaration of HAVING evaluation helper
-static bool evaluateHavingCondition(const ResultRow& row, const WhereExpr* expr);
-
 // Process a single file with FOR clause context binding
 std::vector<ResultRow> QueryExecutor::processFileWithForClauses(
     [[maybe_unused]] const std::string& filepath,
     const Query& query,
+    const QueryPredicates& predicates,
     const pugi::xml_document& doc,
-    const std::string& filename
+    const std::string& filename,
+    const ElementIndex* index,
+    size_t rowLimit
 ) {
     std::vector<ResultRow> results;
 
@@ -575,352 +614,31 @@ std::vector<ResultRow> QueryExecutor::processFileWithForClauses(
     std::map<std::string, size_t> positionContext;
 
     // Start nested iteration from document root
-    processNestedForClauses(doc.document_element(), query, varContext, positionContext, 0, filename, results);
-
-    // If query has aggregations, apply aggregation logic
-    if (query.has_aggregates && !results.empty()) {
-        std::vector<ResultRow> aggregatedResults;
-
-        // For now, assume no GROUP BY - aggregate all results into a single row
-        // TODO: Add GROUP BY support
-        if (query.group_by_fields.empty()) {
-            ResultRow aggregatedRow;
-
-            // Process each SELECT field
-            for (const auto& field : query.select_fields) {
-                if (field.aggregate != AggregateFunc::NONE) {
-                    std::string fieldName = field.alias.empty() ?
-                        (std::string(field.aggregate == AggregateFunc::COUNT ? "COUNT" :
-                                    field.aggregate == AggregateFunc::SUM ? "SUM" :
-                                    field.aggregate == AggregateFunc::AVG ? "AVG" :
-                                    field.aggregate == AggregateFunc::MIN ? "MIN" : "MAX") +
-                         "(" + field.aggregate_arg + ")") : field.alias;
-
-                    // Find this field in the results and aggregate
-                    std::vector<std::string> values;
-                    for (const auto& row : results) {
-                        for (const auto& [name, val] : row) {
-                            if (name == fieldName || name.find(field.aggregate_arg) != std::string::npos) {
-                                values.push_back(val);
-                                break;
-                            }
-                        }
-                    }
-
-                    // Apply aggregation function
-                    std::string aggregatedValue;
-                    switch (field.aggregate) {
-                        case AggregateFunc::COUNT:
-                            aggregatedValue = std::to_string(values.size());
-                            break;
-                        case AggregateFunc::SUM: {
-                            double sum = 0;
-                            for (const auto& v : values) {
-                                try {
-                                    sum += std::stod(v);
-                                } catch (...) {
-                                    // Skip non-numeric values
-                                }
-                            }
-                            aggregatedValue = std::to_string(sum);
-                            break;
-                        }
-                        case AggregateFunc::AVG: {
-                            double sum = 0;
-                            size_t count = 0;
-                            for (const auto& v : values) {
-                                try {
-                                    sum += std::stod(v);
-                                    count++;
-                                } catch (...) {
-                                    // Skip non-numeric values
-                                }
-                            }
-                            aggregatedValue = count > 0 ? std::to_string(sum / count) : "0";
-                            break;
-                        }
-                        case AggregateFunc::MIN: {
-                            double minVal = std::numeric_limits<double>::max();
-                            for (const auto& v : values) {
-                                try {
-                                    double val = std::stod(v);
-                                    if (val < minVal) minVal = val;
-                                } catch (...) {
-                                    // Skip non-numeric values
-                                }
-                            }
-                            aggregatedValue = minVal == std::numeric_limits<double>::max() ? "0" : std::to_string(minVal);
-                            break;
-                        }
-                        case AggregateFunc::MAX: {
-                            double maxVal = std::numeric_limits<double>::lowest();
-                            for (const auto& v : values) {
-                                try {
-                                    double val = std::stod(v);
-                                    if (val > maxVal) maxVal = val;
-                                } catch (...) {
-                                    // Skip non-numeric values
-                                }
-                            }
-                            aggregatedValue = maxVal == std::numeric_limits<double>::lowest() ? "0" : std::to_string(maxVal);
-                            break;
-                        }
-                        default:
-                            aggregatedValue = "0";
-                    }
-
-                    aggregatedRow.push_back({fieldName, aggregatedValue});
-                }
-            }
-
-            // Apply HAVING filter if present (for global aggregation)
-            if (!query.having || evaluateHavingCondition(aggregatedRow, query.having.get())) {
-                aggregatedResults.push_back(aggregatedRow);
-            }
-            return aggregatedResults;
-        } else {
-            // Handle GROUP BY aggregations
-            // Group results by GROUP BY field values
-            std::map<std::string, std::vector<ResultRow>> groups;
-
-            for (const auto& row : results) {
-                // Build group key from GROUP BY fields
-                std::string groupKey;
-                for (const auto& groupField : query.group_by_fields) {
-                    std::string groupByFieldName = "__GROUP_BY__" + groupField;
-                    for (const auto& [name, val] : row) {
-                        if (name == groupByFieldName) {
-                            if (!groupKey.empty()) groupKey += "|||";
-                            groupKey += val;
-                            break;
-                        }
-                    }
-                }
-                groups[groupKey].push_back(row);
-            }
-
-            // For each group, compute aggregations
-            for (const auto& [groupKey, groupRows] : groups) {
-                ResultRow aggregatedRow;
-
-                // First, add the GROUP BY field values to the result
-                size_t groupFieldIndex = 0;
-                std::string remainingKey = groupKey;
-                for (const auto& groupField : query.group_by_fields) {
-                    // Extract value from group key
-                    std::string groupValue;
-                    size_t pos = remainingKey.find("|||");
-                    if (pos != std::string::npos) {
-                        groupValue = remainingKey.substr(0, pos);
-                        remainingKey = remainingKey.substr(pos + 3);
-                    } else {
-                        groupValue = remainingKey;
-                    }
-
-                    // Add to result row (use the field name directly, not the __GROUP_BY__ prefix)
-                    aggregatedRow.push_back({groupField, groupValue});
-                    groupFieldIndex++;
-                }
-
-                // Process each SELECT field
-                for (const auto& field : query.select_fields) {
-                    if (field.aggregate != AggregateFunc::NONE) {
-                        std::string fieldName = field.alias.empty() ?
-                            (std::string(field.aggregate == AggregateFunc::COUNT ? "COUNT" :
-                                        field.aggregate == AggregateFunc::SUM ? "SUM" :
-                                        field.aggregate == AggregateFunc::AVG ? "AVG" :
-                                        field.aggregate == AggregateFunc::MIN ? "MIN" : "MAX") +
-                             "(" + field.aggregate_arg + ")") : field.alias;
-
-                        // Collect values from this group
-                        std::vector<std::string> values;
-                        for (const auto& row : groupRows) {
-                            for (const auto& [name, val] : row) {
-                                // Match field name, excluding __GROUP_BY__ fields
-                                if (name.find("__GROUP_BY__") != 0 &&
-                                    (name == fieldName || name.find(field.aggregate_arg) != std::string::npos)) {
-                                    values.push_back(val);
-                                    break;
-                                }
-                            }
-                        }
-
-                        // Apply aggregation function
-                        std::string aggregatedValue;
-                        switch (field.aggregate) {
-                            case AggregateFunc::COUNT:
-                                aggregatedValue = std::to_string(values.size());
-                                break;
-                            case AggregateFunc::SUM: {
-                                double sum = 0;
-                                for (const auto& v : values) {
-                                    try {
-                                        sum += std::stod(v);
-                                    } catch (...) {}
-                                }
-                                aggregatedValue = std::to_string(sum);
-                                break;
-                            }
-                            case AggregateFunc::AVG: {
-                                double sum = 0;
-                                size_t count = 0;
-                                for (const auto& v : values) {
-                                    try {
-                                        sum += std::stod(v);
-                                        count++;
-                                    } catch (...) {}
-                                }
-                                aggregatedValue = count > 0 ? std::to_string(sum / count) : "0";
-                                break;
-                            }
-                            case AggregateFunc::MIN: {
-                                double minVal = std::numeric_limits<double>::max();
-                                for (const auto& v : values) {
-                                    try {
-                                        double val = std::stod(v);
-                                        if (val < minVal) minVal = val;
-                                    } catch (...) {}
-                                }
-                                aggregatedValue = minVal == std::numeric_limits<double>::max() ? "0" : std::to_string(minVal);
-                                break;
-                            }
-                            case AggregateFunc::MAX: {
-                                double maxVal = std::numeric_limits<double>::lowest();
-                                for (const auto& v : values) {
-                                    try {
-                                        double val = std::stod(v);
-                                        if (val > maxVal) maxVal = val;
-                                    } catch (...) {}
-                                }
-                                aggregatedValue = maxVal == std::numeric_limits<double>::lowest() ? "0" : std::to_string(maxVal);
-                                break;
-                            }
-                            default:
-                                aggregatedValue = "0";
-                        }
-
-                        aggregatedRow.push_back({fieldName, aggregatedValue});
-                    }
-                }
-
-                // Apply HAVING filter if present
-                if (!query.having || evaluateHavingCondition(aggregatedRow, query.having.get())) {
-                    aggregatedResults.push_back(aggregatedRow);
-                }
-            }
-
-            return aggregatedResults;
-        }
-    }
+    processNestedForClauses(doc.document_element(), query, predicates, varContext, positionContext, 0, filename, results,
+                            index, 0, rowLimit);
 
     return results;
 }
 
-// Helper function to evaluate HAVING condition on an aggregated result row
-static bool evaluateHavingCondition(const ResultRow& row, const WhereExpr* expr) {
-    if (!expr) return true;
-
-    // Simple condition
-    if (const auto* condition = dynamic_cast<const WhereCondition*>(expr)) {
-        // Find the field value in the aggregated row
-        // The field name could be:
-        // - An alias (e.g., "avg_sal")
-        // - A GROUP BY field (e.g., "dept.name")
-        // - An aggregation function (e.g., "COUNT(emp)")
-
-        std::string fieldToFind;
-        if (!condition->field.components.empty()) {
-            // Build the field name from components
-            fieldToFind = condition->field.components[0];
-            for (size_t i = 1; i < condition->field.components.size(); ++i) {
-                fieldToFind += "." + condition->field.components[i];
-            }
-        }
-
-        // Search for matching field in the row
-        std::string fieldValue;
-        bool found = false;
-        for (const auto& [name, val] : row) {
-            // Match by exact name or if name contains the field
-            if (name == fieldToFind || name.find(fieldToFind) != std::string::npos) {
-                fieldValue = val;
-                found = true;
-                break;
-            }
-        }
-
-        if (!found) {
-            return false; // Field not found in aggregated row
-        }
-
-        // Evaluate the condition
-        switch (condition->op) {
-            case ComparisonOp::EQUALS:
-                return fieldValue == condition->value;
-            case ComparisonOp::NOT_EQUALS:
-                return fieldValue != condition->value;
-            case ComparisonOp::LESS_THAN:
-                try {
-                    return std::stod(fieldValue) < std::stod(condition->value);
-                } catch (...) {
-                    return fieldValue < condition->value;
-                }
-            case ComparisonOp::GREATER_THAN:
-                try {
-                    return std::stod(fieldValue) > std::stod(condition->value);
-                } catch (...) {
-                    return fieldValue > condition->value;
-                }
-            case ComparisonOp::LESS_EQUAL:
-                try {
-                    return std::stod(fieldValue) <= std::stod(condition->value);
-                } catch (...) {
-                    return fieldValue <= condition->value;
-                }
-            case ComparisonOp::GREATER_EQUAL:
-                try {
-                    return std::stod(fieldValue) >= std::stod(condition->value);
-                } catch (...) {
-                    return fieldValue >= condition->value;
-                }
-            case ComparisonOp::IS_NULL:
-                return fieldValue.empty();
-            case ComparisonOp::IS_NOT_NULL:
-                return !fieldValue.empty();
-            default:
-                return false;
-        }
-    }
-    // Logical expression (AND/OR)
-    else if (const auto* logical = dynamic_cast<const WhereLogical*>(expr)) {
-        bool leftResult = evaluateHavingCondition(row, logical->left.get());
-        bool rightResult = evaluateHavingCondition(row, logical->right.get());
-
-        if (logical->op == LogicalOp::AND) {
-            return leftResult && rightResult;
-        } else if (logical->op == LogicalOp::OR) {
-            return leftResult || rightResult;
-        }
-    }
-
-    return false;
-}
-
 // Recursive function to handle nested FOR clauses
 void QueryExecutor::processNestedForClauses(
     const pugi::xml_node& currentContext,
     const Query& query,
+    const QueryPredicates& predicates,
     std::map<std::string, pugi::xml_node>& varContext,
     std::map<std::string, size_t>& positionContext,
     size_t forClauseIndex,
     const std::string& filename,
-    std::vector<ResultRow>& results
+    std::vector<ResultRow>& results,
+    const ElementIndex* index,
+    size_t positionBase,
+    size_t rowLimit
 ) {
     // Base case: all FOR clauses processed, now extract SELECT fields
     if (forClauseIndex >= query.for_clauses.size()) {
         // Check WHERE clause if present
-        if (query.where) {
-            if (!evaluateWhereWithContext(varContext, positionContext, query.where.get(), query)) {
+        if (!predicates.where.empty()) {
+            if (!evaluateWhereWithContext(varContext, positionContext, predicates.where, query, index)) {
                 return; // Skip this combination if WHERE fails
             }
         }
@@ -956,7 +674,7 @@ void QueryExecutor::processNestedForClauses(
                     groupPath.variable_name = groupPath.components[0];
                 }
 
-                std::string groupValue = resolveFieldWithContext(groupPath, varContext, positionContext, currentContext, query);
+                std::string groupValue = resolveFieldWithContext(groupPath, varContext, positionContext, currentContext, query, index);
                 row.push_back({"__GROUP_BY__" + groupField, groupValue});
             }
         }
@@ -1034,7 +752,7 @@ void QueryExecutor::processNestedForClauses(
                                 // Not a variable - resolve as field path from current context
                                 FieldPath argPath;
                                 argPath.components = argComponents;
-                                value = resolveFieldWithContext(argPath, varContext, positionContext, currentContext, query);
+                                value = resolveFieldWithContext(argPath, varContext, positionContext, currentContext, query, index);
                             }
                         }
                         break;
@@ -1049,7 +767,7 @@ void QueryExecutor::processNestedForClauses(
                 fieldName = field.components.back();
 
                 // Resolve field using variable context and position context
-                value = resolveFieldWithContext(field, varContext, positionContext, currentContext, query);
+                value = resolveFieldWithContext(field, varContext, positionContext, currentContext, query, index);
             } else {
                 fieldName = "unknown";
                 value = "";
@@ -1086,19 +804,21 @@ void QueryExecutor::processNestedForClauses(
 
             if (subPath.size() == 1) {
                 // Simple child search
-                std::function<void(const pugi::xml_node&)> findElements =
-                    [&](const pugi::xml_node& node) {
-                        if (node.type() == pugi::node_element && node.name() == subPath[0]) {
-                            iterationNodes.push_back(node);
-                        }
-                        for (pugi::xml_node child : node.children()) {
-                            findElements(child);
-                        }
-                    };
-                findElements(parentNode);
+                if (!index || !index->findByName(parentNode, subPath[0], iterationNodes)) {
+                    std::function<void(const pugi::xml_node&)> findElements =
+                        [&](const pugi::xml_node& node) {
+                            if (node.type() == pugi::node_element && node.name() == subPath[0]) {
+                                iterationNodes.push_back(node);
+                            }
+                            for (pugi::xml_node child : node.children()) {
+                                findElements(child);
+                            }
+                        };
+                    findElements(parentNode);
+                }
             } else if (!subPath.empty()) {
                 // Multi-component path from parent node
-                XmlNavigator::findNodesByPartialPath(parentNode, subPath, iterationNodes);
+                XmlNavigator::findNodesByPartialPath(parentNode, subPath, iterationNodes, index);
             }
         } else {
             // Not a variable reference - search from document root
@@ -1119,22 +839,24 @@ void QueryExecutor::processNestedForClauses(
                     }
                 } else {
                     // Leading dot: partial path - recursive search
-                    std::function<void(const pugi::xml_node&)> findElements =
-                        [&](const pugi::xml_node& node) {
-                            if (node.type() == pugi::node_element && node.name() == elementName) {
-                                iterationNodes.push_back(node);
-                            }
-                            for (pugi::xml_node child : node.children()) {
-                                findElements(child);
-                            }
-                        };
-                    findElements(docRoot);
+                    if (!index || !index->findByName(docRoot, elementName, iterationNodes)) {
+                        std::function<void(const pugi::xml_node&)> findElements =
+                            [&](const pugi::xml_node& node) {
+                                if (node.type() == pugi::node_element && node.name() == elementName) {
+                                    iterationNodes.push_back(node);
+                                }
+                                for (pugi::xml_node child : node.children()) {
+                                    findElements(child);
+                                }
+                            };
+                        findElements(docRoot);
+                    }
                 }
             } else {
                 // Multi-component path
                 // For partial paths (.department.employee), use suffix matching
                 // For non-partial paths (company.department.employee), use full path matching
-                XmlNavigator::findNodesByPartialPath(docRoot, forClause.path.components, iterationNodes);
+                XmlNavigator::findNodesByPartialPath(docRoot, forClause.path.components, iterationNodes, index);
 
                 // If not a partial path, filter to only exact full path matches
                 if (!forClause.path.is_partial_path) {
@@ -1177,8 +899,12 @@ void QueryExecutor::processNestedForClauses(
     }
 
     // Iterate over found nodes and recursively process next FOR clause
-    size_t position = 1;  // XQuery positions start at 1
+    size_t position = positionBase + 1;  // XQuery positions start at 1
     for (const auto& node : iterationNodes) {
+        if (results.size() >= rowLimit) {
+            break;
+        }
+
         // Bind this node to the variable
         varContext[forClause.variable] = node;
 
@@ -1188,7 +914,8 @@ void QueryExecutor::processNestedForClauses(
         }
 
         // Recursively process next FOR clause
-        processNestedForClauses(node, query, varContext, positionContext, forClauseIndex + 1, filename, results);
+        processNestedForClauses(node, query, predicates, varContext, positionContext, forClauseIndex + 1, filename, results,
+                                index, 0, rowLimit);
 
         // Unbind variable (cleanup for next iteration)
         varContext.erase(forClause.variable);
@@ -1206,7 +933,8 @@ std::string QueryExecutor::resolveFieldWithContext(
     const std::map<std::string, pugi::xml_node>& varContext,
     const std::map<std::string, size_t>& positionContext,
     const pugi::xml_node& fallbackContext,
-    const Query& query
+    const Query& query,
+    const ElementIndex* index
 ) {
     std::string value;
 
@@ -1236,14 +964,14 @@ std::string QueryExecutor::resolveFieldWithContext(
                 value = contextNode.child_value();
             } else if (subPath.size() == 1) {
                 // Simple child lookup
-                pugi::xml_node childNode = XmlNavigator::findFirstElementByName(contextNode, subPath[0]);
+                pugi::xml_node childNode = XmlNavigator::findFirstElementByName(contextNode, subPath[0], index);
                 if (childNode) {
                     value = childNode.child_value();
                 }
             } else {
                 // Multi-component path from variable node
                 std::vector<pugi::xml_node> fieldNodes;
-                XmlNavigator::findNodesByPartialPath(contextNode, subPath, fieldNodes);
+                XmlNavigator::findNodesByPartialPath(contextNode, subPath, fieldNodes, index);
                 if (!fieldNodes.empty()) {
                     value = fieldNodes[0].child_value();
                 }
@@ -1252,182 +980,387 @@ std::string QueryExecutor::resolveFieldWithContext(
     } else {
         // Normal field (not a variable reference) - use fallback context
         if (field.components.size() == 1) {
-            pugi::xml_node foundNode = XmlNavigator::findFirstElementByName(fallbackContext, field.components[0]);
+            pugi::xml_node foundNode = XmlNavigator::findFirstElementByName(fallbackContext, field.components[0], index);
             if (foundNode) {
                 value = foundNode.child_value();
             }
         } else {
             std::vector<pugi::xml_node> fieldNodes;
-            XmlNavigator::findNodesByPartialPath(fallbackContext, field.components, fieldNodes);
+            XmlNavigator::findNodesByPartialPath(fallbackContext, field.components, fieldNodes, index);
             if (!fieldNodes.empty()) {
                 value = fieldNodes[0].child_value();
             }
         }
     }
 
-    return value;
+    return value;
+}
+
+// Evaluate WHERE expression with variable context
+bool QueryExecutor::evaluateWhereWithContext(
+    const std::map<std::string, pugi::xml_node>& varContext,
+    const std::map<std::string, size_t>& positionContext,
+    const CompiledPredicate& where,
+    const Query& query,
+    const ElementIndex* index
+) {
+    return where.evaluate([&](const CompiledPredicate::Condition& condition) {
+        const FieldPath& field = condition.field();
+
+        // Check if this is a position variable in WHERE clause
+        if (field.is_variable_ref && !field.variable_name.empty() &&
+            query.isPositionVariable(field.variable_name)) {
+            auto posIt = positionContext.find(field.variable_name);
+            return posIt != positionContext.end() && condition.testPosition(posIt->second);
+        }
+
+        // Resolve field in condition
+        if (field.is_variable_ref && !field.variable_name.empty()) {
+            // Evaluate relative to the node bound to the variable
+            auto varIt = varContext.find(field.variable_name);
+            if (varIt == varContext.end()) {
+                return false; // Variable not found
+            }
+            return condition.test(XmlNavigator::getNodeValueRelative(
+                varIt->second, condition.boundField(), 0, index));
+        }
+
+        // No variable reference - this shouldn't happen with FOR clauses but handle it
+        // Use the last bound variable's context if available
+        if (!varContext.empty()) {
+            return condition.test(XmlNavigator::getNodeValueRelative(
+                varContext.rbegin()->second, field, 0, index));
+        }
+        return false;
+    });
+}
+
+// Build result rows from per-field value lists: row i holds the i-th value
+// of every field (empty when a field has fewer values)
+std::vector<ResultRow> QueryExecutor::zipFieldValues(
+    const Query& query,
+    const std::vector<std::vector<XmlResult>>& fieldResults,
+    size_t rowLimit
+) {
+    std::vector<ResultRow> results;
+
+    // Combine results
+    // For MVP, we'll take the cross product of all field values
+    if (fieldResults.empty()) {
+        return results;
+    }
+
+    // Find the maximum number of results
+    size_t maxResults = 0;
+    for (const auto& fr : fieldResults) {
+        maxResults = std::max(maxResults, fr.size());
+    }
+    maxResults = std::min(maxResults, rowLimit);
+
+    // Create result rows
+    for (size_t i = 0; i < maxResults; ++i) {
+        ResultRow row;
+        for (size_t fieldIdx = 0; fieldIdx < query.select_fields.size(); ++fieldIdx) {
+            const auto& field = query.select_fields[fieldIdx];
+            const auto& fr = fieldResults[fieldIdx];
+
+            std::string fieldName;
+            std::string fieldValue;
+
+            if (field.include_filename) {
+                fieldName = "FILE_NAME";
+            } else if (field.is_attribute) {
+                fieldName = "@" + field.attribute_name;
+            } else if (!field.components.empty()) {
+                fieldName = field.components.back();
+            } else {
+                fieldName = "unknown";
+            }
+
+            if (i < fr.size()) {
+                fieldValue = fr[i].value;
+            } else {
+                fieldValue = "";
+            }
+
+            row.push_back({fieldName, fieldValue});
+        }
+        results.push_back(row);
+    }
+
+    return results;
+}
+
+// WHERE on a multi-component field: evaluate the condition on every node
+// matching the field's parent path below 'root' and extract the SELECT fields
+void QueryExecutor::collectWhereRows(
+    const pugi::xml_node& root,
+    const Query& query,
+    const QueryPredicates& predicates,
+    const std::vector<std::string>& parentPath,
+    const std::string& filename,
+    std::vector<ResultRow>& results,
+    const ElementIndex* index,
+    size_t rowLimit
+) {
+    std::vector<pugi::xml_node> candidateNodes;
+    XmlNavigator::findNodesByPartialPath(root, parentPath, candidateNodes, index);
+
+    // Filter nodes based on WHERE expression
+    // Pass parentPath.size() so evaluation uses relative path navigation
+    for (const auto& node : candidateNodes) {
+        if (results.size() >= rowLimit) {
+            break;
+        }
+        if (XmlNavigator::evaluateWhere(node, predicates.where, parentPath.size(), index)) {
+            // Extract select fields from this node
+            ResultRow row;
+
+            for (const auto& field : query.select_fields) {
+                std::string fieldName;
+                std::string value;
+
+                if (field.include_filename) {
+                    fieldName = "FILE_NAME";
+                    value = filename;
+                } else if (field.is_attribute) {
+                    fieldName = "@" + field.attribute_name;
+                    // Extract attribute from current node
+                    pugi::xml_attribute attr = node.attribute(field.attribute_name.c_str());
+                    if (attr) {
+                        value = attr.value();
+                    }
+                } else if (!field.components.empty()) {
+                    fieldName = field.components.back();
+
+                    // Shorthand: use first element search
+                    if (field.components.size() == 1) {
+                        pugi::xml_node foundNode = XmlNavigator::findFirstElementByName(node, field.components[0], index);
+                        if (foundNode) {
+                            value = foundNode.child_value();
+                        }
+                    } else {
+                        // Use partial path matching relative to current node
+                        // First, try to find the field using partial path from this node
+                        std::vector<pugi::xml_node> fieldNodes;
+                        XmlNavigator::findNodesByPartialPath(node, field.components, fieldNodes, index);
+
+                        if (!fieldNodes.empty()) {
+                            // Use the first match
+                            value = fieldNodes[0].child_value();
+                        }
+                    }
+                } else {
+                    fieldName = "unknown";
+                    value = "";
+                }
+
+                row.push_back({fieldName, value});
+            }
+
+            results.push_back(row);
+        }
+    }
+}
+
+bool QueryExecutor::processFileStreaming(
+    const std::string& filepath,
+    const std::string& filename,
+    const Query& query,
+    const QueryPredicates& predicates,
+    std::vector<ResultRow>& results,
+    size_t rowLimit
+) {
+    bool streamed = false;
+
+    if (query.for_clauses.empty() && !query.where) {
+        // Plain SELECT: collect every field's values in one pass
+        std::vector<std::vector<XmlResult>> fieldResults;
+        if (StreamScanner::extractValues(filepath, filename, query.select_fields, fieldResults, rowLimit)) {
+            results = zipFieldValues(query, fieldResults, rowLimit);
+            return true;
+        }
+        return false;
+    }
+
+    if (query.for_clauses.empty()) {
+        // WHERE on a multi-component field: candidates are the subtrees under
+        // the field's parent path. The shorthand form needs the whole tree.
+        FieldPath whereField = extractFieldPathFromWhere(query.where.get());
+        if (whereField.components.size() < 2) {
+            return false;
+        }
+
+        std::vector<std::string> parentPath(
+            whereField.components.begin(),
+            whereField.components.end() - 1
+        );
+
+        SubtreePattern pattern;
+        pattern.components = parentPath;
+        streamed = StreamScanner::captureSubtrees(filepath, pattern,
+            [&](const pugi::xml_document& fragment, size_t) {
+                collectWhereRows(fragment, query, predicates, parentPath, filename, results, nullptr, rowLimit);
+                return results.size() < rowLimit;
+            });
+    } else {
+        // FOR: the first clause selects the streamed subtrees, every later
+        // clause must iterate inside an earlier variable. Aggregates and
+        // root-level bindings stay on the DOM path.
+        const ForClause& first = query.for_clauses[0];
+        const auto& components = first.path.components;
+        if (query.has_aggregates || components.empty() ||
+            (components.size() == 1 && !first.path.is_partial_path)) {
+            return false;
+        }
+
+        for (size_t i = 1; i < query.for_clauses.size(); ++i) {
+            const auto& path = query.for_clauses[i].path.components;
+            bool boundEarlier = false;
+            for (size_t j = 0; j < i && !path.empty(); ++j) {
+                if (query.for_clauses[j].variable == path[0]) {
+                    boundEarlier = true;
+                    break;
+                }
+            }
+            if (!boundEarlier) {
+                return false;
+            }
+        }
+
+        SubtreePattern pattern;
+        pattern.components = components;
+        pattern.anchored = !first.path.is_partial_path;
+        streamed = StreamScanner::captureSubtrees(filepath, pattern,
+            [&](const pugi::xml_document& fragment, size_t matchesBefore) {
+                std::map<std::string, pugi::xml_node> varContext;
+                std::map<std::string, size_t> positionContext;
+                processNestedForClauses(fragment.document_element(), query, predicates, varContext, positionContext,
+                                        0, filename, results, nullptr, matchesBefore, rowLimit);
+                return results.size() < rowLimit;
+            });
+    }
+
+    if (!streamed) {
+        // Reader gave up part way (malformed or unsupported input): the DOM
+        // path redoes the file and reports the definitive error
+        results.clear();
+    }
+    return streamed;
+}
+
+std::vector<ResultRow> QueryExecutor::processFile(
+    const XmlFileInfo& file,
+    const Query& query,
+    const QueryPredicates& predicates,
+    DocumentCache* cache,
+    size_t rowLimit
+) {
+    const std::string& filepath = file.path;
+
+    // Get filename for FILE_NAME field
+    std::string filename = std::filesystem::path(filepath).filename().string();
+
+    // Large files are streamed when the query allows it, unless the session
+    // cache already holds the document. Streamed files are not cached.
+    bool large = file.size >= StreamScanner::minimumFileSize();
+    if (large) {
+        std::vector<ResultRow> results;
+        if (!(cache && cache->contains(filepath)) &&
+            processFileStreaming(filepath, filename, query, predicates, results, rowLimit)) {
+            return results;
+        }
+    }
+
+    if (cache) {
+        auto doc = cache->load(filepath);
+        return processDocument(**doc, filepath, filename, query, predicates, &doc->index(), rowLimit);
+    }
+
+    // Load the XML document
+    auto doc = XmlLoader::load(filepath);
+
+    return processDocument(*doc, filepath, filename, query, predicates, &doc.index(), rowLimit);
+}
+
+void QueryExecutor::extractFieldValues(
+    const pugi::xml_document& doc,
+    const std::string& filename,
+    const Query& query,
+    const ElementIndex* index,
+    std::vector<std::vector<XmlResult>>& fieldResults,
+    size_t rowLimit
+) {
+    size_t lookups = 0;
+    for (const auto& field : query.select_fields) {
+        if (!field.include_filename && (field.is_attribute || !field.components.empty())) {
+            ++lookups;
+        }
+    }
+
+    if (lookups > 1 || (lookups == 1 && rowLimit != NO_ROW_LIMIT)) {
+        // Several columns: fill them all in one walk. So does a LIMIT, whose
+        // walk stops after the first rows instead of probing every match.
+        XmlNavigator::extractValues(doc, filename, query.select_fields, fieldResults, rowLimit);
+    } else {
+        // A single column is cheaper as an index probe
+        for (const auto& field : query.select_fields) {
+            fieldResults.push_back(XmlNavigator::extractValues(doc, filename, field, index));
+        }
+    }
 }
 
-// Evaluate WHERE expression with variable context
-bool QueryExecutor::evaluateWhereWithContext(
-    const std::map<std::string, pugi::xml_node>& varContext,
-    const std::map<std::string, size_t>& positionContext,
-    const WhereExpr* expr,
-    const Query& query
+void QueryExecutor::processFileValues(
+    const XmlFileInfo& file,
+    const Query& query,
+    DocumentCache* cache,
+    std::vector<std::vector<XmlResult>>& fieldResults
 ) {
-    if (!expr) return true;
+    const std::string& filepath = file.path;
+    std::string filename = std::filesystem::path(filepath).filename().string();
 
-    if (const auto* condition = dynamic_cast<const WhereCondition*>(expr)) {
-        // Check if this is a position variable in WHERE clause
-        if (condition->field.is_variable_ref && !condition->field.variable_name.empty() &&
-            query.isPositionVariable(condition->field.variable_name)) {
-            // Evaluate condition on position value
-            auto posIt = positionContext.find(condition->field.variable_name);
-            if (posIt != positionContext.end()) {
-                size_t posValue = posIt->second;
-                std::string posStr = std::to_string(posValue);
-
-                // Evaluate the comparison
-                if (condition->op == ComparisonOp::EQUALS) {
-                    return posStr == condition->value;
-                } else if (condition->op == ComparisonOp::NOT_EQUALS) {
-                    return posStr != condition->value;
-                } else if (condition->op == ComparisonOp::LESS_THAN) {
-                    try {
-                        return posValue < std::stoull(condition->value);
-                    } catch (...) { return false; }
-                } else if (condition->op == ComparisonOp::GREATER_THAN) {
-                    try {
-                        return posValue > std::stoull(condition->value);
-                    } catch (...) { return false; }
-                } else if (condition->op == ComparisonOp::LESS_EQUAL) {
-                    try {
-                        return posValue <= std::stoull(condition->value);
-                    } catch (...) { return false; }
-                } else if (condition->op == ComparisonOp::GREATER_EQUAL) {
-                    try {
-                        return posValue >= std::stoull(condition->value);
-                    } catch (...) { return false; }
-                }
-            }
-            return false;
+    // Same choice between streaming, the cache and a fresh load as processFile
+    if (file.size >= StreamScanner::minimumFileSize() && !(cache && cache->contains(filepath))) {
+        std::vector<std::vector<XmlResult>> streamed;
+        if (StreamScanner::extractValues(filepath, filename, query.select_fields, streamed)) {
+            fieldResults = std::move(streamed);
+            return;
         }
+    }
 
-        // Resolve field in condition
-        if (condition->field.is_variable_ref && !condition->field.variable_name.empty()) {
-            // Use variable context
-            auto varIt = varContext.find(condition->field.variable_name);
-            if (varIt != varContext.end()) {
-                pugi::xml_node contextNode = varIt->second;
-
-                // Evaluate condition on this node
-                // Need to adjust the field path to be relative to the bound node
-                WhereCondition adjustedCondition = *condition;
-
-                // Remove variable name from components
-                if (adjustedCondition.field.components.size() > 1) {
-                    adjustedCondition.field.components.erase(adjustedCondition.field.components.begin());
-                } else {
-                    // Condition is on the variable node itself
-                    adjustedCondition.field.components.clear();
-                }
-
-                return XmlNavigator::evaluateCondition(contextNode, adjustedCondition, 0);
-            }
-            return false; // Variable not found
-        } else {
-            // No variable reference - this shouldn't happen with FOR clauses but handle it
-            // Use the last bound variable's context if available
-            if (!varContext.empty()) {
-                return XmlNavigator::evaluateCondition(varContext.rbegin()->second, *condition, 0);
-            }
-            return false;
-        }
-    } else if (const auto* logical = dynamic_cast<const WhereLogical*>(expr)) {
-        bool leftResult = evaluateWhereWithContext(varContext, positionContext, logical->left.get(), query);
-        bool rightResult = evaluateWhereWithContext(varContext, positionContext, logical->right.get(), query);
-
-        if (logical->op == LogicalOp::AND) {
-            return leftResult && rightResult;
-        } else if (logical->op == LogicalOp::OR) {
-            return leftResult || rightResult;
-        }
+    if (cache) {
+        auto doc = cache->load(filepath);
+        extractFieldValues(**doc, filename, query, &doc->index(), fieldResults);
+        return;
     }
 
-    return true;
+    auto doc = XmlLoader::load(filepath);
+    extractFieldValues(*doc, filename, query, &doc.index(), fieldResults);
 }
 
-std::vector<ResultRow> QueryExecutor::processFile(
+std::vector<ResultRow> QueryExecutor::processDocument(
+    const pugi::xml_document& doc,
     const std::string& filepath,
-    const Query& query
+    const std::string& filename,
+    const Query& query,
+    const QueryPredicates& predicates,
+    const ElementIndex* index,
+    size_t rowLimit
 ) {
     std::vector<ResultRow> results;
 
-    // Load the XML document
-    auto doc = XmlLoader::load(filepath);
-
-    // Get filename for FILE_NAME field
-    std::string filename = std::filesystem::path(filepath).filename().string();
-
     // Check if query has FOR clauses
     if (!query.for_clauses.empty()) {
         // Process query with FOR clause context binding
-        results = processFileWithForClauses(filepath, query, *doc, filename);
+        results = processFileWithForClauses(filepath, query, predicates, doc, filename, index, rowLimit);
         return results;
     }
 
     // If there's no WHERE clause, extract all values
     if (!query.where) {
-        // For each select field, extract all matching values
         std::vector<std::vector<XmlResult>> fieldResults;
-
-        for (const auto& field : query.select_fields) {
-            auto values = XmlNavigator::extractValues(*doc, filename, field);
-            fieldResults.push_back(values);
-        }
-
-        // Combine results
-        // For MVP, we'll take the cross product of all field values
-        if (fieldResults.empty()) {
-            return results;
-        }
-
-        // Find the maximum number of results
-        size_t maxResults = 0;
-        for (const auto& fr : fieldResults) {
-            maxResults = std::max(maxResults, fr.size());
-        }
-
-        // Create result rows
-        for (size_t i = 0; i < maxResults; ++i) {
-            ResultRow row;
-            for (size_t fieldIdx = 0; fieldIdx < query.select_fields.size(); ++fieldIdx) {
-                const auto& field = query.select_fields[fieldIdx];
-                const auto& fr = fieldResults[fieldIdx];
-
-                std::string fieldName;
-                std::string fieldValue;
-
-                if (field.include_filename) {
-                    fieldName = "FILE_NAME";
-                } else if (field.is_attribute) {
-                    fieldName = "@" + field.attribute_name;
-                } else if (!field.components.empty()) {
-                    fieldName = field.components.back();
-                } else {
-                    fieldName = "unknown";
-                }
-
-                if (i < fr.size()) {
-                    fieldValue = fr[i].value;
-                } else {
-                    fieldValue = "";
-                }
-
-                row.push_back({fieldName, fieldValue});
-            }
-            results.push_back(row);
-        }
+        extractFieldValues(doc, filename, query, index, fieldResults, rowLimit);
+        return zipFieldValues(query, fieldResults, rowLimit);
     } else {
         // Process with WHERE clause
         // We need to find nodes that match the WHERE condition
@@ -1449,7 +1382,7 @@ std::vector<ResultRow> QueryExecutor::processFile(
 
             std::function<void(const pugi::xml_node&)> searchTree =
                 [&](const pugi::xml_node& node) {
-                    if (!node) return;
+                    if (!node || results.size() >= rowLimit) return;
 
                     // For IS NULL/IS NOT NULL, check all nodes
                     // For other operators, only check nodes that have the attribute
@@ -1458,7 +1391,7 @@ std::vector<ResultRow> QueryExecutor::processFile(
                     if (isNullCheck) {
                         // For IS NULL/IS NOT NULL, evaluate on nodes that have at least one SELECT field
                         // This ensures we're checking the right "level" of nodes
-                        if (node.type() == pugi::node_element && node != *doc) {
+                        if (node.type() == pugi::node_element && node != doc) {
                             // Check if this node has at least one of the SELECT fields as a child or attribute
                             for (const auto& selectField : query.select_fields) {
                                 if (!selectField.include_filename) {
@@ -1467,7 +1400,7 @@ std::vector<ResultRow> QueryExecutor::processFile(
                                         shouldEvaluate = true;
                                         break;
                                     } else if (selectField.components.size() == 1) {
-                                        pugi::xml_node foundNode = XmlNavigator::findFirstElementByName(node, selectField.components[0]);
+                                        pugi::xml_node foundNode = XmlNavigator::findFirstElementByName(node, selectField.components[0], index);
                                         if (foundNode && foundNode.parent() == node) {
                                             shouldEvaluate = true;
                                             break;
@@ -1481,17 +1414,17 @@ std::vector<ResultRow> QueryExecutor::processFile(
                         if (whereField.is_attribute) {
                             // For attributes, check if this node is an element node
                             // The actual attribute value will be checked in evaluateWhereExpr
-                            shouldEvaluate = (node.type() == pugi::node_element && node != *doc);
+                            shouldEvaluate = (node.type() == pugi::node_element && node != doc);
                         } else if (!whereField.components.empty()) {
                             // Check if this node has the WHERE field as a direct child
-                            pugi::xml_node whereAttrNode = XmlNavigator::findFirstElementByName(node, whereField.components[0]);
+                            pugi::xml_node whereAttrNode = XmlNavigator::findFirstElementByName(node, whereField.components[0], index);
                             shouldEvaluate = (whereAttrNode && whereAttrNode.parent() == node);
                         }
                     }
 
                     if (shouldEvaluate) {
                         // Evaluate WHERE condition on this node
-                        if (XmlNavigator::evaluateWhereExpr(node, query.where.get(), 0)) {
+                        if (XmlNavigator::evaluateWhere(node, predicates.where, 0, index)) {
                             ResultRow row;
 
                             for (const auto& field : query.select_fields) {
@@ -1513,14 +1446,14 @@ std::vector<ResultRow> QueryExecutor::processFile(
 
                                     // Use shorthand search from this node
                                     if (field.components.size() == 1) {
-                                        pugi::xml_node foundNode = XmlNavigator::findFirstElementByName(node, field.components[0]);
+                                        pugi::xml_node foundNode = XmlNavigator::findFirstElementByName(node, field.components[0], index);
                                         if (foundNode) {
                                             value = foundNode.child_value();
                                         }
                                     } else {
                                         // Use partial path matching from this node
                                         std::vector<pugi::xml_node> fieldNodes;
-                                        XmlNavigator::findNodesByPartialPath(node, field.components, fieldNodes);
+                                        XmlNavigator::findNodesByPartialPath(node, field.components, fieldNodes, index);
 
                                         if (!fieldNodes.empty()) {
                                             value = fieldNodes[0].child_value();
@@ -1544,7 +1477,7 @@ std::vector<ResultRow> QueryExecutor::processFile(
                     }
                 };
 
-            searchTree(*doc);
+            searchTree(doc);
             return results;
         }
 
@@ -1555,61 +1488,7 @@ std::vector<ResultRow> QueryExecutor::processFile(
             whereField.components.end() - 1
         );
 
-        std::vector<pugi::xml_node> candidateNodes;
-        XmlNavigator::findNodesByPartialPath(*doc, parentPath, candidateNodes);
-
-        // Filter nodes based on WHERE expression
-        // Pass parentPath.size() so evaluation uses relative path navigation
-        for (const auto& node : candidateNodes) {
-            if (XmlNavigator::evaluateWhereExpr(node, query.where.get(), parentPath.size())) {
-                // Extract select fields from this node
-                ResultRow row;
-
-                for (const auto& field : query.select_fields) {
-                    std::string fieldName;
-                    std::string value;
-
-                    if (field.include_filename) {
-                        fieldName = "FILE_NAME";
-                        value = filename;
-                    } else if (field.is_attribute) {
-                        fieldName = "@" + field.attribute_name;
-                        // Extract attribute from current node
-                        pugi::xml_attribute attr = node.attribute(field.attribute_name.c_str());
-                        if (attr) {
-                            value = attr.value();
-                        }
-                    } else if (!field.components.empty()) {
-                        fieldName = field.components.back();
-
-                        // Shorthand: use first element search
-                        if (field.components.size() == 1) {
-                            pugi::xml_node foundNode = XmlNavigator::findFirstElementByName(node, field.components[0]);
-                            if (foundNode) {
-                                value = foundNode.child_value();
-                            }
-                        } else {
-                            // Use partial path matching relative to current node
-                            // First, try to find the field using partial path from this node
-                            std::vector<pugi::xml_node> fieldNodes;
-                            XmlNavigator::findNodesByPartialPath(node, field.components, fieldNodes);
-
-                            if (!fieldNodes.empty()) {
-                                // Use the first match
-                                value = fieldNodes[0].child_value();
-                            }
-                        }
-                    } else {
-                        fieldName = "unknown";
-                        value = "";
-                    }
-
-                    row.push_back({fieldName, value});
-                }
-
-                results.push_back(row);
-            }
-        }
+        collectWhereRows(doc, query, predicates, parentPath, filename, results, index, rowLimit);
     }
 
     return results;
@@ -1683,16 +1562,9 @@ std::vector<std::string> QueryExecutor::checkForAmbiguousAttributes(const Query&
 }
 
 size_t QueryExecutor::getOptimalThreadCount() {
-    // Get hardware concurrency (number of logical CPU cores)
-    size_t hwThreads = std::thread::hardware_concurrency();
-
-    // If we can't detect, default to 4 threads
-    if (hwThreads == 0) {
-        hwThreads = 4;
-    }
-
-    // Cap at 16 threads to avoid excessive overhead
-    return std::min(hwThreads, static_cast<size_t>(16));
+    // One worker per logical core (4 if undetectable). Workers are pooled and
+    // files are work-stolen, so large machines no longer need an artificial cap
+    return ThreadPool::defaultThreadCount();
 }
 
 bool QueryExecutor::shouldUseThreading(size_t fileCount) {
@@ -1710,341 +1582,293 @@ bool QueryExecutor::shouldUseThreading(size_t fileCount) {
     return fileCount >= threshold;
 }
 
-std::vector<ResultRow> QueryExecutor::executeMultithreaded(
-    const std::vector<std::string>& xmlFiles,
+ResultBatch QueryExecutor::scanFiles(
+    const std::vector<XmlFileInfo>& xmlFiles,
     const Query& query,
     size_t threadCount,
-    std::atomic<size_t>* completedCounter
-) {
-    std::vector<ResultRow> allResults;
-    std::mutex resultsMutex;
-
-    // Create thread pool
-    std::vector<std::thread> threads;
-    threads.reserve(threadCount);
-
-    // Atomic counter for completed files (local if not provided)
-    std::atomic<size_t> localCompleted{0};
-    std::atomic<size_t>* completed = completedCounter ? completedCounter : &localCompleted;
-
-    // Launch worker threads
-    for (size_t threadId = 0; threadId < threadCount; ++threadId) {
-        threads.emplace_back([&, threadId]() {
-            // Each thread processes every Nth file (strided access for load balancing)
-            for (size_t fileIdx = threadId; fileIdx < xmlFiles.size(); fileIdx += threadCount) {
-                try {
-                    // Process this file
-                    auto fileResults = processFile(xmlFiles[fileIdx], query);
-
-                    // Accumulate results (thread-safe)
-                    {
-                        std::lock_guard<std::mutex> lock(resultsMutex);
-                        allResults.insert(allResults.end(),
-                                        fileResults.begin(),
-                                        fileResults.end());
-                    }
-
-                    // Increment completed counter
-                    (*completed)++;
-
-                } catch (const std::exception& e) {
-                    std::cerr << "Error processing file " << xmlFiles[fileIdx]
-                              << ": " << e.what() << std::endl;
-                    (*completed)++;
-                }
-            }
-        });
-    }
-
-    // Wait for all threads to complete
-    for (auto& thread : threads) {
-        thread.join();
-    }
-
-    return allResults;
-}
-
-std::vector<ResultRow> QueryExecutor::executeWithProgress(
-    const Query& query,
     ProgressCallback progressCallback,
-    ExecutionStats* stats
+    ExecutionStats* stats,
+    ThreadPool* pool,
+    DocumentCache* cache,
+    size_t topK,
+    size_t rowLimit,
+    const AggregatePlan* aggregate
 ) {
-    auto startTime = std::chrono::high_resolution_clock::now();
-
-    // Get all XML files
-    std::vector<std::string> xmlFiles = getXmlFiles(query.from_path);
-
-    if (xmlFiles.empty()) {
-        std::cerr << "Warning: No XML files found in " << query.from_path << std::endl;
-        return std::vector<ResultRow>();
-    }
-
     size_t fileCount = xmlFiles.size();
-    bool useThreading = shouldUseThreading(fileCount);
-    size_t threadCount = useThreading ? getOptimalThreadCount() : 1;
+    std::vector<WorkerStats>* workerStats = stats ? &stats->worker_stats : nullptr;
 
-    // Update stats if provided
-    if (stats) {
-        stats->total_files = fileCount;
-        stats->thread_count = threadCount;
-        stats->used_threading = useThreading;
-    }
+    // WHERE and HAVING are lowered once and shared by every file
+    QueryPredicates predicates(query);
 
-    // Create a modified select_fields list that includes ORDER BY fields (for sorting)
-    std::vector<FieldPath> modifiedSelectFields = query.select_fields;
-    std::vector<std::string> tempOrderByFields;  // Track which fields we added temporarily
+    if (threadCount <= 1) {
+        // Single-threaded execution (for small file counts)
+        ResultBatch allResults;
+        RowOrder order(query.order_by_fields);
+        std::unique_ptr<TopKRows> topRows;
+        if (topK > 0) {
+            topRows = std::make_unique<TopKRows>(order, topK);
+        }
+        std::unique_ptr<HashAggregator> groups;
+        if (aggregate) {
+            groups = std::make_unique<HashAggregator>(*aggregate);
+        }
 
-    if (!query.order_by_fields.empty()) {
-        for (const auto& orderByField : query.order_by_fields) {
-            // Check if this ORDER BY field is already in SELECT clause
-            bool alreadyInSelect = false;
-            for (const auto& selectField : query.select_fields) {
-                std::string selectFieldName;
-                if (selectField.is_attribute) {
-                    selectFieldName = selectField.attribute_name;
-                } else if (!selectField.components.empty()) {
-                    selectFieldName = selectField.components.back();
+        // Files are scanned in order, so DISTINCT never supersedes a kept row
+        DistinctRows distinctRows(allResults);
+        for (size_t i = 0; i < xmlFiles.size(); ++i) {
+            // Once LIMIT is reached the remaining files are not read
+            size_t fileLimit = rowLimit == NO_ROW_LIMIT ? NO_ROW_LIMIT : rowLimit - std::min(rowLimit, allResults.rowCount());
+            if (fileLimit == 0) {
+                if (progressCallback) {
+                    progressCallback(i + 1, fileCount, 1);
                 }
+                continue;
+            }
 
-                if (selectFieldName == orderByField.field_name) {
-                    alreadyInSelect = true;
-                    break;
+            try {
+                if (groups && aggregate->columnwise) {
+                    // Aggregates over plain field values skip building rows
+                    std::vector<std::vector<XmlResult>> fieldValues;
+                    processFileValues(xmlFiles[i], query, cache, fieldValues);
+                    groups->addColumns(fieldValues);
+                } else {
+                    auto fileResults = processFile(xmlFiles[i], query, predicates, cache, fileLimit);
+                    if (groups) {
+                        groups->add(fileResults, i);
+                    } else if (topRows) {
+                        for (size_t r = 0; r < fileResults.size(); ++r) {
+                            topRows->push(std::move(fileResults[r]), i, r);
+                        }
+                    } else if (query.distinct) {
+                        for (const auto& row : fileResults) {
+                            distinctRows.append(row, i);
+                        }
+                    } else {
+                        for (const auto& row : fileResults) {
+                            allResults.append(row);
+                        }
+                    }
                 }
+            } catch (const std::exception& e) {
+                std::cerr << "Error processing file " << xmlFiles[i].path << ": " << e.what() << std::endl;
             }
 
-            // If not in SELECT, add it temporarily
-            if (!alreadyInSelect) {
-                FieldPath tempField;
-                tempField.is_partial_path = true;  // Use partial path (leading dot)
-                tempField.components.push_back(orderByField.field_name);
-                modifiedSelectFields.push_back(tempField);
-                tempOrderByFields.push_back(orderByField.field_name);
+            if (progressCallback) {
+                progressCallback(i + 1, fileCount, 1);
             }
         }
+        if (groups) {
+            return ResultBatch::fromRows(groups->take());
+        }
+        if (topRows) {
+            return topRows->take();
+        }
+        return allResults;
     }
 
-    // Temporarily modify select_fields (we'll use const_cast since we restore it immediately after)
-    auto& mutableQuery = const_cast<Query&>(query);
-    auto originalSelectFields = mutableQuery.select_fields;
-    mutableQuery.select_fields = modifiedSelectFields;
-
-    std::vector<ResultRow> allResults;
-
-    if (useThreading) {
-        // Multi-threaded execution with progress tracking
-        std::atomic<size_t> completed{0};
-
-        // Launch a progress monitoring thread
-        std::atomic<bool> done{false};
-        std::thread progressThread([&]() {
-            while (!done) {
-                if (progressCallback) {
-                    progressCallback(completed.load(), fileCount, threadCount);
-                }
-                std::this_thread::sleep_for(std::chrono::seconds(1));
-            }
-        });
-
-        // Execute query with multi-threading
-        allResults = executeMultithreaded(xmlFiles, query, threadCount, &completed);
-
-        // Stop progress thread
-        done = true;
-        progressThread.join();
+    if (!progressCallback) {
+        return executeMultithreaded(xmlFiles, query, predicates, threadCount, pool, cache, topK, rowLimit, aggregate, nullptr, workerStats);
+    }
 
-        // Final progress update
-        if (progressCallback) {
-            progressCallback(fileCount, fileCount, threadCount);
+    // Multi-threaded execution with progress tracking
+    std::atomic<size_t> completed{0};
+
+    // Launch a progress monitoring thread. It waits on a condition variable
+    // rather than sleeping so that it stops as soon as the scan is done.
+    std::mutex progressMutex;
+    std::condition_variable progressCv;
+    bool done = false;
+    std::thread progressThread([&]() {
+        std::unique_lock<std::mutex> lock(progressMutex);
+        while (!done) {
+            progressCallback(completed.load(), fileCount, threadCount);
+            progressCv.wait_for(lock, std::chrono::seconds(1), [&]() { return done; });
         }
+    });
 
-    } else {
-        // Single-threaded execution (for small file counts)
-        for (size_t i = 0; i < xmlFiles.size(); ++i) {
-            try {
-                auto fileResults = processFile(xmlFiles[i], query);
-                allResults.insert(allResults.end(), fileResults.begin(), fileResults.end());
-
-                if (progressCallback) {
-                    progressCallback(i + 1, fileCount, 1);
-                }
-            } catch (const std::exception& e) {
-                std::cerr << "Error processing file " << xmlFiles[i] << ": " << e.what() << std::endl;
-            }
+    // Execute query with multi-threading
+    ResultBatch allResults;
+    try {
+        allResults = executeMultithreaded(xmlFiles, query, predicates, threadCount, pool, cache, topK, rowLimit, aggregate, &completed, workerStats);
+    } catch (...) {
+        {
+            std::lock_guard<std::mutex> lock(progressMutex);
+            done = true;
         }
+        progressCv.notify_one();
+        progressThread.join();
+        throw;
     }
 
-    // Apply ORDER BY if specified
-    if (!query.order_by_fields.empty()) {
-        const auto& orderByField = query.order_by_fields[0];
-        const std::string& orderField = orderByField.field_name;
-        bool ascending = (orderByField.direction == SortDirection::ASC);
+    // Stop progress thread
+    {
+        std::lock_guard<std::mutex> lock(progressMutex);
+        done = true;
+    }
+    progressCv.notify_one();
+    progressThread.join();
 
-        std::sort(allResults.begin(), allResults.end(),
-            [&orderField, ascending](const ResultRow& a, const ResultRow& b) {
-                std::string aValue, bValue;
+    // Final progress update
+    progressCallback(fileCount, fileCount, threadCount);
 
-                for (const auto& [field, value] : a) {
-                    if (field == orderField) {
-                        aValue = value;
-                        break;
-                    }
-                }
+    return allResults;
+}
 
-                for (const auto& [field, value] : b) {
-                    if (field == orderField) {
-                        bValue = value;
-                        break;
-                    }
-                }
+ResultBatch QueryExecutor::executeMultithreaded(
+    const std::vector<XmlFileInfo>& xmlFiles,
+    const Query& query,
+    const QueryPredicates& predicates,
+    size_t threadCount,
+    ThreadPool* pool,
+    DocumentCache* cache,
+    size_t topK,
+    size_t rowLimit,
+    const AggregatePlan* aggregate,
+    std::atomic<size_t>* completedCounter,
+    std::vector<WorkerStats>* workerStats
+) {
+    using Clock = std::chrono::steady_clock;
 
-                // Try numeric comparison first
-                bool result;
-                try {
-                    double aNum = std::stod(aValue);
-                    double bNum = std::stod(bValue);
-                    result = aNum < bNum;
-                } catch (...) {
-                    result = aValue < bValue;
-                }
+    // Never start more workers than there are files
+    threadCount = std::max<size_t>(1, std::min(threadCount, xmlFiles.size()));
 
-                return ascending ? result : !result;
-            }
-        );
+    // Borrow the session pool; one-off callers get a pool for this query only
+    std::unique_ptr<ThreadPool> localPool;
+    if (!pool) {
+        localPool = std::make_unique<ThreadPool>(threadCount);
+        pool = localPool.get();
     }
-
-    // Restore original select_fields
-    mutableQuery.select_fields = originalSelectFields;
-
-    // Remove temporary ORDER BY fields that were added for sorting
-    if (!tempOrderByFields.empty()) {
-        for (auto& row : allResults) {
-            ResultRow filteredRow;
-            for (const auto& [field, value] : row) {
-                // Keep field only if it's not a temporary ORDER BY field
-                bool isTemp = false;
-                for (const auto& tempField : tempOrderByFields) {
-                    if (field == tempField) {
-                        isTemp = true;
-                        break;
-                    }
-                }
-                if (!isTemp) {
-                    filteredRow.push_back({field, value});
-                }
-            }
-            row = std::move(filteredRow);
-        }
+    threadCount = std::min(threadCount, pool->size());
+
+    // Size-aware work-stealing queues (largest files start first). LIMIT
+    // scans take files in index order instead: the quota below only skips a
+    // file once the files before it hold enough rows, so those go first.
+    std::vector<uintmax_t> fileSizes;
+    fileSizes.reserve(xmlFiles.size());
+    for (const auto& file : xmlFiles) {
+        fileSizes.push_back(file.size);
     }
-
-    // Apply OFFSET if specified (skip first N results)
-    if (query.offset >= 0 && static_cast<size_t>(query.offset) < allResults.size()) {
-        allResults.erase(allResults.begin(), allResults.begin() + query.offset);
-    } else if (query.offset >= 0 && static_cast<size_t>(query.offset) >= allResults.size()) {
-        // Offset is beyond the result set, return empty
-        allResults.clear();
+    FileScheduler scheduler(fileSizes, threadCount,
+                            rowLimit != NO_ROW_LIMIT ? FileScheduler::Order::FILE_ORDER
+                                                     : FileScheduler::Order::LARGEST_FIRST);
+    std::vector<WorkerStats> perWorker(threadCount);
+
+    // Each worker keeps its own batch, its rows tagged by file index, so the
+    // scan never shares a buffer between threads
+    std::vector<WorkerResults> workerResults(threadCount);
+
+    // Top-K scans keep one bounded heap per worker instead
+    RowOrder order(query.order_by_fields);
+    std::vector<TopKRows> workerTopRows;
+    if (topK > 0) {
+        workerTopRows.assign(threadCount, TopKRows(order, topK));
     }
 
-    // Apply LIMIT if specified (after offset)
-    if (query.limit >= 0 && static_cast<size_t>(query.limit) < allResults.size()) {
-        allResults.resize(query.limit);
+    // Aggregate scans fold each file into per-worker partial aggregates
+    std::vector<HashAggregator> workerGroups;
+    if (aggregate) {
+        workerGroups.assign(threadCount, HashAggregator(*aggregate));
     }
 
-    auto endTime = std::chrono::high_resolution_clock::now();
-    std::chrono::duration<double> elapsed = endTime - startTime;
-
-    if (stats) {
-        stats->execution_time_seconds = elapsed.count();
+    // LIMIT scans skip files once the earlier ones hold enough rows
+    std::unique_ptr<RowQuota> quota;
+    if (rowLimit != NO_ROW_LIMIT) {
+        quota = std::make_unique<RowQuota>(xmlFiles.size(), rowLimit);
     }
 
-    return allResults;
-}
+    // Atomic counter for completed files (local if not provided)
+    std::atomic<size_t> localCompleted{0};
+    std::atomic<size_t>* completed = completedCounter ? completedCounter : &localCompleted;
 
-std::string QueryExecutor::computeAggregate(const FieldPath& field, const std::vector<ResultRow>& allResults) {
-    // Build the field name we're looking for
-    std::string targetField;
-    if (field.is_attribute) {
-        targetField = "@" + field.attribute_name;
-    } else if (!field.aggregate_arg.empty()) {
-        // Use aggregate_arg if it was set by parseSelectField()
-        // Extract just the last component (field name)
-        size_t lastDot = field.aggregate_arg.find_last_of('.');
-        if (lastDot != std::string::npos) {
-            targetField = field.aggregate_arg.substr(lastDot + 1);
-        } else {
-            targetField = field.aggregate_arg;
-        }
-    } else if (!field.components.empty()) {
-        targetField = field.components.back();
-    } else {
-        // No field specified - return empty result
-        return "";
-    }
-
-    // Collect all values for this field
-    std::vector<double> numericValues;
-    size_t count = 0;
-
-    for (const auto& row : allResults) {
-        for (const auto& [fieldName, fieldValue] : row) {
-            if (fieldName == targetField && !fieldValue.empty()) {
-                try {
-                    double numValue = std::stod(fieldValue);
-                    numericValues.push_back(numValue);
-                    count++;
-                } catch (...) {
-                    // Not a number, skip for SUM/AVG/MIN/MAX but count for COUNT
-                    if (field.aggregate == AggregateFunc::COUNT) {
-                        count++;
+    auto scanStart = Clock::now();
+
+    // Run one scheduler worker per pool thread
+    pool->run(threadCount, [&](size_t threadId) {
+        WorkerStats& ws = perWorker[threadId];
+        WorkerResults& results = workerResults[threadId];
+        DistinctRows distinctRows(results.rows);  // DISTINCT within this worker's files
+        size_t fileIdx = 0;
+        bool stolen = false;
+
+        while (scheduler.next(threadId, fileIdx, stolen)) {
+            size_t fileLimit = quota ? quota->remaining(fileIdx) : NO_ROW_LIMIT;
+            if (fileLimit == 0) {
+                (*completed)++;
+                continue;
+            }
+
+            auto fileStart = Clock::now();
+            try {
+                if (aggregate && aggregate->columnwise) {
+                    // Aggregates over plain field values skip building rows
+                    std::vector<std::vector<XmlResult>> fieldValues;
+                    processFileValues(xmlFiles[fileIdx], query, cache, fieldValues);
+                    workerGroups[threadId].addColumns(fieldValues);
+                } else {
+                    auto rows = processFile(xmlFiles[fileIdx], query, predicates, cache, fileLimit);
+                    if (quota) {
+                        quota->record(fileIdx, rows.size());
+                    }
+                    if (aggregate) {
+                        workerGroups[threadId].add(rows, fileIdx);
+                    } else if (topK > 0) {
+                        for (size_t r = 0; r < rows.size(); ++r) {
+                            workerTopRows[threadId].push(std::move(rows[r]), fileIdx, r);
+                        }
+                    } else if (!rows.empty()) {
+                        size_t begin = results.rows.rowCount();
+                        for (const auto& row : rows) {
+                            if (query.distinct) {
+                                distinctRows.append(row, fileIdx);
+                            } else {
+                                results.rows.append(row);
+                            }
+                        }
+                        results.chunks.push_back({fileIdx, begin, results.rows.rowCount()});
                     }
                 }
-                break; // Found the field in this row
+            } catch (const std::exception& e) {
+                std::cerr << "Error processing file " << xmlFiles[fileIdx].path
+                          << ": " << e.what() << std::endl;
             }
-        }
-    }
-
-    switch (field.aggregate) {
-        case AggregateFunc::COUNT:
-            return std::to_string(count);
-
-        case AggregateFunc::SUM: {
-            if (numericValues.empty()) return "0";
-            double sum = 0;
-            for (double v : numericValues) {
-                sum += v;
+            ws.busy_seconds += std::chrono::duration<double>(Clock::now() - fileStart).count();
+            ws.files_processed++;
+            ws.bytes_processed += xmlFiles[fileIdx].size;
+            if (stolen) {
+                ws.files_stolen++;
             }
-            return std::to_string(sum);
-        }
 
-        case AggregateFunc::AVG: {
-            if (numericValues.empty()) return "0";
-            double sum = 0;
-            for (double v : numericValues) {
-                sum += v;
-            }
-            return std::to_string(sum / numericValues.size());
+            // Increment completed counter
+            (*completed)++;
         }
+        results.dropped = distinctRows.dropped();
+    });
 
-        case AggregateFunc::MIN: {
-            if (numericValues.empty()) return "";
-            double minVal = numericValues[0];
-            for (double v : numericValues) {
-                if (v < minVal) minVal = v;
-            }
-            return std::to_string(minVal);
-        }
+    // Idle time covers waiting for stragglers as well as scheduling overhead
+    double scanSeconds = std::chrono::duration<double>(Clock::now() - scanStart).count();
+    for (auto& ws : perWorker) {
+        ws.idle_seconds = std::max(0.0, scanSeconds - ws.busy_seconds);
+    }
+    if (workerStats) {
+        *workerStats = std::move(perWorker);
+    }
 
-        case AggregateFunc::MAX: {
-            if (numericValues.empty()) return "";
-            double maxVal = numericValues[0];
-            for (double v : numericValues) {
-                if (v > maxVal) maxVal = v;
-            }
-            return std::to_string(maxVal);
+    if (aggregate) {
+        for (size_t t = 1; t < workerGroups.size(); ++t) {
+            workerGroups[0].merge(workerGroups[t]);
         }
+        return ResultBatch::fromRows(workerGroups[0].take());
+    }
 
-        default:
-            return "";
+    if (topK > 0) {
+        for (size_t t = 1; t < workerTopRows.size(); ++t) {
+            workerTopRows[0].merge(workerTopRows[t]);
+        }
+        return workerTopRows[0].take();
     }
+
+    // Concatenate in file order (same order as the single-threaded scan)
+    return mergeResultChunks(workerResults, xmlFiles.size(), query.distinct);
 }
 
 } // namespace ariane_xml
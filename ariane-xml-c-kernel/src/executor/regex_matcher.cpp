@@ -0,0 +1,812 @@
+#include "executor/regex_matcher.h"
+#include <algorithm>
+#include <bitset>
+#include <climits>
+#include <cstring>
+#include <map>
+
+namespace ariane_xml {
+
+namespace {
+
+constexpr size_t UNBOUNDED = SIZE_MAX;
+constexpr size_t MAX_REPEAT = 1000;        // Larger counted repeats stay on std::regex
+constexpr size_t MAX_NFA_STATES = 20000;
+constexpr size_t MAX_DFA_STATES = 4096;
+constexpr size_t MAX_EXACT_LITERAL = 256;
+
+constexpr uint8_t MATCHED = 1;             // A match ends at or before this position
+constexpr uint8_t MATCHED_AT_END = 2;      // A match ends here if the text ends here
+
+using ByteSet = std::bitset<256>;
+
+struct RegexNode {
+    enum Kind { EMPTY, SET, CONCAT, ALTERNATE, REPEAT, LINE_START, LINE_END };
+
+    Kind kind = EMPTY;
+    ByteSet set;
+    std::vector<std::unique_ptr<RegexNode>> children;
+    size_t min = 0;
+    size_t max = 0;
+};
+
+using NodePtr = std::unique_ptr<RegexNode>;
+
+NodePtr makeNode(RegexNode::Kind kind) {
+    auto node = std::make_unique<RegexNode>();
+    node->kind = kind;
+    return node;
+}
+
+NodePtr makeSet(const ByteSet& set) {
+    auto node = makeNode(RegexNode::SET);
+    node->set = set;
+    return node;
+}
+
+ByteSet rangeSet(unsigned char first, unsigned char last) {
+    ByteSet set;
+    for (unsigned c = first; c <= last; ++c) {
+        set.set(c);
+    }
+    return set;
+}
+
+// Character classes as std::regex sees them in the "C" locale
+ByteSet classSet(char name) {
+    ByteSet set;
+    switch (name) {
+        case 'd':
+            set = rangeSet('0', '9');
+            break;
+        case 'w':
+            set = rangeSet('0', '9') | rangeSet('a', 'z') | rangeSet('A', 'Z');
+            set.set('_');
+            break;
+        case 's':
+            for (char c : {' ', '\t', '\n', '\v', '\f', '\r'}) {
+                set.set(static_cast<unsigned char>(c));
+            }
+            break;
+    }
+    return set;
+}
+
+int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+bool isAsciiAlnum(char c) {
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+// Recursive descent over the part of ECMAScript syntax the DFA handles.
+// Anything else (or anything std::regex might read differently) fails, and
+// the pattern is left to std::regex.
+class PatternParser {
+public:
+    explicit PatternParser(const std::string& pattern) : pattern_(pattern) {}
+
+    NodePtr parse() {
+        NodePtr root = alternation();
+        if (failed_ || pos_ != pattern_.size()) {
+            return nullptr;
+        }
+        return root;
+    }
+
+private:
+    bool atEnd() const { return pos_ >= pattern_.size(); }
+    char peek(size_t ahead = 0) const {
+        return pos_ + ahead < pattern_.size() ? pattern_[pos_ + ahead] : '\0';
+    }
+
+    NodePtr fail() {
+        failed_ = true;
+        return nullptr;
+    }
+
+    NodePtr alternation() {
+        NodePtr first = sequence();
+        if (failed_ || peek() != '|') {
+            return first;
+        }
+        NodePtr alt = makeNode(RegexNode::ALTERNATE);
+        alt->children.push_back(std::move(first));
+        while (!failed_ && peek() == '|') {
+            ++pos_;
+            alt->children.push_back(sequence());
+        }
+        return failed_ ? nullptr : std::move(alt);
+    }
+
+    NodePtr sequence() {
+        NodePtr seq = makeNode(RegexNode::CONCAT);
+        while (!failed_ && !atEnd() && peek() != '|' && peek() != ')') {
+            NodePtr item = atom();
+            if (failed_) {
+                return nullptr;
+            }
+            item = quantified(std::move(item));
+            if (failed_) {
+                return nullptr;
+            }
+            seq->children.push_back(std::move(item));
+        }
+        return seq;
+    }
+
+    NodePtr atom() {
+        char c = pattern_[pos_++];
+        switch (c) {
+            case '(': {
+                if (peek() == '?') {
+                    if (peek(1) != ':') {
+                        return fail();  // Lookahead
+                    }
+                    pos_ += 2;
+                }
+                NodePtr inner = alternation();
+                if (failed_ || peek() != ')') {
+                    return fail();
+                }
+                ++pos_;
+                return inner;
+            }
+            case '[':
+                return bracket();
+            case '.': {
+                ByteSet set;
+                set.set();
+                set.reset('\n');
+                set.reset('\r');
+                return makeSet(set);
+            }
+            case '^':
+                return makeNode(RegexNode::LINE_START);
+            case '$':
+                return makeNode(RegexNode::LINE_END);
+            case '\\':
+                return escape();
+            case '*': case '+': case '?': case '{': case '}': case ']':
+                return fail();
+            default: {
+                ByteSet set;
+                set.set(static_cast<unsigned char>(c));
+                return makeSet(set);
+            }
+        }
+    }
+
+    NodePtr escape() {
+        if (atEnd()) {
+            return fail();
+        }
+        char c = pattern_[pos_++];
+        switch (c) {
+            case 'd': case 'w': case 's':
+                return makeSet(classSet(c));
+            case 'D': case 'W': case 'S':
+                return makeSet(~classSet(static_cast<char>(c - 'A' + 'a')));
+            default: {
+                int byte = escapedByte(c);
+                if (byte < 0) {
+                    return fail();
+                }
+                ByteSet set;
+                set.set(static_cast<unsigned char>(byte));
+                return makeSet(set);
+            }
+        }
+    }
+
+    // Byte for a single-character escape (after the backslash), or -1
+    int escapedByte(char c) {
+        switch (c) {
+            case 't': return '\t';
+            case 'n': return '\n';
+            case 'r': return '\r';
+            case 'f': return '\f';
+            case 'v': return '\v';
+            case 'x': {
+                int high = hexValue(peek());
+                int low = hexValue(peek(1));
+                if (high < 0 || low < 0) {
+                    return -1;
+                }
+                pos_ += 2;
+                return high * 16 + low;
+            }
+            default:
+                // Identity escapes of punctuation; letters and digits are
+                // classes, references or boundaries we don't handle
+                if (isAsciiAlnum(c) || static_cast<unsigned char>(c) >= 0x80) {
+                    return -1;
+                }
+                return static_cast<unsigned char>(c);
+        }
+    }
+
+    NodePtr bracket() {
+        bool negate = false;
+        if (peek() == '^') {
+            negate = true;
+            ++pos_;
+        }
+        if (peek() == ']') {
+            return fail();  // Empty class, dialect-dependent
+        }
+
+        ByteSet set;
+        while (!atEnd() && peek() != ']') {
+            int first = bracketItem(set);
+            if (failed_) {
+                return nullptr;
+            }
+            bool range = peek() == '-' && pos_ + 1 < pattern_.size() && peek(1) != ']';
+            if (range && first < 0) {
+                return fail();  // Class escape as a range bound
+            }
+            if (range) {
+                ++pos_;
+                int last = bracketItem(set);
+                if (failed_ || last < 0) {
+                    return fail();
+                }
+                // libstdc++ compares (signed) chars: stick to ASCII ranges
+                if (first >= 0x80 || last >= 0x80 || first > last) {
+                    return fail();
+                }
+                set |= rangeSet(static_cast<unsigned char>(first), static_cast<unsigned char>(last));
+                if (peek() == '-' && peek(1) != ']') {
+                    return fail();  // Range followed by '-'
+                }
+            } else if (first >= 0) {
+                set.set(static_cast<unsigned char>(first));
+            }
+        }
+        if (atEnd()) {
+            return fail();
+        }
+        ++pos_;  // ']'
+
+        return makeSet(negate ? ~set : set);
+    }
+
+    // One bracket member: returns its byte, or -1 after adding a class
+    // escape (\d, \w, ...) to 'set'
+    int bracketItem(ByteSet& set) {
+        char c = pattern_[pos_++];
+        if (c == '[' && (peek() == ':' || peek() == '.' || peek() == '=')) {
+            fail();  // POSIX classes
+            return -1;
+        }
+        if (c != '\\') {
+            return static_cast<unsigned char>(c);
+        }
+        if (atEnd()) {
+            fail();
+            return -1;
+        }
+        c = pattern_[pos_++];
+        switch (c) {
+            case 'd': case 'w': case 's':
+                set |= classSet(c);
+                return -1;
+            case 'D': case 'W': case 'S':
+                set |= ~classSet(static_cast<char>(c - 'A' + 'a'));
+                return -1;
+            default: {
+                int byte = escapedByte(c);
+                if (byte < 0) {
+                    fail();
+                }
+                return byte;
+            }
+        }
+    }
+
+    NodePtr quantified(NodePtr item) {
+        if (atEnd()) {
+            return item;
+        }
+
+        size_t min = 0;
+        size_t max = 0;
+        switch (peek()) {
+            case '*': min = 0; max = UNBOUNDED; ++pos_; break;
+            case '+': min = 1; max = UNBOUNDED; ++pos_; break;
+            case '?': min = 0; max = 1; ++pos_; break;
+            case '{':
+                if (!counted(min, max)) {
+                    return fail();
+                }
+                break;
+            default:
+                return item;
+        }
+
+        if (item->kind == RegexNode::LINE_START || item->kind == RegexNode::LINE_END) {
+            return fail();
+        }
+        if (peek() == '?') {
+            ++pos_;  // Lazy: same set of matches
+        }
+        if (peek() == '*' || peek() == '+' || peek() == '?' || peek() == '{') {
+            return fail();
+        }
+
+        NodePtr repeat = makeNode(RegexNode::REPEAT);
+        repeat->min = min;
+        repeat->max = max;
+        repeat->children.push_back(std::move(item));
+        return repeat;
+    }
+
+    // {n}, {n,} or {n,m}
+    bool counted(size_t& min, size_t& max) {
+        ++pos_;  // '{'
+        if (!readNumber(min)) {
+            return false;
+        }
+        max = min;
+        if (peek() == ',') {
+            ++pos_;
+            max = UNBOUNDED;
+            if (peek() != '}' && (!readNumber(max) || max < min)) {
+                return false;
+            }
+        }
+        if (peek() != '}') {
+            return false;
+        }
+        ++pos_;
+        return min <= MAX_REPEAT && (max == UNBOUNDED || max <= MAX_REPEAT);
+    }
+
+    bool readNumber(size_t& value) {
+        size_t start = pos_;
+        value = 0;
+        while (peek() >= '0' && peek() <= '9') {
+            value = std::min<size_t>(value * 10 + static_cast<size_t>(peek() - '0'), MAX_REPEAT + 1);
+            ++pos_;
+        }
+        return pos_ > start;
+    }
+
+    const std::string& pattern_;
+    size_t pos_ = 0;
+    bool failed_ = false;
+};
+
+// What every match of a node contains: 'exact' when the node always matches
+// exactly 'text', otherwise the longest literal found in all its matches
+struct LiteralInfo {
+    bool exact = false;
+    std::string text;
+    std::string required;
+};
+
+LiteralInfo literalInfo(const RegexNode& node) {
+    LiteralInfo info;
+    switch (node.kind) {
+        case RegexNode::EMPTY:
+        case RegexNode::LINE_START:
+        case RegexNode::LINE_END:
+            info.exact = true;
+            break;
+        case RegexNode::SET:
+            if (node.set.count() == 1) {
+                info.exact = true;
+                for (unsigned c = 0; c < 256; ++c) {
+                    if (node.set.test(c)) {
+                        info.text = std::string(1, static_cast<char>(c));
+                        break;
+                    }
+                }
+                info.required = info.text;
+            }
+            break;
+        case RegexNode::CONCAT: {
+            std::string run;
+            bool allExact = true;
+            for (const auto& child : node.children) {
+                LiteralInfo part = literalInfo(*child);
+                if (part.exact) {
+                    run += part.text;
+                } else {
+                    allExact = false;
+                    if (run.size() > info.required.size()) info.required = run;
+                    if (part.required.size() > info.required.size()) info.required = part.required;
+                    run.clear();
+                }
+            }
+            if (run.size() > info.required.size()) info.required = run;
+            if (allExact) {
+                info.exact = true;
+                info.text = run;
+            }
+            break;
+        }
+        case RegexNode::ALTERNATE: {
+            LiteralInfo first = literalInfo(*node.children[0]);
+            bool same = first.exact;
+            for (size_t i = 1; same && i < node.children.size(); ++i) {
+                LiteralInfo other = literalInfo(*node.children[i]);
+                same = other.exact && other.text == first.text;
+            }
+            if (same) {
+                info = first;
+            }
+            break;
+        }
+        case RegexNode::REPEAT: {
+            LiteralInfo child = literalInfo(*node.children[0]);
+            if (node.max == 0) {
+                info.exact = true;
+            } else if (node.min > 0) {
+                if (child.exact && node.min == node.max &&
+                    child.text.size() * node.min <= MAX_EXACT_LITERAL) {
+                    info.exact = true;
+                    for (size_t i = 0; i < node.min; ++i) {
+                        info.text += child.text;
+                    }
+                    info.required = info.text;
+                } else {
+                    info.required = child.exact ? child.text : child.required;
+                }
+            }
+            break;
+        }
+    }
+    return info;
+}
+
+bool hasAnchor(const RegexNode& node) {
+    if (node.kind == RegexNode::LINE_START || node.kind == RegexNode::LINE_END) {
+        return true;
+    }
+    for (const auto& child : node.children) {
+        if (hasAnchor(*child)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool isDotStar(const RegexNode& node) {
+    if (node.kind != RegexNode::REPEAT || node.min != 0 || node.max != UNBOUNDED) {
+        return false;
+    }
+    const RegexNode& child = *node.children[0];
+    return child.kind == RegexNode::SET && child.set.count() == 254 &&
+           !child.set.test('\n') && !child.set.test('\r');
+}
+
+// Thompson NFA over bytes
+struct NfaState {
+    enum Kind : uint8_t { BYTE, SPLIT, JUMP, LINE_START, LINE_END, MATCH };
+
+    Kind kind;
+    uint32_t out = 0;
+    uint32_t out2 = 0;
+    uint32_t set = 0;  // BYTE: index into Nfa::sets
+};
+
+struct Nfa {
+    std::vector<NfaState> states;
+    std::vector<ByteSet> sets;
+    bool tooLarge = false;
+
+    uint32_t add(NfaState state) {
+        if (states.size() >= MAX_NFA_STATES) {
+            tooLarge = true;
+        }
+        states.push_back(state);
+        return static_cast<uint32_t>(states.size() - 1);
+    }
+
+    // Entry state of 'node' continuing to 'next'
+    uint32_t compile(const RegexNode& node, uint32_t next) {
+        if (tooLarge) {
+            return next;
+        }
+        switch (node.kind) {
+            case RegexNode::EMPTY:
+                return next;
+            case RegexNode::SET:
+                sets.push_back(node.set);
+                return add({NfaState::BYTE, next, 0, static_cast<uint32_t>(sets.size() - 1)});
+            case RegexNode::LINE_START:
+                return add({NfaState::LINE_START, next});
+            case RegexNode::LINE_END:
+                return add({NfaState::LINE_END, next});
+            case RegexNode::CONCAT:
+                for (auto it = node.children.rbegin(); it != node.children.rend(); ++it) {
+                    next = compile(**it, next);
+                }
+                return next;
+            case RegexNode::ALTERNATE: {
+                uint32_t entry = compile(*node.children.back(), next);
+                for (size_t i = node.children.size() - 1; i-- > 0;) {
+                    uint32_t branch = compile(*node.children[i], next);
+                    entry = add({NfaState::SPLIT, branch, entry});
+                }
+                return entry;
+            }
+            case RegexNode::REPEAT: {
+                const RegexNode& child = *node.children[0];
+                uint32_t entry = next;
+                if (node.max == UNBOUNDED) {
+                    uint32_t loop = add({NfaState::SPLIT, 0, next});
+                    states[loop].out = compile(child, loop);
+                    entry = loop;
+                } else {
+                    for (size_t i = node.min; i < node.max; ++i) {
+                        uint32_t body = compile(child, entry);
+                        entry = add({NfaState::SPLIT, body, entry});
+                    }
+                }
+                for (size_t i = 0; i < node.min; ++i) {
+                    entry = compile(child, entry);
+                }
+                return entry;
+            }
+        }
+        return next;
+    }
+
+    // States reachable from 'from' without consuming a byte. Keeps BYTE and
+    // MATCH states, plus LINE_END states unless 'atEnd' lets them through.
+    void closure(std::vector<uint32_t> from, bool atStart, bool atEnd,
+                 std::vector<uint32_t>& result, std::vector<uint32_t>& seen, uint32_t& mark) const {
+        ++mark;
+        result.clear();
+        while (!from.empty()) {
+            uint32_t id = from.back();
+            from.pop_back();
+            if (seen[id] == mark) {
+                continue;
+            }
+            seen[id] = mark;
+            const NfaState& state = states[id];
+            switch (state.kind) {
+                case NfaState::BYTE:
+                case NfaState::MATCH:
+                    result.push_back(id);
+                    break;
+                case NfaState::SPLIT:
+                    from.push_back(state.out2);
+                    from.push_back(state.out);
+                    break;
+                case NfaState::JUMP:
+                    from.push_back(state.out);
+                    break;
+                case NfaState::LINE_START:
+                    if (atStart) from.push_back(state.out);
+                    break;
+                case NfaState::LINE_END:
+                    if (atEnd) {
+                        from.push_back(state.out);
+                    } else {
+                        result.push_back(id);
+                    }
+                    break;
+            }
+        }
+        std::sort(result.begin(), result.end());
+    }
+};
+
+bool containsLiteral(std::string_view text, const std::string& literal) {
+    if (literal.empty()) {
+        return true;
+    }
+    if (text.size() < literal.size()) {
+        return false;
+    }
+    if (literal.size() == 1) {
+        return std::memchr(text.data(), literal[0], text.size()) != nullptr;
+    }
+    return memmem(text.data(), text.size(), literal.data(), literal.size()) != nullptr;
+}
+
+} // namespace
+
+RegexMatcher::RegexMatcher(const std::string& pattern) {
+    // std::regex decides which patterns are valid; ours only has to agree
+    // on the ones it accepts
+    auto regex = std::make_unique<std::regex>(pattern);
+
+    if (!buildDfa(pattern)) {
+        strategy_ = Strategy::BACKTRACKING;
+        literal_.clear();
+        regex_ = std::move(regex);
+    }
+}
+
+bool RegexMatcher::buildDfa(const std::string& pattern) {
+    NodePtr root = PatternParser(pattern).parse();
+    if (!root) {
+        return false;
+    }
+
+    // Plain literal, possibly anchored or surrounded by '.*'
+    {
+        std::vector<const RegexNode*> items;
+        if (root->kind == RegexNode::CONCAT) {
+            for (const auto& child : root->children) items.push_back(child.get());
+        } else {
+            items.push_back(root.get());
+        }
+
+        size_t begin = 0;
+        size_t end = items.size();
+        bool anchoredStart = begin < end && items[begin]->kind == RegexNode::LINE_START;
+        if (anchoredStart) {
+            ++begin;
+        } else {
+            while (begin < end && isDotStar(*items[begin])) ++begin;
+        }
+        bool anchoredEnd = begin < end && items[end - 1]->kind == RegexNode::LINE_END;
+        if (anchoredEnd) {
+            --end;
+        } else {
+            while (begin < end && isDotStar(*items[end - 1])) --end;
+        }
+
+        std::string literal;
+        bool plain = true;
+        for (size_t i = begin; plain && i < end; ++i) {
+            LiteralInfo info = literalInfo(*items[i]);
+            plain = info.exact && !hasAnchor(*items[i]);
+            literal += info.text;
+        }
+        if (plain) {
+            literal_ = literal;
+            strategy_ = anchoredStart ? (anchoredEnd ? Strategy::EQUALS : Strategy::PREFIX)
+                                      : (anchoredEnd ? Strategy::SUFFIX : Strategy::CONTAINS);
+            return true;
+        }
+    }
+
+    Nfa nfa;
+    uint32_t match = nfa.add({NfaState::MATCH});
+    uint32_t entry = nfa.compile(*root, match);
+    if (nfa.tooLarge) {
+        return false;
+    }
+
+    // Byte classes: bytes that belong to exactly the same sets
+    {
+        std::map<std::vector<bool>, uint8_t> classes;
+        for (unsigned c = 0; c < 256; ++c) {
+            std::vector<bool> signature(nfa.sets.size());
+            for (size_t s = 0; s < nfa.sets.size(); ++s) {
+                signature[s] = nfa.sets[s].test(c);
+            }
+            auto it = classes.emplace(std::move(signature), static_cast<uint8_t>(classes.size())).first;
+            byteClass_[c] = it->second;
+        }
+        classCount_ = classes.size();
+    }
+    std::vector<unsigned> representative(classCount_);
+    for (unsigned c = 256; c-- > 0;) {
+        representative[byteClass_[c]] = c;
+    }
+
+    // Subset construction. A search may start at any position, so the
+    // start closure (past the first position) joins every step.
+    std::vector<uint32_t> seen(nfa.states.size(), 0);
+    uint32_t mark = 0;
+    std::vector<uint32_t> closure;
+
+    std::vector<uint32_t> restart;
+    nfa.closure({entry}, false, false, restart, seen, mark);
+
+    std::map<std::vector<uint32_t>, uint32_t> ids;
+    std::vector<std::vector<uint32_t>> sets;
+    auto intern = [&](std::vector<uint32_t>& key) {
+        auto it = ids.find(key);
+        if (it != ids.end()) {
+            return it->second;
+        }
+        uint32_t id = static_cast<uint32_t>(sets.size());
+        ids.emplace(key, id);
+        sets.push_back(key);
+        return id;
+    };
+
+    nfa.closure({entry}, true, false, closure, seen, mark);
+    start_ = intern(closure);
+
+    // The start state's end acceptance below is computed past the first
+    // position, as for the states it may share a set with; on empty text
+    // the end is also the start, so both anchors hold at once
+    nfa.closure({entry}, true, true, closure, seen, mark);
+    matchesEmpty_ = std::any_of(closure.begin(), closure.end(),
+                                [&](uint32_t s) { return nfa.states[s].kind == NfaState::MATCH; });
+
+    for (uint32_t id = 0; id < sets.size(); ++id) {
+        if (sets.size() > MAX_DFA_STATES) {
+            return false;
+        }
+        const std::vector<uint32_t> current = sets[id];
+
+        uint8_t accept = 0;
+        std::vector<uint32_t> lineEnds;
+        for (uint32_t s : current) {
+            if (nfa.states[s].kind == NfaState::MATCH) accept |= MATCHED;
+            if (nfa.states[s].kind == NfaState::LINE_END) lineEnds.push_back(s);
+        }
+        if (!accept && !lineEnds.empty()) {
+            nfa.closure(lineEnds, false, true, closure, seen, mark);
+            for (uint32_t s : closure) {
+                if (nfa.states[s].kind == NfaState::MATCH) accept |= MATCHED_AT_END;
+            }
+        }
+        accepts_.push_back(accept);
+
+        transitions_.resize((id + 1) * classCount_, id);
+        if (accept & MATCHED) {
+            continue;  // Search stops here
+        }
+        for (size_t cls = 0; cls < classCount_; ++cls) {
+            std::vector<uint32_t> next = restart;
+            for (uint32_t s : current) {
+                const NfaState& state = nfa.states[s];
+                if (state.kind == NfaState::BYTE && nfa.sets[state.set].test(representative[cls])) {
+                    next.push_back(state.out);
+                }
+            }
+            nfa.closure(std::move(next), false, false, closure, seen, mark);
+            transitions_[id * classCount_ + cls] = intern(closure);
+        }
+    }
+
+    literal_ = literalInfo(*root).required;
+    strategy_ = Strategy::DFA;
+    return true;
+}
+
+bool RegexMatcher::runDfa(std::string_view text) const {
+    if (text.empty()) {
+        return matchesEmpty_;
+    }
+    uint32_t state = start_;
+    for (char c : text) {
+        if (accepts_[state] & MATCHED) {
+            return true;
+        }
+        state = transitions_[state * classCount_ + byteClass_[static_cast<unsigned char>(c)]];
+    }
+    return accepts_[state] != 0;
+}
+
+bool RegexMatcher::search(std::string_view text) const {
+    switch (strategy_) {
+        case Strategy::CONTAINS:
+            return containsLiteral(text, literal_);
+        case Strategy::PREFIX:
+            return text.size() >= literal_.size() && text.compare(0, literal_.size(), literal_) == 0;
+        case Strategy::SUFFIX:
+            return text.size() >= literal_.size() &&
+                   text.compare(text.size() - literal_.size(), literal_.size(), literal_) == 0;
+        case Strategy::EQUALS:
+            return text == literal_;
+        case Strategy::DFA:
+            return containsLiteral(text, literal_) && runDfa(text);
+        case Strategy::BACKTRACKING:
+            try {
+                return std::regex_search(text.begin(), text.end(), *regex_);
+            } catch (const std::regex_error&) {
+                return false;  // Match too complex for the regex engine
+            }
+    }
+    return false;
+}
+
+} // namespace ariane_xml
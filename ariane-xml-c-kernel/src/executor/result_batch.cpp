@@ -0,0 +1,221 @@
+#include "executor/result_batch.h"
+#include <functional>
+
+namespace ariane_xml {
+
+namespace {
+
+// Dictionaries smaller than this are kept whatever the row count, so a
+// column isn't judged on its first few rows
+constexpr size_t MIN_DICTIONARY_ENTRIES = 256;
+
+} // namespace
+
+void ResultColumn::append(std::string_view value) {
+    ++rows_;
+    if (!dictionary_) {
+        addEntry(value);
+        return;
+    }
+
+    if (lookup_.empty()) {
+        lookup_.assign(64, 0);
+    }
+    size_t mask = lookup_.size() - 1;
+    size_t i = std::hash<std::string_view>()(value) & mask;
+    for (; lookup_[i] != 0; i = (i + 1) & mask) {
+        if (entry(lookup_[i] - 1) == value) {
+            codes_.push_back(lookup_[i] - 1);
+            return;
+        }
+    }
+
+    addEntry(value);
+    lookup_[i] = static_cast<uint32_t>(ends_.size());
+    codes_.push_back(static_cast<uint32_t>(ends_.size() - 1));
+
+    if (ends_.size() > MIN_DICTIONARY_ENTRIES && ends_.size() * 2 > rows_) {
+        dropDictionary();
+    } else if (ends_.size() * 2 > lookup_.size()) {
+        growLookup();
+    }
+}
+
+void ResultColumn::append(const ResultColumn& other, size_t begin, size_t end, std::vector<uint32_t>& codes) {
+    if (begin >= end) {
+        return;
+    }
+
+    if (!dictionary_ && !other.dictionary_) {
+        // The rows are the entries on both sides
+        uint64_t from = begin == 0 ? 0 : other.ends_[begin - 1];
+        uint64_t base = bytes_.size();
+        bytes_.append(other.bytes_, from, other.ends_[end - 1] - from);
+        for (size_t r = begin; r < end; ++r) {
+            ends_.push_back(base + (other.ends_[r] - from));
+        }
+        rows_ += end - begin;
+        return;
+    }
+
+    if (other.dictionary_ && codes.size() < other.ends_.size()) {
+        codes.resize(other.ends_.size(), UNMAPPED);
+    }
+    for (size_t r = begin; r < end; ++r) {
+        if (!dictionary_ || !other.dictionary_) {
+            append(other.value(r));
+            continue;
+        }
+        uint32_t& code = codes[other.codes_[r]];
+        if (code != UNMAPPED) {
+            codes_.push_back(code);
+            ++rows_;
+            continue;
+        }
+        append(other.entry(other.codes_[r]));
+        if (dictionary_) {
+            code = codes_.back();
+        }
+    }
+}
+
+void ResultColumn::addEntry(std::string_view value) {
+    bytes_.append(value.data(), value.size());
+    ends_.push_back(bytes_.size());
+}
+
+void ResultColumn::growLookup() {
+    std::vector<uint32_t> lookup(lookup_.size() * 2, 0);
+    size_t mask = lookup.size() - 1;
+    for (size_t e = 0; e < ends_.size(); ++e) {
+        size_t i = std::hash<std::string_view>()(entry(e)) & mask;
+        while (lookup[i] != 0) {
+            i = (i + 1) & mask;
+        }
+        lookup[i] = static_cast<uint32_t>(e + 1);
+    }
+    lookup_.swap(lookup);
+}
+
+void ResultColumn::dropDictionary() {
+    std::string bytes;
+    std::vector<uint64_t> ends;
+    ends.reserve(codes_.size());
+    for (uint32_t code : codes_) {
+        std::string_view value = entry(code);
+        bytes.append(value.data(), value.size());
+        ends.push_back(bytes.size());
+    }
+    bytes_.swap(bytes);
+    ends_.swap(ends);
+    std::vector<uint32_t>().swap(codes_);
+    std::vector<uint32_t>().swap(lookup_);
+    dictionary_ = false;
+}
+
+size_t ResultColumn::memoryBytes() const {
+    return bytes_.capacity() + ends_.capacity() * sizeof(uint64_t) +
+           codes_.capacity() * sizeof(uint32_t) + lookup_.capacity() * sizeof(uint32_t);
+}
+
+ResultBatch::ResultBatch(std::vector<std::string> columnNames)
+    : names_(std::move(columnNames)), columns_(names_.size()) {}
+
+ResultBatch ResultBatch::fromRows(const std::vector<ResultRow>& rows) {
+    ResultBatch batch;
+    for (const auto& row : rows) {
+        batch.append(row);
+    }
+    return batch;
+}
+
+size_t ResultBatch::columnIndex(const std::string& name) const {
+    for (size_t c = 0; c < names_.size(); ++c) {
+        if (names_[c] == name) {
+            return c;
+        }
+    }
+    return npos;
+}
+
+ResultRow ResultBatch::row(size_t row) const {
+    ResultRow result;
+    result.reserve(names_.size());
+    for (size_t c = 0; c < names_.size(); ++c) {
+        result.emplace_back(names_[c], std::string(value(row, c)));
+    }
+    return result;
+}
+
+void ResultBatch::append(const ResultRow& row) {
+    if (rows_ == 0 && names_.empty()) {
+        for (const auto& column : row) {
+            names_.push_back(column.first);
+        }
+        columns_.resize(names_.size());
+    }
+    for (size_t c = 0; c < columns_.size(); ++c) {
+        columns_[c].append(c < row.size() ? std::string_view(row[c].second) : std::string_view());
+    }
+    ++rows_;
+}
+
+void ResultBatch::append(const ResultBatch& other, size_t begin, size_t end) {
+    CodeMap codes;
+    append(other, begin, end, codes);
+}
+
+void ResultBatch::append(const ResultBatch& other, size_t begin, size_t end, CodeMap& codes) {
+    if (rows_ == 0 && names_.empty()) {
+        names_ = other.names_;
+        columns_.resize(names_.size());
+    }
+    codes.resize(columns_.size());
+    for (size_t c = 0; c < columns_.size(); ++c) {
+        if (c < other.columns_.size()) {
+            columns_[c].append(other.columns_[c], begin, end, codes[c]);
+        } else {
+            for (size_t r = begin; r < end; ++r) {
+                columns_[c].append(std::string_view());
+            }
+        }
+    }
+    rows_ += end - begin;
+}
+
+ResultBatch ResultBatch::select(const std::vector<size_t>& rows) const {
+    ResultBatch result(names_);
+    for (size_t c = 0; c < columns_.size(); ++c) {
+        for (size_t r : rows) {
+            result.columns_[c].append(value(r, c));
+        }
+    }
+    result.rows_ = rows.size();
+    return result;
+}
+
+ResultBatch ResultBatch::slice(size_t begin, size_t end) const {
+    ResultBatch result(names_);
+    result.append(*this, begin, end);
+    return result;
+}
+
+void ResultBatch::removeColumn(size_t column) {
+    names_.erase(names_.begin() + column);
+    columns_.erase(columns_.begin() + column);
+}
+
+void ResultBatch::clearRows() {
+    columns_.assign(names_.size(), ResultColumn());
+    rows_ = 0;
+}
+
+size_t ResultBatch::memoryBytes() const {
+    size_t bytes = 0;
+    for (const auto& column : columns_) {
+        bytes += sizeof(ResultColumn) + column.memoryBytes();
+    }
+    return bytes;
+}
+
+} // namespace ariane_xml
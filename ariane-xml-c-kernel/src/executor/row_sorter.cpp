@@ -0,0 +1,155 @@
+#include "executor/row_sorter.h"
+#include "executor/compiled_predicate.h"
+#include "utils/thread_pool.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace ariane_xml {
+
+namespace {
+
+// Below this many rows per block, splitting the sort isn't worth a task
+constexpr size_t MIN_BLOCK_ROWS = 8192;
+
+int compareKey(const RowOrder::Key& a, const RowOrder::Key& b) {
+    using Kind = RowOrder::Key::Kind;
+    if (a.kind != b.kind) {
+        return a.kind < b.kind ? -1 : 1;
+    }
+    if (a.kind == Kind::NUMBER) {
+        return a.number < b.number ? -1 : (b.number < a.number ? 1 : 0);
+    }
+    if (a.kind == Kind::TEXT) {
+        int result = a.text.compare(b.text);
+        return result < 0 ? -1 : (result > 0 ? 1 : 0);
+    }
+    return 0;
+}
+
+} // namespace
+
+RowOrder::RowOrder(const std::vector<OrderByField>& fields) {
+    for (const auto& field : fields) {
+        names_.push_back(field.field_name);
+        descending_.push_back(field.direction == SortDirection::DESC);
+    }
+}
+
+void RowOrder::decode(const ResultRow& row, Key* keys) const {
+    for (size_t k = 0; k < names_.size(); ++k) {
+        Key& key = keys[k];
+        key = Key();
+        for (const auto& [field, value] : row) {
+            if (field != names_[k]) {
+                continue;
+            }
+            if (!value.empty()) {
+                key.text = value;
+                key.kind = CompiledPredicate::parseNumber(value, key.number) && !std::isnan(key.number)
+                    ? Key::Kind::NUMBER : Key::Kind::TEXT;
+            }
+            break;
+        }
+    }
+}
+
+std::vector<size_t> RowOrder::columnsIn(const ResultBatch& batch) const {
+    std::vector<size_t> columns;
+    columns.reserve(names_.size());
+    for (const auto& name : names_) {
+        columns.push_back(batch.columnIndex(name));
+    }
+    return columns;
+}
+
+void RowOrder::decode(const ResultBatch& batch, size_t row, const size_t* columns, Key* keys) const {
+    for (size_t k = 0; k < names_.size(); ++k) {
+        Key& key = keys[k];
+        key = Key();
+        if (columns[k] == ResultBatch::npos) {
+            continue;
+        }
+        std::string_view value = batch.value(row, columns[k]);
+        if (!value.empty()) {
+            key.text = value;
+            key.kind = CompiledPredicate::parseNumber(value, key.number) && !std::isnan(key.number)
+                ? Key::Kind::NUMBER : Key::Kind::TEXT;
+        }
+    }
+}
+
+int RowOrder::compare(const Key* a, const Key* b) const {
+    for (size_t k = 0; k < names_.size(); ++k) {
+        int result = compareKey(a[k], b[k]);
+        if (result != 0) {
+            return descending_[k] ? -result : result;
+        }
+    }
+    return 0;
+}
+
+RowSorter::RowSorter(const std::vector<OrderByField>& fields, ThreadPool* pool)
+    : order_(fields), pool_(pool) {}
+
+void RowSorter::sort(ResultBatch& rows) const {
+    if (rows.rowCount() < 2) {
+        return;
+    }
+
+    rows = rows.select(sortedOrder(rows));
+}
+
+std::vector<size_t> RowSorter::sortedOrder(const ResultBatch& rows) const {
+    const size_t count = rows.rowCount();
+    const size_t keyCount = order_.keyCount();
+    const std::vector<size_t> columns = order_.columnsIn(rows);
+    std::vector<RowOrder::Key> keys(count * keyCount);
+    std::vector<size_t> indices(count);
+    std::iota(indices.begin(), indices.end(), 0);
+
+    // Ties go to the earlier row, which makes the order total
+    auto before = [&](size_t a, size_t b) {
+        int result = order_.compare(&keys[a * keyCount], &keys[b * keyCount]);
+        return result != 0 ? result < 0 : a < b;
+    };
+
+    // Decode and sort contiguous blocks in parallel...
+    size_t blocks = 1;
+    if (pool_ && pool_->size() > 1 && count >= 2 * MIN_BLOCK_ROWS) {
+        blocks = std::min(pool_->size(), count / MIN_BLOCK_ROWS);
+    }
+    auto blockStart = [&](size_t block) { return count * block / blocks; };
+
+    auto sortBlock = [&](size_t block) {
+        size_t begin = blockStart(block);
+        size_t end = blockStart(block + 1);
+        for (size_t i = begin; i < end; ++i) {
+            order_.decode(rows, i, columns.data(), &keys[i * keyCount]);
+        }
+        std::sort(indices.begin() + begin, indices.begin() + end, before);
+    };
+    if (blocks == 1) {
+        sortBlock(0);
+        return indices;
+    }
+    pool_->parallelFor(blocks, sortBlock);
+
+    // ...then merge neighbouring blocks pairwise, doubling the width each round
+    std::vector<size_t> merged(count);
+    for (size_t width = 1; width < blocks; width *= 2) {
+        size_t pairs = (blocks + 2 * width - 1) / (2 * width);
+        pool_->parallelFor(pairs, [&](size_t pair) {
+            size_t begin = blockStart(pair * 2 * width);
+            size_t middle = blockStart(std::min(pair * 2 * width + width, blocks));
+            size_t end = blockStart(std::min(pair * 2 * width + 2 * width, blocks));
+            std::merge(indices.begin() + begin, indices.begin() + middle,
+                       indices.begin() + middle, indices.begin() + end,
+                       merged.begin() + begin, before);
+        });
+        indices.swap(merged);
+    }
+    return indices;
+}
+
+} // namespace ariane_xml
@@ -0,0 +1,216 @@
+#include "executor/stream_scanner.h"
+#include "executor/field_collector.h"
+#include "utils/xml_stream_reader.h"
+#include <cstdlib>
+
+namespace ariane_xml {
+
+namespace {
+
+constexpr uintmax_t DEFAULT_STREAM_THRESHOLD = 32ull * 1024 * 1024;
+
+bool pathEndsWith(const std::vector<std::string>& path, const std::vector<std::string>& suffix) {
+    if (path.size() < suffix.size()) {
+        return false;
+    }
+    size_t offset = path.size() - suffix.size();
+    for (size_t i = 0; i < suffix.size(); ++i) {
+        if (path[offset + i] != suffix[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool pathStartsWith(const std::vector<std::string>& path, const std::vector<std::string>& prefix) {
+    if (path.size() < prefix.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < prefix.size(); ++i) {
+        if (path[i] != prefix[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Feeds stream events to a FieldCollector, stopping once it is full
+class ValueCollector : public XmlStreamHandler {
+public:
+    ValueCollector(const std::vector<FieldPath>& fields, size_t limit) : collector_(fields, limit) {}
+
+    bool startElement(const std::string& name,
+                      const std::vector<XmlStreamAttribute>& attributes) override {
+        if (depth_ == 0 && sawRoot_) {
+            return false;  // Several top-level elements: leave it to the DOM path
+        }
+        sawRoot_ = true;
+        ++depth_;
+
+        collector_.startElement(name, [&attributes](const std::string& attributeName) -> const char* {
+            for (const auto& attr : attributes) {
+                if (attr.first == attributeName) {
+                    return attr.second.c_str();
+                }
+            }
+            return nullptr;
+        });
+        return keepReading();
+    }
+
+    bool text(const std::string& value, bool) override {
+        collector_.text(value);
+        return keepReading();
+    }
+
+    bool endElement(const std::string&) override {
+        --depth_;
+        collector_.endElement();
+        return keepReading();
+    }
+
+    void finish(const std::string& filename, std::vector<std::vector<XmlResult>>& values) {
+        collector_.finish(filename, values);
+    }
+
+    // Whether the scan ended because every field had its values
+    bool stopped() const { return collector_.full(); }
+
+private:
+    bool keepReading() const { return !collector_.full(); }
+
+    FieldCollector collector_;
+    size_t depth_ = 0;
+    bool sawRoot_ = false;
+};
+
+// Rebuilds each outermost matching element (plus its ancestor names) as a
+// small document. Only one capture is alive at a time.
+class SubtreeCapturer : public XmlStreamHandler {
+public:
+    SubtreeCapturer(const SubtreePattern& pattern, const SubtreeHandler& handler)
+        : pattern_(pattern), handler_(handler) {}
+
+    bool startElement(const std::string& name,
+                      const std::vector<XmlStreamAttribute>& attributes) override {
+        if (path_.empty() && sawRoot_) {
+            return false;  // Several top-level elements: leave it to the DOM path
+        }
+        sawRoot_ = true;
+        path_.push_back(name);
+
+        size_t before = matches_;
+        bool match = pathEndsWith(path_, pattern_.components) &&
+                     (!pattern_.anchored || pathStartsWith(path_, pattern_.components));
+        if (match) {
+            ++matches_;
+        }
+
+        pugi::xml_node node;
+        if (captureDepth_ > 0) {
+            node = nodes_.back().append_child(name.c_str());
+        } else if (match) {
+            fragment_.reset();
+            pugi::xml_node parent = fragment_;
+            for (size_t i = 0; i + 1 < path_.size(); ++i) {
+                parent = parent.append_child(path_[i].c_str());
+            }
+            node = parent.append_child(name.c_str());
+            captureDepth_ = path_.size();
+            matchesBefore_ = before;
+        } else {
+            return true;
+        }
+
+        for (const auto& attr : attributes) {
+            node.append_attribute(attr.first.c_str()).set_value(attr.second.c_str());
+        }
+        nodes_.push_back(node);
+        return true;
+    }
+
+    bool text(const std::string& value, bool isCData) override {
+        if (captureDepth_ > 0) {
+            nodes_.back().append_child(isCData ? pugi::node_cdata : pugi::node_pcdata).set_value(value.c_str());
+        }
+        return true;
+    }
+
+    bool endElement(const std::string&) override {
+        if (captureDepth_ > 0) {
+            nodes_.pop_back();
+            if (path_.size() == captureDepth_) {
+                captureDepth_ = 0;
+                if (!handler_(fragment_, matchesBefore_)) {
+                    stopped_ = true;
+                    return false;
+                }
+            }
+        }
+        path_.pop_back();
+        return true;
+    }
+
+    // Whether the handler ended the scan
+    bool stopped() const { return stopped_; }
+
+private:
+    const SubtreePattern& pattern_;
+    const SubtreeHandler& handler_;
+
+    std::vector<std::string> path_;
+    bool sawRoot_ = false;
+    size_t matches_ = 0;
+
+    pugi::xml_document fragment_;
+    std::vector<pugi::xml_node> nodes_;  // Open elements inside the capture
+    size_t captureDepth_ = 0;            // Depth of the captured element, 0 when idle
+    size_t matchesBefore_ = 0;
+    bool stopped_ = false;
+};
+
+} // namespace
+
+uintmax_t StreamScanner::minimumFileSize() {
+    static const uintmax_t threshold = [] {
+        const char* env = std::getenv("ARIANE_XML_STREAM_THRESHOLD");
+        if (env && *env) {
+            char* end = nullptr;
+            unsigned long long value = std::strtoull(env, &end, 10);
+            if (end && *end == '\0') {
+                return static_cast<uintmax_t>(value);
+            }
+        }
+        return DEFAULT_STREAM_THRESHOLD;
+    }();
+    return threshold;
+}
+
+bool StreamScanner::extractValues(
+    const std::string& filepath,
+    const std::string& filename,
+    const std::vector<FieldPath>& fields,
+    std::vector<std::vector<XmlResult>>& values,
+    size_t limit
+) {
+    ValueCollector collector(fields, limit);
+    if (!XmlStreamReader::parse(filepath, collector) && !collector.stopped()) {
+        return false;
+    }
+    collector.finish(filename, values);
+    return true;
+}
+
+bool StreamScanner::captureSubtrees(
+    const std::string& filepath,
+    const SubtreePattern& pattern,
+    const SubtreeHandler& handler
+) {
+    if (pattern.components.empty()) {
+        return false;
+    }
+    SubtreeCapturer capturer(pattern, handler);
+    return XmlStreamReader::parse(filepath, capturer) || capturer.stopped();
+}
+
+} // namespace ariane_xml
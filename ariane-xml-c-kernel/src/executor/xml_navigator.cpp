@@ -1,4 +1,7 @@
 #include "executor/xml_navigator.h"
+#include "executor/field_collector.h"
+#include "executor/compiled_predicate.h"
+#include "utils/element_index.h"
 #include "error/error_codes.h"
 #include <stdexcept>
 #include <typeinfo>
@@ -11,7 +14,8 @@ namespace ariane_xml {
 std::vector<XmlResult> XmlNavigator::extractValues(
     const pugi::xml_document& doc,
     const std::string& filename,
-    const FieldPath& field
+    const FieldPath& field,
+    const ElementIndex* index
 ) {
     std::vector<XmlResult> results;
 
@@ -68,6 +72,26 @@ std::vector<XmlResult> XmlNavigator::extractValues(
         } else {
             // Leading dot: partial path - search recursively with ambiguity check
             std::set<std::string> fullPaths;
+
+            std::vector<pugi::xml_node> nodes;
+            if (index && index->findByName(doc, targetName, nodes)) {
+                for (const auto& node : nodes) {
+                    std::string nodePath = node.name();
+                    for (pugi::xml_node n = node.parent(); n.type() == pugi::node_element; n = n.parent()) {
+                        nodePath = std::string(n.name()) + "." + nodePath;
+                    }
+                    fullPaths.insert(nodePath);
+                    std::string value = node.child_value();
+                    if (!value.empty()) {
+                        results.push_back({filename, value});
+                    }
+                }
+                if (fullPaths.size() > 1) {
+                    throw ambiguousPathError(targetName, fullPaths);
+                }
+                return results;
+            }
+
             std::function<void(const pugi::xml_node&, const std::string&)> findAllByName =
                 [&](const pugi::xml_node& node, const std::string& currentPath) {
                     if (!node) return;
@@ -98,13 +122,7 @@ std::vector<XmlResult> XmlNavigator::extractValues(
 
             // Check for ambiguity: if multiple different paths found, error
             if (fullPaths.size() > 1) {
-                std::string pathList;
-                for (const auto& path : fullPaths) {
-                    if (!pathList.empty()) pathList += "\n  - ";
-                    pathList += path;
-                }
-                throw ARX_ERROR(ErrorCategory::XML_STRUCTURE, ErrorCodes::XML_AMBIGUOUS_PARTIAL_PATH,
-                               "Ambiguous path '." + targetName + "': found at multiple locations:\n  - " + pathList + "\nUse full path to disambiguate.");
+                throw ambiguousPathError(targetName, fullPaths);
             }
 
             return results;
@@ -114,7 +132,7 @@ std::vector<XmlResult> XmlNavigator::extractValues(
     // Multi-component path: use partial path matching (suffix matching)
     // This allows ".book.price" to match any path ending with those components
     std::vector<pugi::xml_node> nodes;
-    findNodesByPartialPath(doc, field.components, nodes);
+    findNodesByPartialPath(doc, field.components, nodes, index);
 
     // For partial paths, check for ambiguity
     if (field.is_partial_path && !nodes.empty()) {
@@ -144,20 +162,13 @@ std::vector<XmlResult> XmlNavigator::extractValues(
 
         // Check for ambiguity: if multiple different paths found, error
         if (fullPaths.size() > 1) {
-            std::string pathList;
-            for (const auto& path : fullPaths) {
-                if (!pathList.empty()) pathList += "\n  - ";
-                pathList += path;
-            }
-
             std::string partialPathStr;
             for (size_t i = 0; i < field.components.size(); ++i) {
                 if (i > 0) partialPathStr += ".";
                 partialPathStr += field.components[i];
             }
 
-            throw ARX_ERROR(ErrorCategory::XML_STRUCTURE, ErrorCodes::XML_AMBIGUOUS_PARTIAL_PATH,
-                           "Ambiguous path '." + partialPathStr + "': found at multiple locations:\n  - " + pathList + "\nUse full path to disambiguate.");
+            throw ambiguousPathError(partialPathStr, fullPaths);
         }
     }
 
@@ -174,10 +185,51 @@ std::vector<XmlResult> XmlNavigator::extractValues(
     return results;
 }
 
+// False once the collector is full and the walk can stop
+static bool collectFields(const pugi::xml_node& node, FieldCollector& collector) {
+    for (pugi::xml_node child : node.children()) {
+        switch (child.type()) {
+            case pugi::node_element:
+                collector.startElement(child.name(), [&child](const std::string& name) -> const char* {
+                    pugi::xml_attribute attr = child.attribute(name.c_str());
+                    return attr ? attr.value() : nullptr;
+                });
+                if (collector.full() || !collectFields(child, collector)) {
+                    return false;
+                }
+                collector.endElement();
+                break;
+            case pugi::node_pcdata:
+            case pugi::node_cdata:
+                collector.text(child.value());
+                break;
+            default:
+                break;
+        }
+        if (collector.full()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void XmlNavigator::extractValues(
+    const pugi::xml_document& doc,
+    const std::string& filename,
+    const std::vector<FieldPath>& fields,
+    std::vector<std::vector<XmlResult>>& values,
+    size_t limit
+) {
+    FieldCollector collector(fields, limit);
+    collectFields(doc, collector);
+    collector.finish(filename, values);
+}
+
 bool XmlNavigator::evaluateWhereExpr(
     const pugi::xml_node& node,
     const WhereExpr* expr,
-    size_t parentDepth
+    size_t parentDepth,
+    const ElementIndex* index
 ) {
     if (!expr) {
         return true; // No condition means all pass
@@ -185,13 +237,13 @@ bool XmlNavigator::evaluateWhereExpr(
 
     // Try to cast to WhereCondition
     if (const auto* condition = dynamic_cast<const WhereCondition*>(expr)) {
-        return evaluateCondition(node, *condition, parentDepth);
+        return evaluateCondition(node, *condition, parentDepth, index);
     }
 
     // Try to cast to WhereLogical
     if (const auto* logical = dynamic_cast<const WhereLogical*>(expr)) {
-        bool leftResult = evaluateWhereExpr(node, logical->left.get(), parentDepth);
-        bool rightResult = evaluateWhereExpr(node, logical->right.get(), parentDepth);
+        bool leftResult = evaluateWhereExpr(node, logical->left.get(), parentDepth, index);
+        bool rightResult = evaluateWhereExpr(node, logical->right.get(), parentDepth, index);
 
         switch (logical->op) {
             case LogicalOp::AND:
@@ -206,6 +258,17 @@ bool XmlNavigator::evaluateWhereExpr(
     return false; // Unknown expression type
 }
 
+bool XmlNavigator::evaluateWhere(
+    const pugi::xml_node& node,
+    const CompiledPredicate& where,
+    size_t parentDepth,
+    const ElementIndex* index
+) {
+    return where.evaluate([&](const CompiledPredicate::Condition& condition) {
+        return condition.test(getNodeValueRelative(node, condition.field(), parentDepth, index));
+    });
+}
+
 bool XmlNavigator::evaluateCondition(
     const pugi::xml_node& node,
     const WhereCondition& condition
@@ -213,19 +276,19 @@ bool XmlNavigator::evaluateCondition(
     // Special handling for IS NULL and IS NOT NULL
     if (condition.op == ComparisonOp::IS_NULL) {
         // IS NULL: true if attribute is NOT present (nodeValue is empty)
-        std::string nodeValue = getNodeValue(node, condition.field);
+        std::string_view nodeValue = getNodeValue(node, condition.field);
         return nodeValue.empty();
     }
 
     if (condition.op == ComparisonOp::IS_NOT_NULL) {
         // IS NOT NULL: true if attribute IS present (nodeValue is not empty)
-        std::string nodeValue = getNodeValue(node, condition.field);
+        std::string_view nodeValue = getNodeValue(node, condition.field);
         return !nodeValue.empty();
     }
 
     // Special handling for IN and NOT_IN
     if (condition.op == ComparisonOp::IN || condition.op == ComparisonOp::NOT_IN) {
-        std::string nodeValue = getNodeValue(node, condition.field);
+        std::string_view nodeValue = getNodeValue(node, condition.field);
         if (nodeValue.empty()) {
             return false;
         }
@@ -242,7 +305,7 @@ bool XmlNavigator::evaluateCondition(
         return (condition.op == ComparisonOp::IN) ? found : !found;
     }
 
-    std::string nodeValue = getNodeValue(node, condition.field);
+    std::string_view nodeValue = getNodeValue(node, condition.field);
 
     if (nodeValue.empty()) {
         return false;
@@ -254,24 +317,25 @@ bool XmlNavigator::evaluateCondition(
 bool XmlNavigator::evaluateCondition(
     const pugi::xml_node& node,
     const WhereCondition& condition,
-    size_t parentDepth
+    size_t parentDepth,
+    const ElementIndex* index
 ) {
     // Special handling for IS NULL and IS NOT NULL
     if (condition.op == ComparisonOp::IS_NULL) {
         // IS NULL: true if attribute is NOT present (nodeValue is empty)
-        std::string nodeValue = getNodeValueRelative(node, condition.field, parentDepth);
+        std::string_view nodeValue = getNodeValueRelative(node, condition.field, parentDepth, index);
         return nodeValue.empty();
     }
 
     if (condition.op == ComparisonOp::IS_NOT_NULL) {
         // IS NOT NULL: true if attribute IS present (nodeValue is not empty)
-        std::string nodeValue = getNodeValueRelative(node, condition.field, parentDepth);
+        std::string_view nodeValue = getNodeValueRelative(node, condition.field, parentDepth, index);
         return !nodeValue.empty();
     }
 
     // Special handling for IN and NOT_IN
     if (condition.op == ComparisonOp::IN || condition.op == ComparisonOp::NOT_IN) {
-        std::string nodeValue = getNodeValueRelative(node, condition.field, parentDepth);
+        std::string_view nodeValue = getNodeValueRelative(node, condition.field, parentDepth, index);
         if (nodeValue.empty()) {
             return false;
         }
@@ -288,7 +352,7 @@ bool XmlNavigator::evaluateCondition(
         return (condition.op == ComparisonOp::IN) ? found : !found;
     }
 
-    std::string nodeValue = getNodeValueRelative(node, condition.field, parentDepth);
+    std::string_view nodeValue = getNodeValueRelative(node, condition.field, parentDepth, index);
 
     if (nodeValue.empty()) {
         return false;
@@ -326,12 +390,17 @@ void XmlNavigator::findNodes(
 void XmlNavigator::findNodesByPartialPath(
     const pugi::xml_node& node,
     const std::vector<std::string>& path,
-    std::vector<pugi::xml_node>& results
+    std::vector<pugi::xml_node>& results,
+    const ElementIndex* index
 ) {
     if (path.empty() || !node) {
         return;
     }
 
+    if (index && index->findByPartialPath(node, path, results)) {
+        return;
+    }
+
     // Helper function to build the path from a node to root
     auto getNodePath = [](pugi::xml_node n) -> std::vector<std::string> {
         std::vector<std::string> nodePath;
@@ -386,7 +455,7 @@ void XmlNavigator::findNodesByPartialPath(
     searchTree(node);
 }
 
-std::string XmlNavigator::getNodeValue(
+std::string_view XmlNavigator::getNodeValue(
     const pugi::xml_node& node,
     const FieldPath& field
 ) {
@@ -423,10 +492,11 @@ std::string XmlNavigator::getNodeValue(
     return "";
 }
 
-std::string XmlNavigator::getNodeValueRelative(
+std::string_view XmlNavigator::getNodeValueRelative(
     const pugi::xml_node& node,
     const FieldPath& field,
-    size_t offset
+    size_t offset,
+    const ElementIndex* index
 ) {
     // Handle attribute extraction
     if (field.is_attribute) {
@@ -443,7 +513,7 @@ std::string XmlNavigator::getNodeValueRelative(
 
     // Shorthand: if only one component (after offset), search from current node
     if (field.components.size() == 1 && offset == 0) {
-        pugi::xml_node foundNode = findFirstElementByName(node, field.components[0]);
+        pugi::xml_node foundNode = findFirstElementByName(node, field.components[0], index);
         if (foundNode) {
             return foundNode.child_value();
         }
@@ -464,7 +534,7 @@ std::string XmlNavigator::getNodeValueRelative(
 }
 
 bool XmlNavigator::compareValues(
-    const std::string& nodeValue,
+    std::string_view nodeValue,
     const std::string& targetValue,
     ComparisonOp op,
     bool isNumeric
@@ -473,7 +543,7 @@ bool XmlNavigator::compareValues(
     if (op == ComparisonOp::LIKE || op == ComparisonOp::NOT_LIKE) {
         try {
             std::regex pattern(targetValue);
-            bool matches = std::regex_search(nodeValue, pattern);
+            bool matches = std::regex_search(nodeValue.begin(), nodeValue.end(), pattern);
             return (op == ComparisonOp::LIKE) ? matches : !matches;
         } catch (const std::regex_error&) {
             return false; // Invalid regex
@@ -482,7 +552,7 @@ bool XmlNavigator::compareValues(
 
     if (isNumeric) {
         try {
-            double nodeNum = std::stod(nodeValue);
+            double nodeNum = std::stod(std::string(nodeValue));
             double targetNum = std::stod(targetValue);
 
             switch (op) {
@@ -529,10 +599,17 @@ bool XmlNavigator::compareValues(
 
 pugi::xml_node XmlNavigator::findFirstElementByName(
     const pugi::xml_node& node,
-    const std::string& name
+    const std::string& name,
+    const ElementIndex* index
 ) {
+    // Only elements are indexed, and only they have (non-empty) names
+    pugi::xml_node indexed;
+    if (index && !name.empty() && index->findFirstByName(node, name, indexed)) {
+        return indexed;
+    }
+
     // Check if current node matches
-    if (node && std::string(node.name()) == name) {
+    if (node && name == node.name()) {
         return node;
     }
 
@@ -548,6 +625,19 @@ pugi::xml_node XmlNavigator::findFirstElementByName(
     return pugi::xml_node();
 }
 
+ArianeError XmlNavigator::ambiguousPathError(
+    const std::string& partialPath,
+    const std::set<std::string>& fullPaths
+) {
+    std::string pathList;
+    for (const auto& path : fullPaths) {
+        if (!pathList.empty()) pathList += "\n  - ";
+        pathList += path;
+    }
+    return ARX_ERROR(ErrorCategory::XML_STRUCTURE, ErrorCodes::XML_AMBIGUOUS_PARTIAL_PATH,
+                     "Ambiguous path '." + partialPath + "': found at multiple locations:\n  - " + pathList + "\nUse full path to disambiguate.");
+}
+
 int XmlNavigator::countMatchingPaths(
     const pugi::xml_node& node,
     const std::vector<std::string>& partialPath
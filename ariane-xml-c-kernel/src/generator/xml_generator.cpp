@@ -1,50 +1,90 @@
 #include "generator/xml_generator.h"
+#include "utils/thread_pool.h"
 #include <iostream>
 #include <iomanip>
 #include <sstream>
 #include <filesystem>
 #include <random>
+#include <atomic>
+#include <mutex>
 
 namespace ariane_xml {
 
-XmlGenerator::XmlGenerator() {
+XmlGenerator::XmlGenerator()
+    : rng_(std::random_device{}()) {
 }
 
 void XmlGenerator::generateFiles(
     const XsdSchema& schema,
     int count,
     const std::string& destDir,
-    const std::string& prefix
+    const std::string& prefix,
+    ThreadPool* pool
 ) {
     std::cout << "Generating " << count << " XML files..." << std::endl;
 
-    for (int i = 0; i < count; ++i) {
-        // Generate document
-        pugi::xml_document doc = generateDocument(schema);
-
-        // Create filename with zero-padded number
-        std::ostringstream filename;
-        filename << destDir << "/"
-                 << prefix
-                 << std::setfill('0') << std::setw(4) << (i + 1)
-                 << ".xml";
-
-        // Save document
-        if (!doc.save_file(filename.str().c_str())) {
-            std::cerr << "Error: Failed to save file " << filename.str() << std::endl;
-            continue;
+    std::mutex outputMutex;
+
+    // Progress indicator (every 10%)
+    auto reportProgress = [&](int done) {
+        if (count >= 10 && done % (count / 10) == 0) {
+            int percent = (done * 100) / count;
+            std::lock_guard<std::mutex> lock(outputMutex);
+            std::cout << "Progress: " << percent << "% (" << done << "/" << count << ")" << std::endl;
         }
+    };
 
-        // Progress indicator (every 10%)
-        if (count >= 10 && (i + 1) % (count / 10) == 0) {
-            int percent = ((i + 1) * 100) / count;
-            std::cout << "Progress: " << percent << "% (" << (i + 1) << "/" << count << ")" << std::endl;
+    if (!pool || pool->size() <= 1 || count < 2) {
+        for (int i = 0; i < count; ++i) {
+            if (!generateFile(schema, i + 1, destDir, prefix)) {
+                continue;
+            }
+            reportProgress(i + 1);
         }
+    } else {
+        // Generators carry RNG state, so each worker gets its own
+        std::atomic<int> nextIndex{0};
+        std::atomic<int> completed{0};
+        pool->run(static_cast<size_t>(count), [&](size_t) {
+            XmlGenerator workerGenerator;
+            for (int i = nextIndex++; i < count; i = nextIndex++) {
+                bool saved = workerGenerator.generateFile(schema, i + 1, destDir, prefix);
+                int done = ++completed;
+                if (saved) {
+                    reportProgress(done);
+                }
+            }
+        });
     }
 
     std::cout << "Successfully generated " << count << " XML files in " << destDir << std::endl;
 }
 
+bool XmlGenerator::generateFile(
+    const XsdSchema& schema,
+    int index,
+    const std::string& destDir,
+    const std::string& prefix
+) {
+    // Generate document
+    pugi::xml_document doc = generateDocument(schema);
+
+    // Create filename with zero-padded number
+    std::ostringstream filename;
+    filename << destDir << "/"
+             << prefix
+             << std::setfill('0') << std::setw(4) << index
+             << ".xml";
+
+    // Save document
+    if (!doc.save_file(filename.str().c_str())) {
+        std::cerr << "Error: Failed to save file " << filename.str() << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
 pugi::xml_document XmlGenerator::generateDocument(const XsdSchema& schema) {
     pugi::xml_document doc;
 
@@ -110,12 +150,10 @@ void XmlGenerator::generateElement(
 int XmlGenerator::determineRepeatCount(const std::shared_ptr<XsdElement>& element) {
     // If element is optional (minOccurs=0), randomly decide whether to include it
     if (element->isOptional()) {
-        static std::random_device rd;
-        static std::mt19937 gen(rd());
-        static std::uniform_int_distribution<> include_dist(0, 1);
+        std::uniform_int_distribution<> include_dist(0, 1);
 
         // 70% chance to include optional elements
-        if (include_dist(gen) < 0.7) {
+        if (include_dist(rng_) < 0.7) {
             return 0;  // Skip this element
         }
     }
@@ -126,8 +164,6 @@ int XmlGenerator::determineRepeatCount(const std::shared_ptr<XsdElement>& elemen
     }
 
     // For repeatable elements, generate a random count between minOccurs and maxOccurs
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
 
     int minCount = element->minOccurs;
     int maxCount = element->maxOccurs;
@@ -152,7 +188,7 @@ int XmlGenerator::determineRepeatCount(const std::shared_ptr<XsdElement>& elemen
     }
 
     std::uniform_int_distribution<> count_dist(minCount, maxCount);
-    return count_dist(gen);
+    return count_dist(rng_);
 }
 
 } // namespace ariane_xml
@@ -6,13 +6,11 @@
 
 namespace ariane_xml {
 
-// Initialize static member
-std::map<std::string, std::shared_ptr<XsdElement>> XsdParser::named_types_;
-
 std::unique_ptr<XsdSchema> XsdParser::parse(const std::string& xsd_file_path) {
-    // Clear previous types
-    named_types_.clear();
+    return XsdParser().parseSchema(xsd_file_path);
+}
 
+std::unique_ptr<XsdSchema> XsdParser::parseSchema(const std::string& xsd_file_path) {
     pugi::xml_document doc;
     pugi::xml_parse_result result = doc.load_file(xsd_file_path.c_str());
 
@@ -5,8 +5,9 @@
 #include "utils/app_context.h"
 #include "utils/command_handler.h"
 #include "utils/pseudonymisation_checker.h"
+#include "utils/query_server.h"
 #include "dsn/dsn_autocomplete.h"
-#include "dsn/dsn_parser.h"
+#include "dsn/dsn_schema_tables.h"
 #include "error/error_codes.h"
 #include <iostream>
 #include <string>
@@ -172,7 +173,10 @@ void printUsage(const char* programName) {
     std::cout << "ariane-xml - a FT XML parser for FT/DSI/DIP\n";
     std::cout << "Usage:\n";
     std::cout << "  " << programName << "              # Start interactive mode\n";
-    std::cout << "  " << programName << " [query]      # Execute single query\n\n";
+    std::cout << "  " << programName << " [query]      # Execute single query\n";
+    std::cout << "  " << programName << " --server [--socket <path>]\n";
+    std::cout << "                     # Serve JSON-RPC requests (one per line) on stdin/stdout\n";
+    std::cout << "                     # or a Unix socket, keeping the session between them\n\n";
     std::cout << "Query Syntax:\n";
     std::cout << "  SELECT <field>[,<field>...] FROM <path>\n";
     std::cout << "  [WHERE <condition> [AND|OR <condition>...]]\n";
@@ -208,7 +212,10 @@ void printUsage(const char* programName) {
     std::cout << "  SET XSD <path>        Set XSD schema file path\n";
     std::cout << "  SET DEST <path>       Set destination directory path\n";
     std::cout << "  SHOW XSD              Display current XSD path\n";
-    std::cout << "  SHOW DEST             Display current DEST path\n\n";
+    std::cout << "  SHOW DEST             Display current DEST path\n";
+    std::cout << "  SET CACHE <MB>        Set the document cache memory budget (0 disables)\n";
+    std::cout << "  SHOW CACHE            Display document cache usage\n";
+    std::cout << "  CLEAR CACHE           Drop all cached documents\n\n";
     std::cout << "Generation Commands:\n";
     std::cout << "  GENERATE XML <count>              Generate <count> XML files from XSD\n";
     std::cout << "  GENERATE XML <count> PREFIX <pre> Generate with custom filename prefix\n\n";
@@ -342,8 +349,10 @@ void executeQuery(const std::string& query, const ariane_xml::AppContext* contex
             }
         }
 
-        // Execute query
-        std::vector<ariane_xml::ResultRow> results;
+        // Execute query (on the session's worker pool when there is one)
+        ariane_xml::ResultBatch results;
+        ariane_xml::ThreadPool* pool = context ? context->getThreadPool().get() : nullptr;
+        ariane_xml::DocumentCache* cache = context ? context->getDocumentCache().get() : nullptr;
 
         if (context && context->isVerbose()) {
             // Use progress tracking in VERBOSE mode
@@ -376,9 +385,9 @@ void executeQuery(const std::string& query, const ariane_xml::AppContext* contex
             };
 
             if (useDsnFiltering) {
-                results = ariane_xml::QueryExecutor::executeWithProgressAndFiles(*ast, filteredFiles, progressCallback, &stats);
+                results = ariane_xml::QueryExecutor::executeWithProgressAndFiles(*ast, filteredFiles, progressCallback, &stats, pool, cache);
             } else {
-                results = ariane_xml::QueryExecutor::executeWithProgress(*ast, progressCallback, &stats);
+                results = ariane_xml::QueryExecutor::executeWithProgress(*ast, progressCallback, &stats, pool, cache);
             }
 
             // Clear progress line
@@ -390,7 +399,20 @@ void executeQuery(const std::string& query, const ariane_xml::AppContext* contex
             if (stats.used_threading) {
                 std::cout << "\033[32m✓ Processed " << stats.total_files << " files in "
                           << std::fixed << std::setprecision(2) << stats.execution_time_seconds
-                          << "s (" << stats.thread_count << " threads)\033[0m\n\n";
+                          << "s (" << stats.thread_count << " threads)\033[0m\n";
+
+                // Per-worker load: large idle times point at straggler files
+                for (size_t i = 0; i < stats.worker_stats.size(); ++i) {
+                    const auto& ws = stats.worker_stats[i];
+                    std::cout << "\033[36m  worker " << std::setw(2) << i << ": "
+                              << ws.files_processed << " file(s)";
+                    if (ws.files_stolen > 0) {
+                        std::cout << " (" << ws.files_stolen << " stolen)";
+                    }
+                    std::cout << ", busy " << std::setprecision(3) << ws.busy_seconds
+                              << "s, idle " << ws.idle_seconds << "s\033[0m\n";
+                }
+                std::cout << "\n";
             } else {
                 std::cout << "\033[32m✓ Processed " << stats.total_files << " file(s) in "
                           << std::fixed << std::setprecision(2) << stats.execution_time_seconds
@@ -400,9 +422,9 @@ void executeQuery(const std::string& query, const ariane_xml::AppContext* contex
         } else {
             // Non-verbose mode: use standard execution
             if (useDsnFiltering) {
-                results = ariane_xml::QueryExecutor::executeWithFiles(*ast, filteredFiles);
+                results = ariane_xml::QueryExecutor::executeWithFiles(*ast, filteredFiles, pool, cache);
             } else {
-                results = ariane_xml::QueryExecutor::execute(*ast);
+                results = ariane_xml::QueryExecutor::execute(*ast, pool, cache);
             }
         }
 
@@ -419,50 +441,6 @@ void executeQuery(const std::string& query, const ariane_xml::AppContext* contex
     }
 }
 
-// Helper function to escape JSON strings
-std::string escapeJson(const std::string& str) {
-    std::string result;
-    result.reserve(str.length());
-
-    for (char c : str) {
-        switch (c) {
-            case '"':  result += "\\\""; break;
-            case '\\': result += "\\\\"; break;
-            case '\b': result += "\\b";  break;
-            case '\f': result += "\\f";  break;
-            case '\n': result += "\\n";  break;
-            case '\r': result += "\\r";  break;
-            case '\t': result += "\\t";  break;
-            default:
-                if (static_cast<unsigned char>(c) < 0x20) {
-                    // Control characters
-                    char buf[7];
-                    snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned char>(c));
-                    result += buf;
-                } else {
-                    result += c;
-                }
-                break;
-        }
-    }
-
-    return result;
-}
-
-// Convert AutoCompleteSuggestion type to string
-std::string typeToString(ariane_xml::AutoCompleteSuggestion::Type type) {
-    switch (type) {
-        case ariane_xml::AutoCompleteSuggestion::Type::FIELD:
-            return "field";
-        case ariane_xml::AutoCompleteSuggestion::Type::BLOC:
-            return "bloc";
-        case ariane_xml::AutoCompleteSuggestion::Type::KEYWORD:
-            return "keyword";
-        default:
-            return "unknown";
-    }
-}
-
 // Handle autocomplete request (for Jupyter kernel integration)
 int handleAutocomplete(int argc, char* argv[]) {
     // Usage: ariane-xml --autocomplete <query> <cursor_pos> [--version <P25|P26|AUTO>]
@@ -487,21 +465,13 @@ int handleAutocomplete(int argc, char* argv[]) {
         context.setDsnVersion(version);
 
         // Load DSN schema directly
-        std::string schemaDir;
-        if (version == "P25") {
-            schemaDir = "ariane-xml-schemas/xsd_P25/mensuelle P25";
-        } else if (version == "P26") {
-            schemaDir = "ariane-xml-schemas/xsd_P26/mensuelle P26";
-        } else {
-            // AUTO: try P26 first, fallback to P25
-            schemaDir = "ariane-xml-schemas/xsd_P26/mensuelle P26";
-        }
+        std::string schemaDir = ariane_xml::DsnAutoComplete::schemaDirectory(version);
 
         // Parse schema from directory
-        auto schema = ariane_xml::DsnParser::parseDirectory(schemaDir, version);
+        auto schema = ariane_xml::loadDsnSchemaDirectory(schemaDir, version);
 
         // Check if schema loaded successfully
-        if (!schema || schema->getAttributes().empty()) {
+        if (!schema || schema->attributeCount() == 0) {
             // Return empty suggestions if schema not available
             std::cout << "[]" << std::endl;
             return 0;
@@ -516,19 +486,7 @@ int handleAutocomplete(int argc, char* argv[]) {
         auto suggestions = autocomplete.getSuggestions(query, cursor_pos);
 
         // Output as JSON array
-        std::cout << "[";
-        for (size_t i = 0; i < suggestions.size(); ++i) {
-            if (i > 0) {
-                std::cout << ",";
-            }
-            std::cout << "{";
-            std::cout << "\"completion\":\"" << escapeJson(suggestions[i].completion) << "\",";
-            std::cout << "\"display\":\"" << escapeJson(suggestions[i].display) << "\",";
-            std::cout << "\"description\":\"" << escapeJson(suggestions[i].description) << "\",";
-            std::cout << "\"type\":\"" << typeToString(suggestions[i].type) << "\"";
-            std::cout << "}";
-        }
-        std::cout << "]" << std::endl;
+        std::cout << ariane_xml::DsnAutoComplete::toJson(suggestions) << std::endl;
 
         return 0;
 
@@ -545,6 +503,29 @@ int handleAutocomplete(int argc, char* argv[]) {
     }
 }
 
+// Long-lived JSON-RPC server (for the Jupyter kernel): one session, so the
+// context, DSN schema and document cache stay warm between requests
+int serverMode(int argc, char* argv[]) {
+    // Usage: ariane-xml --server [--socket <path>]
+    std::string socketPath;
+    if (argc >= 4 && std::string(argv[2]) == "--socket") {
+        socketPath = argv[3];
+    } else if (argc != 2) {
+        std::cerr << "Usage: " << argv[0] << " --server [--socket <path>]" << std::endl;
+        return 1;
+    }
+
+    ariane_xml::AppContext context;
+    ariane_xml::CommandHandler commandHandler(context);
+    ariane_xml::QueryServer server([&](const std::string& statement) {
+        if (!commandHandler.handleCommand(statement)) {
+            executeQuery(statement, &context);
+        }
+    });
+
+    return socketPath.empty() ? server.serveStdio() : server.serveSocket(socketPath);
+}
+
 void interactiveMode(bool startInDsnMode = false) {
     // Register signal handler for CTRL-C
     std::signal(SIGINT, signalHandler);
@@ -697,6 +678,11 @@ int main(int argc, char* argv[]) {
             return handleAutocomplete(argc, argv);
         }
 
+        // Handle server mode (for Jupyter kernel integration)
+        if (arg == "--server") {
+            return serverMode(argc, argv);
+        }
+
         // Handle help flag
         if (arg == "-h" || arg == "--help") {
             printUsage(argv[0]);
@@ -713,7 +699,7 @@ int main(int argc, char* argv[]) {
         std::string query = argv[1];
 
         // Quick check: is this likely a command? (avoid double tokenization for SELECT queries)
-        // Commands start with: SET, SHOW, GENERATE, CHECK, DESCRIBE, TEMPLATE, COMPARE, PSEUDONYMISE, LIST
+        // Commands start with: SET, SHOW, GENERATE, CHECK, DESCRIBE, TEMPLATE, COMPARE, PSEUDONYMISE, LIST, CLEAR
         std::string queryUpper = query;
         std::transform(queryUpper.begin(), queryUpper.end(), queryUpper.begin(), ::toupper);
 
@@ -725,7 +711,8 @@ int main(int argc, char* argv[]) {
                                 queryUpper.find("TEMPLATE") == 0 ||
                                 queryUpper.find("COMPARE") == 0 ||
                                 queryUpper.find("PSEUDONYMISE") == 0 ||
-                                queryUpper.find("LIST") == 0);
+                                queryUpper.find("LIST") == 0 ||
+                                queryUpper.find("CLEAR") == 0);
 
         if (isLikelyCommand) {
             // Initialize context and command handler only for commands
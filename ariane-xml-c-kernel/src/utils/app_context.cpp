@@ -1,7 +1,16 @@
 #include "utils/app_context.h"
+#include "utils/thread_pool.h"
+#include "utils/document_cache.h"
+#include "validator/compiled_schema.h"
 
 namespace ariane_xml {
 
+AppContext::AppContext()
+    : thread_pool_(std::make_shared<ThreadPool>()),
+      document_cache_(std::make_shared<DocumentCache>()),
+      schema_cache_(std::make_shared<CompiledSchemaCache>()) {
+}
+
 void AppContext::setXsdPath(const std::string& path) {
     xsd_path_ = path;
 }
@@ -78,4 +87,16 @@ bool AppContext::hasPseudoConfigPath() const {
     return pseudo_config_path_.has_value();
 }
 
+std::shared_ptr<ThreadPool> AppContext::getThreadPool() const {
+    return thread_pool_;
+}
+
+std::shared_ptr<DocumentCache> AppContext::getDocumentCache() const {
+    return document_cache_;
+}
+
+std::shared_ptr<CompiledSchemaCache> AppContext::getSchemaCache() const {
+    return schema_cache_;
+}
+
 } // namespace ariane_xml
@@ -2,26 +2,56 @@
 #include "utils/pseudonymisation_checker.h"
 #include "utils/secure_input.h"
 #include "utils/file_list_handler.h"
+#include "utils/document_cache.h"
 #include "parser/lexer.h"
 #include "generator/xsd_parser.h"
 #include "generator/xml_generator.h"
 #include "validator/xml_validator.h"
 #include "dsn/dsn_schema.h"
 #include "dsn/dsn_parser.h"
+#include "dsn/dsn_schema_tables.h"
 #include "dsn/dsn_validator.h"
 #include "dsn/dsn_templates.h"
 #include "dsn/dsn_migration.h"
 #include <array>
+#include <cctype>
 #include <cstdio>
 #include <iostream>
 #include <filesystem>
 #include <fstream>
 #include <iomanip>
 #include <regex>
+#include <sstream>
 #include <variant>
 
 namespace ariane_xml {
 
+// Case-insensitive match of a non-keyword command word (e.g. CACHE)
+static bool isWord(const Token& token, const std::string& word) {
+    if (token.value.size() != word.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < word.size(); ++i) {
+        if (std::toupper(static_cast<unsigned char>(token.value[i])) != word[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Human-readable byte count for SHOW CACHE
+static std::string formatBytes(size_t bytes) {
+    std::ostringstream out;
+    if (bytes >= 1024 * 1024) {
+        out << std::fixed << std::setprecision(1) << bytes / (1024.0 * 1024.0) << " MB";
+    } else if (bytes >= 1024) {
+        out << std::fixed << std::setprecision(1) << bytes / 1024.0 << " KB";
+    } else {
+        out << bytes << " B";
+    }
+    return out.str();
+}
+
 CommandHandler::CommandHandler(AppContext& context)
     : context_(context) {}
 
@@ -79,6 +109,11 @@ bool CommandHandler::handleCommand(const std::string& input) {
         return handleListCommand(input);
     }
 
+    // Check if it's CLEAR CACHE (CLEAR is not a keyword, so field names stay usable)
+    if (tokens[0].type == TokenType::IDENTIFIER && isWord(tokens[0], "CLEAR")) {
+        return handleClearCommand(input);
+    }
+
     // Not a recognized command, treat as query
     return false;
 }
@@ -95,11 +130,23 @@ bool CommandHandler::handleSetCommand(const std::string& input) {
         std::cerr << "       SET VERBOSE\n";
         std::cerr << "       SET MODE <STANDARD|DSN>\n";
         std::cerr << "       SET PSEUDO_CONFIG /path/to/config.yaml\n";
+        std::cerr << "       SET CACHE <megabytes>\n";
         return true;
     }
 
     TokenType paramType = tokens[1].type;
 
+    // Handle CACHE command: SET CACHE <megabytes>
+    if (paramType == TokenType::IDENTIFIER && isWord(tokens[1], "CACHE")) {
+        if (tokens.size() < 3 || tokens[2].type != TokenType::NUMBER) {
+            std::cerr << "Error: SET CACHE requires a size in megabytes (0 disables the cache)\n";
+            std::cerr << "Usage: SET CACHE 512\n";
+            return true;
+        }
+        setCacheBudget(tokens[2].value);
+        return true;
+    }
+
     // Handle VERBOSE (no path required)
     if (paramType == TokenType::VERBOSE) {
         context_.setVerbose(true);
@@ -195,6 +242,7 @@ bool CommandHandler::handleShowCommand(const std::string& input) {
         std::cerr << "       SHOW MODE\n";
         std::cerr << "       SHOW PSEUDO_CONFIG\n";
         std::cerr << "       SHOW PSEUDONYMISATION STATUS <file>\n";
+        std::cerr << "       SHOW CACHE\n";
         return true;
     }
 
@@ -210,6 +258,8 @@ bool CommandHandler::handleShowCommand(const std::string& input) {
     } else if (paramType == TokenType::IDENTIFIER &&
                (tokens[1].value == "PSEUDO_CONFIG" || tokens[1].value == "pseudo_config")) {
         showPseudoConfig();
+    } else if (paramType == TokenType::IDENTIFIER && isWord(tokens[1], "CACHE")) {
+        showCache();
     } else if (paramType == TokenType::PSEUDONYMISE ||
                (paramType == TokenType::IDENTIFIER &&
                 (tokens[1].value == "PSEUDONYMISATION" || tokens[1].value == "pseudonymisation"))) {
@@ -241,7 +291,7 @@ bool CommandHandler::handleShowCommand(const std::string& input) {
         }
         showPseudonymisationStatus(filepath);
     } else {
-        std::cerr << "Error: Unknown SHOW parameter. Use XSD, DEST, MODE, PSEUDO_CONFIG, or PSEUDONYMISATION STATUS\n";
+        std::cerr << "Error: Unknown SHOW parameter. Use XSD, DEST, MODE, PSEUDO_CONFIG, CACHE, or PSEUDONYMISATION STATUS\n";
     }
 
     return true;
@@ -276,12 +326,12 @@ void CommandHandler::setXsdPath(const std::string& path) {
 
             // Parse the DSN schema
             try {
-                auto schema = DsnParser::parseDirectory(path, version);
+                auto schema = loadDsnSchemaDirectory(path, version, context_.getThreadPool().get());
                 context_.setDsnSchema(schema);
                 context_.setXsdPath(path);
                 std::cout << "DSN schema loaded successfully\n";
-                std::cout << "  Attributes: " << schema->getAttributes().size() << "\n";
-                std::cout << "  Blocs: " << schema->getBlocs().size() << "\n";
+                std::cout << "  Attributes: " << schema->attributeCount() << "\n";
+                std::cout << "  Blocs: " << schema->blocCount() << "\n";
             } catch (const std::exception& e) {
                 std::cerr << "Error loading DSN schema: " << e.what() << "\n";
             }
@@ -318,7 +368,7 @@ void CommandHandler::setXsdPath(const std::string& path) {
                 auto schema = DsnParser::parse(path, version);
                 context_.setDsnSchema(schema);
                 std::cout << "DSN schema loaded successfully\n";
-                std::cout << "  Attributes: " << schema->getAttributes().size() << "\n";
+                std::cout << "  Attributes: " << schema->attributeCount() << "\n";
             } catch (const std::exception& e) {
                 std::cerr << "Warning: Could not parse as DSN schema: " << e.what() << "\n";
             }
@@ -389,6 +439,60 @@ void CommandHandler::showPseudoConfig() {
     }
 }
 
+void CommandHandler::showCache() {
+    DocumentCacheStats stats = context_.getDocumentCache()->stats();
+    uint64_t lookups = stats.hits + stats.misses;
+
+    std::cout << "Document cache: " << stats.entries << " document(s), "
+              << formatBytes(stats.bytes) << " of " << formatBytes(stats.budget) << "\n";
+    std::cout << "  Hits:      " << stats.hits;
+    if (lookups > 0) {
+        std::cout << " (" << std::fixed << std::setprecision(1)
+                  << (100.0 * stats.hits / lookups) << "%)";
+    }
+    std::cout << "\n";
+    std::cout << "  Misses:    " << stats.misses << "\n";
+    std::cout << "  Evictions: " << stats.evictions << "\n";
+}
+
+void CommandHandler::setCacheBudget(const std::string& megabytes) {
+    double value = 0.0;
+    try {
+        value = std::stod(megabytes);
+    } catch (const std::exception&) {
+        value = -1.0;
+    }
+    if (value < 0.0) {
+        std::cerr << "Error: Invalid cache size: " << megabytes << "\n";
+        return;
+    }
+
+    size_t budget = static_cast<size_t>(value * 1024 * 1024);
+    context_.getDocumentCache()->setBudget(budget);
+    if (budget == 0) {
+        std::cout << "Document cache disabled\n";
+    } else {
+        std::cout << "Document cache budget set to " << formatBytes(budget) << "\n";
+    }
+}
+
+bool CommandHandler::handleClearCommand(const std::string& input) {
+    Lexer lexer(input);
+    auto tokens = lexer.tokenize();
+
+    // Expect: CLEAR CACHE
+    if (tokens.size() < 2 || tokens[1].type != TokenType::IDENTIFIER || !isWord(tokens[1], "CACHE")) {
+        std::cerr << "Error: Unknown CLEAR command\n";
+        std::cerr << "Usage: CLEAR CACHE\n";
+        return true;
+    }
+
+    size_t dropped = context_.getDocumentCache()->clear();
+    context_.getSchemaCache()->clear();  // CHECK recompiles its XSD on next use
+    std::cout << "Document cache cleared (" << dropped << " document(s) released)\n";
+    return true;
+}
+
 void CommandHandler::showPseudonymisationStatus(const std::string& filepath) {
     // Check if file exists
     if (!std::filesystem::exists(filepath)) {
@@ -561,7 +665,7 @@ bool CommandHandler::handleGenerateCommand(const std::string& input) {
 
         // Generate XML files
         XmlGenerator generator;
-        generator.generateFiles(*schema, count, destPath, prefix);
+        generator.generateFiles(*schema, count, destPath, prefix, context_.getThreadPool().get());
 
     } catch (const std::exception& e) {
         std::cerr << "Error generating XML files: " << e.what() << "\n";
@@ -631,7 +735,8 @@ bool CommandHandler::handleCheckCommand(const std::string& input) {
 
     // Validate all files with XSD
     XmlValidator validator;
-    auto results = validator.validateFiles(files, xsdPath);
+    auto results = validator.validateFiles(files, xsdPath, context_.getThreadPool().get(),
+                                           context_.getSchemaCache().get());
 
     // If in DSN mode and schema is loaded, perform DSN-specific validation
     if (context_.isDsnMode() && context_.hasDsnSchema()) {
@@ -749,7 +854,7 @@ bool CommandHandler::handleDescribeCommand(const std::string& input) {
     auto schema = context_.getDsnSchema();
 
     // Try to find by full name
-    const DsnAttribute* attr = schema->findByFullName(field_name);
+    auto attr = schema->findByFullName(field_name);
     if (attr) {
         std::cout << "\n";
         std::cout << "══════════════════════════════════════════════════════════════\n";
@@ -804,7 +909,7 @@ bool CommandHandler::handleDescribeCommand(const std::string& input) {
     }
 
     // Try as bloc
-    const DsnBloc* bloc = schema->findBloc(field_name);
+    auto bloc = schema->findBloc(field_name);
     if (bloc) {
         std::cout << "\n";
         std::cout << "══════════════════════════════════════════════════════════════\n";
@@ -818,7 +923,7 @@ bool CommandHandler::handleDescribeCommand(const std::string& input) {
             std::cout << "Description:  " << bloc->description << "\n\n";
         }
         std::cout << "Fields:\n";
-        for (const auto& attr : bloc->attributes) {
+        for (const auto& attr : schema->findBlocAttributes(bloc->name)) {
             std::cout << "  • " << std::left << std::setw(25) << attr.full_name
                      << " - " << attr.description << "\n";
         }
@@ -1172,7 +1277,7 @@ bool CommandHandler::handleListCommand(const std::string& input) {
     FileListHandler handler;
 
     // List files in the directory
-    auto result = handler.listFiles(path);
+    auto result = handler.listFiles(path, context_.getThreadPool().get());
 
     // Check if result is an error
     if (std::holds_alternative<ArianeError>(result)) {
@@ -0,0 +1,134 @@
+#include "utils/document_cache.h"
+#include <system_error>
+#include <vector>
+
+namespace ariane_xml {
+
+// Approximate size of one pugixml node or attribute record
+static constexpr size_t NODE_RECORD_SIZE = 64;
+
+DocumentCache::DocumentCache(size_t budgetBytes)
+    : budget_(budgetBytes) {}
+
+std::shared_ptr<const XmlDocument> DocumentCache::load(const std::string& filepath) {
+    std::error_code ec;
+    uintmax_t size = std::filesystem::file_size(filepath, ec);
+    std::filesystem::file_time_type mtime;
+    if (!ec) {
+        mtime = std::filesystem::last_write_time(filepath, ec);
+    }
+    bool cacheable = !ec;
+    size_t budget = 0;
+
+    if (cacheable) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(filepath);
+        if (it != entries_.end()) {
+            if (it->second.size == size && it->second.mtime == mtime) {
+                lru_.splice(lru_.begin(), lru_, it->second.lruPos);
+                ++hits_;
+                return it->second.doc;
+            }
+            erase(it);  // Stale: the file changed since it was cached
+        }
+        ++misses_;
+        budget = budget_;
+    }
+
+    // Parse outside the lock so workers load different files in parallel
+    auto doc = std::make_shared<const XmlDocument>(XmlLoader::load(filepath));
+    if (!cacheable || budget == 0) {  // Caching off: don't size a document that won't be kept
+        return doc;
+    }
+
+    size_t cost = estimateCost(*doc, size, budget);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (cost > budget_) {
+        return doc;
+    }
+    if (entries_.count(filepath)) {
+        // Another worker loaded the same file meanwhile; keep the first copy
+        return doc;
+    }
+
+    evictToFit(cost);
+    lru_.push_front(filepath);
+    Entry entry;
+    entry.doc = doc;
+    entry.size = size;
+    entry.mtime = mtime;
+    entry.cost = cost;
+    entry.lruPos = lru_.begin();
+    entries_.emplace(filepath, std::move(entry));
+    bytes_ += cost;
+
+    return doc;
+}
+
+bool DocumentCache::contains(const std::string& filepath) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.count(filepath) > 0;
+}
+
+void DocumentCache::setBudget(size_t budgetBytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    budget_ = budgetBytes;
+    evictToFit(0);
+}
+
+size_t DocumentCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t dropped = entries_.size();
+    entries_.clear();
+    lru_.clear();
+    bytes_ = 0;
+    return dropped;
+}
+
+DocumentCacheStats DocumentCache::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    DocumentCacheStats result;
+    result.entries = entries_.size();
+    result.bytes = bytes_;
+    result.budget = budget_;
+    result.hits = hits_;
+    result.misses = misses_;
+    result.evictions = evictions_;
+    return result;
+}
+
+size_t DocumentCache::estimateCost(const XmlDocument& doc, uintmax_t fileSize, size_t limit) {
+    size_t cost = static_cast<size_t>(fileSize);
+    std::vector<pugi::xml_node> stack{*doc};
+    while (!stack.empty() && cost <= limit) {
+        pugi::xml_node node = stack.back();
+        stack.pop_back();
+        cost += NODE_RECORD_SIZE;
+        if (node.type() == pugi::node_element) {
+            cost += ElementIndex::BYTES_PER_ELEMENT;
+        }
+        for (pugi::xml_attribute attr = node.first_attribute(); attr; attr = attr.next_attribute()) {
+            cost += NODE_RECORD_SIZE;
+        }
+        for (pugi::xml_node child = node.first_child(); child; child = child.next_sibling()) {
+            stack.push_back(child);
+        }
+    }
+    return cost;
+}
+
+void DocumentCache::evictToFit(size_t incoming) {
+    while (!lru_.empty() && bytes_ + incoming > budget_) {
+        erase(entries_.find(lru_.back()));
+        ++evictions_;
+    }
+}
+
+void DocumentCache::erase(std::unordered_map<std::string, Entry>::iterator it) {
+    bytes_ -= it->second.cost;
+    lru_.erase(it->second.lruPos);
+    entries_.erase(it);
+}
+
+} // namespace ariane_xml
@@ -0,0 +1,159 @@
+#include "utils/element_index.h"
+#include <algorithm>
+#include <cstring>
+
+namespace ariane_xml {
+
+// A posting, an order entry and a subtree end per element
+const size_t ElementIndex::BYTES_PER_ELEMENT =
+    sizeof(Posting) + sizeof(std::pair<const void*, uint32_t>) + sizeof(uint32_t);
+
+ElementIndex::ElementIndex(const pugi::xml_document& doc)
+    : document_(doc) {
+    // Iterative preorder walk; 'open' holds the preorder numbers of the
+    // elements whose subtree is still being visited
+    std::vector<uint32_t> open;
+    pugi::xml_node node = doc.first_child();
+
+    while (node) {
+        if (node.type() == pugi::node_element) {
+            uint32_t order = static_cast<uint32_t>(subtreeEnd_.size());
+            subtreeEnd_.push_back(order + 1);
+            orderOf_.push_back({node.internal_object(), order});
+            byName_[std::string_view(node.name())].push_back({order, node});
+
+            if (node.first_child()) {
+                open.push_back(order);
+                node = node.first_child();
+                continue;
+            }
+        }
+
+        // Move to the next sibling, closing finished subtrees on the way up
+        while (node) {
+            if (pugi::xml_node sibling = node.next_sibling()) {
+                node = sibling;
+                break;
+            }
+            node = node.parent();
+            if (!node || node.type() != pugi::node_element) {
+                node = pugi::xml_node();
+                break;
+            }
+            subtreeEnd_[open.back()] = static_cast<uint32_t>(subtreeEnd_.size());
+            open.pop_back();
+        }
+    }
+
+    std::sort(orderOf_.begin(), orderOf_.end());
+}
+
+bool ElementIndex::scopeRange(const pugi::xml_node& scope, uint32_t& begin, uint32_t& end) const {
+    if (scope.type() == pugi::node_document) {
+        if (scope != document_) {
+            return false;
+        }
+        begin = 0;
+        end = static_cast<uint32_t>(subtreeEnd_.size());
+        return true;
+    }
+
+    if (scope.type() != pugi::node_element) {
+        return false;
+    }
+
+    const void* key = scope.internal_object();
+    auto it = std::lower_bound(orderOf_.begin(), orderOf_.end(), std::make_pair(key, uint32_t(0)));
+    if (it == orderOf_.end() || it->first != key) {
+        return false;  // Node of another document
+    }
+    begin = it->second;
+    end = subtreeEnd_[begin];
+    return true;
+}
+
+const ElementIndex::Posting* ElementIndex::firstPosting(
+    const std::string& name,
+    uint32_t begin,
+    const Posting*& last
+) const {
+    auto it = byName_.find(std::string_view(name));
+    if (it == byName_.end()) {
+        return nullptr;
+    }
+    const auto& postings = it->second;
+    last = postings.data() + postings.size();
+    auto first = std::lower_bound(postings.begin(), postings.end(), begin,
+        [](const Posting& posting, uint32_t order) { return posting.order < order; });
+    return postings.data() + (first - postings.begin());
+}
+
+bool ElementIndex::findByName(
+    const pugi::xml_node& scope,
+    const std::string& name,
+    std::vector<pugi::xml_node>& results
+) const {
+    uint32_t begin, end;
+    if (!scopeRange(scope, begin, end)) {
+        return false;
+    }
+
+    const Posting* last = nullptr;
+    for (const Posting* p = firstPosting(name, begin, last); p && p != last && p->order < end; ++p) {
+        results.push_back(p->node);
+    }
+    return true;
+}
+
+bool ElementIndex::findFirstByName(
+    const pugi::xml_node& scope,
+    const std::string& name,
+    pugi::xml_node& result
+) const {
+    uint32_t begin, end;
+    if (!scopeRange(scope, begin, end)) {
+        return false;
+    }
+
+    result = pugi::xml_node();
+    const Posting* last = nullptr;
+    const Posting* p = firstPosting(name, begin, last);
+    if (p && p != last && p->order < end) {
+        result = p->node;
+    }
+    return true;
+}
+
+bool ElementIndex::findByPartialPath(
+    const pugi::xml_node& scope,
+    const std::vector<std::string>& path,
+    std::vector<pugi::xml_node>& results
+) const {
+    uint32_t begin, end;
+    if (!scopeRange(scope, begin, end)) {
+        return false;
+    }
+    if (path.empty()) {
+        return true;
+    }
+
+    // Probe the last component, then check the rest against the parent chain
+    const Posting* last = nullptr;
+    for (const Posting* p = firstPosting(path.back(), begin, last); p && p != last && p->order < end; ++p) {
+        pugi::xml_node ancestor = p->node.parent();
+        bool matches = true;
+        for (size_t i = path.size() - 1; i-- > 0;) {
+            if (ancestor.type() != pugi::node_element || std::strcmp(ancestor.name(), path[i].c_str()) != 0) {
+                matches = false;
+                break;
+            }
+            ancestor = ancestor.parent();
+        }
+        if (matches) {
+            results.push_back(p->node);
+        }
+    }
+    return true;
+}
+
+} // namespace ariane_xml
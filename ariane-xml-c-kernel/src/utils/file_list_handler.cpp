@@ -1,5 +1,6 @@
 #include "utils/file_list_handler.h"
 #include "utils/pseudonymisation_checker.h"
+#include "utils/thread_pool.h"
 #include <pugixml.hpp>
 #include <iostream>
 #include <fstream>
@@ -177,7 +178,8 @@ bool FileListHandler::isDsnRootElement(const std::string& elementName) const {
            != config_.rootElements.end();
 }
 
-std::variant<std::vector<FileInfo>, ArianeError> FileListHandler::listFiles(const std::string& directoryPath) {
+std::variant<std::vector<FileInfo>, ArianeError> FileListHandler::listFiles(const std::string& directoryPath,
+                                                                            ThreadPool* pool) {
     namespace fs = std::filesystem;
 
     // Validate directory path
@@ -208,8 +210,8 @@ std::variant<std::vector<FileInfo>, ArianeError> FileListHandler::listFiles(cons
                         "Cannot access directory: " + ec.message());
     }
 
-    // Collect all XML files
-    std::vector<FileInfo> files;
+    // Collect all XML file paths
+    std::vector<fs::path> xmlPaths;
 
     for (const auto& entry : dirIter) {
         if (!entry.is_regular_file()) {
@@ -221,11 +223,33 @@ std::variant<std::vector<FileInfo>, ArianeError> FileListHandler::listFiles(cons
         std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
 
         if (extension == ".xml") {
-            auto result = getFileInfo(path);
-            if (std::holds_alternative<FileInfo>(result)) {
-                files.push_back(std::get<FileInfo>(result));
-            }
-            // Skip files that can't be read (permissions, parse errors, etc.)
+            xmlPaths.push_back(path);
+        }
+    }
+
+    // Inspect each file (each one is parsed, so this is the expensive part)
+    std::vector<std::optional<FileInfo>> infos(xmlPaths.size());
+    auto inspect = [&](size_t i) {
+        auto result = getFileInfo(xmlPaths[i]);
+        if (std::holds_alternative<FileInfo>(result)) {
+            infos[i] = std::move(std::get<FileInfo>(result));
+        }
+        // Skip files that can't be read (permissions, parse errors, etc.)
+    };
+
+    if (pool) {
+        pool->parallelFor(xmlPaths.size(), inspect);
+    } else {
+        for (size_t i = 0; i < xmlPaths.size(); ++i) {
+            inspect(i);
+        }
+    }
+
+    std::vector<FileInfo> files;
+    files.reserve(infos.size());
+    for (auto& info : infos) {
+        if (info) {
+            files.push_back(std::move(*info));
         }
     }
 
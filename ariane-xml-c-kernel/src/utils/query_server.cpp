@@ -0,0 +1,660 @@
+#include "utils/query_server.h"
+#include "dsn/dsn_autocomplete.h"
+#include "dsn/dsn_schema_tables.h"
+#include "error/error_codes.h"
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+namespace ariane_xml {
+
+namespace {
+
+// JSON-RPC 2.0 error codes
+constexpr int PARSE_ERROR = -32700;
+constexpr int INVALID_REQUEST = -32600;
+constexpr int METHOD_NOT_FOUND = -32601;
+constexpr int INVALID_PARAMS = -32602;
+constexpr int STATEMENT_FAILED = -32000;
+
+// The subset of JSON a request needs. Numbers keep their source text, so
+// an id is echoed back exactly as the client sent it.
+struct JsonValue {
+    enum class Type { NUL, BOOLEAN, NUMBER, STRING, ARRAY, OBJECT };
+
+    Type type = Type::NUL;
+    bool boolean = false;
+    std::string text;  // String value, or the number as written
+    std::vector<JsonValue> items;
+    std::vector<std::pair<std::string, JsonValue>> members;
+
+    const JsonValue* member(const std::string& name) const {
+        for (const auto& [key, value] : members) {
+            if (key == name) {
+                return &value;
+            }
+        }
+        return nullptr;
+    }
+};
+
+class JsonReader {
+public:
+    explicit JsonReader(const std::string& text) : text_(text) {}
+
+    // False when 'text' isn't exactly one JSON value
+    bool read(JsonValue& value) {
+        if (!readValue(value, 0)) {
+            return false;
+        }
+        skipSpace();
+        return pos_ == text_.size();
+    }
+
+private:
+    static constexpr int MAX_DEPTH = 64;
+
+    void skipSpace() {
+        while (pos_ < text_.size() &&
+               (text_[pos_] == ' ' || text_[pos_] == '\t' || text_[pos_] == '\n' || text_[pos_] == '\r')) {
+            ++pos_;
+        }
+    }
+
+    bool consume(const char* word) {
+        size_t length = std::strlen(word);
+        if (text_.compare(pos_, length, word) != 0) {
+            return false;
+        }
+        pos_ += length;
+        return true;
+    }
+
+    bool readValue(JsonValue& value, int depth) {
+        skipSpace();
+        if (pos_ >= text_.size() || depth > MAX_DEPTH) {
+            return false;
+        }
+        char c = text_[pos_];
+        if (c == '{') {
+            value.type = JsonValue::Type::OBJECT;
+            return readObject(value, depth);
+        }
+        if (c == '[') {
+            value.type = JsonValue::Type::ARRAY;
+            return readArray(value, depth);
+        }
+        if (c == '"') {
+            value.type = JsonValue::Type::STRING;
+            return readString(value.text);
+        }
+        if (c == '-' || (c >= '0' && c <= '9')) {
+            value.type = JsonValue::Type::NUMBER;
+            return readNumber(value.text);
+        }
+        if (consume("true") || consume("false")) {
+            value.type = JsonValue::Type::BOOLEAN;
+            value.boolean = c == 't';
+            return true;
+        }
+        value.type = JsonValue::Type::NUL;
+        return consume("null");
+    }
+
+    bool readObject(JsonValue& value, int depth) {
+        ++pos_;  // '{'
+        skipSpace();
+        if (pos_ < text_.size() && text_[pos_] == '}') {
+            ++pos_;
+            return true;
+        }
+        while (true) {
+            skipSpace();
+            std::string key;
+            if (pos_ >= text_.size() || text_[pos_] != '"' || !readString(key)) {
+                return false;
+            }
+            skipSpace();
+            if (pos_ >= text_.size() || text_[pos_] != ':') {
+                return false;
+            }
+            ++pos_;
+            JsonValue member;
+            if (!readValue(member, depth + 1)) {
+                return false;
+            }
+            value.members.emplace_back(std::move(key), std::move(member));
+            skipSpace();
+            if (pos_ < text_.size() && text_[pos_] == ',') {
+                ++pos_;
+                continue;
+            }
+            if (pos_ < text_.size() && text_[pos_] == '}') {
+                ++pos_;
+                return true;
+            }
+            return false;
+        }
+    }
+
+    bool readArray(JsonValue& value, int depth) {
+        ++pos_;  // '['
+        skipSpace();
+        if (pos_ < text_.size() && text_[pos_] == ']') {
+            ++pos_;
+            return true;
+        }
+        while (true) {
+            JsonValue item;
+            if (!readValue(item, depth + 1)) {
+                return false;
+            }
+            value.items.push_back(std::move(item));
+            skipSpace();
+            if (pos_ < text_.size() && text_[pos_] == ',') {
+                ++pos_;
+                continue;
+            }
+            if (pos_ < text_.size() && text_[pos_] == ']') {
+                ++pos_;
+                return true;
+            }
+            return false;
+        }
+    }
+
+    bool readNumber(std::string& number) {
+        size_t start = pos_;
+        if (text_[pos_] == '-') {
+            ++pos_;
+        }
+        auto digits = [&]() {
+            size_t first = pos_;
+            while (pos_ < text_.size() && text_[pos_] >= '0' && text_[pos_] <= '9') {
+                ++pos_;
+            }
+            return pos_ > first;
+        };
+        if (!digits()) {
+            return false;
+        }
+        if (pos_ < text_.size() && text_[pos_] == '.') {
+            ++pos_;
+            if (!digits()) {
+                return false;
+            }
+        }
+        if (pos_ < text_.size() && (text_[pos_] == 'e' || text_[pos_] == 'E')) {
+            ++pos_;
+            if (pos_ < text_.size() && (text_[pos_] == '+' || text_[pos_] == '-')) {
+                ++pos_;
+            }
+            if (!digits()) {
+                return false;
+            }
+        }
+        number = text_.substr(start, pos_ - start);
+        return true;
+    }
+
+    bool readHex4(unsigned& code) {
+        if (pos_ + 4 > text_.size()) {
+            return false;
+        }
+        code = 0;
+        for (int i = 0; i < 4; ++i) {
+            char c = text_[pos_++];
+            code <<= 4;
+            if (c >= '0' && c <= '9') code |= c - '0';
+            else if (c >= 'a' && c <= 'f') code |= c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F') code |= c - 'A' + 10;
+            else return false;
+        }
+        return true;
+    }
+
+    static void appendUtf8(std::string& out, unsigned code) {
+        if (code < 0x80) {
+            out += static_cast<char>(code);
+        } else if (code < 0x800) {
+            out += static_cast<char>(0xC0 | (code >> 6));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        } else if (code < 0x10000) {
+            out += static_cast<char>(0xE0 | (code >> 12));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (code >> 18));
+            out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        }
+    }
+
+    bool readString(std::string& out) {
+        ++pos_;  // Opening quote
+        while (pos_ < text_.size()) {
+            char c = text_[pos_++];
+            if (c == '"') {
+                return true;
+            }
+            if (static_cast<unsigned char>(c) < 0x20) {
+                return false;
+            }
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            if (pos_ >= text_.size()) {
+                return false;
+            }
+            char escape = text_[pos_++];
+            switch (escape) {
+                case '"':  out += '"';  break;
+                case '\\': out += '\\'; break;
+                case '/':  out += '/';  break;
+                case 'b':  out += '\b'; break;
+                case 'f':  out += '\f'; break;
+                case 'n':  out += '\n'; break;
+                case 'r':  out += '\r'; break;
+                case 't':  out += '\t'; break;
+                case 'u': {
+                    unsigned code = 0;
+                    if (!readHex4(code)) {
+                        return false;
+                    }
+                    // Surrogate pair for characters beyond the BMP
+                    if (code >= 0xD800 && code < 0xDC00 && consume("\\u")) {
+                        unsigned low = 0;
+                        if (!readHex4(low) || low < 0xDC00 || low >= 0xE000) {
+                            return false;
+                        }
+                        code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                    }
+                    appendUtf8(out, code);
+                    break;
+                }
+                default:
+                    return false;
+            }
+        }
+        return false;
+    }
+
+    const std::string& text_;
+    size_t pos_ = 0;
+};
+
+std::string quoteJson(const std::string& text) {
+    std::string result = "\"";
+    result.reserve(text.size() + 2);
+    for (char c : text) {
+        switch (c) {
+            case '"':  result += "\\\""; break;
+            case '\\': result += "\\\\"; break;
+            case '\b': result += "\\b";  break;
+            case '\f': result += "\\f";  break;
+            case '\n': result += "\\n";  break;
+            case '\r': result += "\\r";  break;
+            case '\t': result += "\\t";  break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buf[7];
+                    snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned char>(c));
+                    result += buf;
+                } else {
+                    result += c;
+                }
+                break;
+        }
+    }
+    result += '"';
+    return result;
+}
+
+// The request id as JSON; only strings, numbers and null are valid ids
+std::string idToJson(const JsonValue* id) {
+    if (id && id->type == JsonValue::Type::STRING) {
+        return quoteJson(id->text);
+    }
+    if (id && id->type == JsonValue::Type::NUMBER) {
+        return id->text;
+    }
+    return "null";
+}
+
+std::string resultResponse(const std::string& id, const std::string& result) {
+    return "{\"jsonrpc\":\"2.0\",\"id\":" + id + ",\"result\":" + result + "}";
+}
+
+std::string errorResponse(const std::string& id, int code, const std::string& message,
+                          const std::string& data = "") {
+    std::string error = "{\"code\":" + std::to_string(code) + ",\"message\":" + quoteJson(message);
+    if (!data.empty()) {
+        error += ",\"data\":" + data;
+    }
+    return "{\"jsonrpc\":\"2.0\",\"id\":" + id + ",\"error\":" + error + "}}";
+}
+
+// String buffer that worker threads may write to concurrently (the scan
+// reports unreadable files on std::cerr from the pool). Recursive, since
+// xsputn grows the buffer through overflow.
+class LockedStringBuf : public std::stringbuf {
+protected:
+    std::streamsize xsputn(const char* data, std::streamsize count) override {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
+        return std::stringbuf::xsputn(data, count);
+    }
+
+    int_type overflow(int_type c) override {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
+        return std::stringbuf::overflow(c);
+    }
+
+private:
+    std::recursive_mutex mutex_;
+};
+
+// Redirects std::cout and std::cerr into buffers while alive
+class CapturedOutput {
+public:
+    CapturedOutput()
+        : out_(std::make_unique<LockedStringBuf>()),
+          err_(std::make_unique<LockedStringBuf>()),
+          oldOut_(std::cout.rdbuf(out_.get())),
+          oldErr_(std::cerr.rdbuf(err_.get())) {}
+
+    ~CapturedOutput() {
+        std::cout.flush();
+        std::cout.rdbuf(oldOut_);
+        std::cerr.rdbuf(oldErr_);
+    }
+
+    CapturedOutput(const CapturedOutput&) = delete;
+    CapturedOutput& operator=(const CapturedOutput&) = delete;
+
+    std::string out() const { return out_->str(); }
+    std::string err() const { return err_->str(); }
+
+private:
+    std::unique_ptr<LockedStringBuf> out_;
+    std::unique_ptr<LockedStringBuf> err_;
+    std::streambuf* oldOut_;
+    std::streambuf* oldErr_;
+};
+
+// Points std::cin at an empty buffer while alive, so a statement that
+// prompts (SET DEST on a missing directory, ENCRYPT's password) reads no
+// answer and takes its default, instead of consuming the next request
+class DetachedInput {
+public:
+    DetachedInput() : oldIn_(std::cin.rdbuf(&empty_)) {}
+
+    ~DetachedInput() {
+        std::cin.rdbuf(oldIn_);
+        std::cin.clear();
+    }
+
+    DetachedInput(const DetachedInput&) = delete;
+    DetachedInput& operator=(const DetachedInput&) = delete;
+
+private:
+    std::stringbuf empty_;
+    std::streambuf* oldIn_;
+};
+
+// Drop a trailing ';' (and the blanks around it) as the shell does
+std::string trimStatement(const std::string& query) {
+    const char* blanks = " \t\r\n";
+    size_t begin = query.find_first_not_of(blanks);
+    if (begin == std::string::npos) {
+        return "";
+    }
+    std::string statement = query.substr(begin, query.find_last_not_of(blanks) + 1 - begin);
+    if (statement.back() == ';') {
+        statement.pop_back();
+        size_t last = statement.find_last_not_of(blanks);
+        statement.erase(last == std::string::npos ? 0 : last + 1);
+    }
+    return statement;
+}
+
+bool sendAll(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        sent += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+} // namespace
+
+QueryServer::QueryServer(StatementRunner runStatement)
+    : runStatement_(std::move(runStatement)) {}
+
+QueryServer::~QueryServer() = default;
+
+DsnAutoComplete* QueryServer::completer(const std::string& version) {
+    auto it = completers_.find(version);
+    if (it != completers_.end()) {
+        return it->second.get();
+    }
+
+    // A schema that fails to load is remembered too, so keystrokes don't
+    // retry the parse; the parser's progress messages stay off the wire
+    std::unique_ptr<DsnAutoComplete> completer;
+    {
+        CapturedOutput captured;
+        try {
+            auto schema = loadDsnSchemaDirectory(DsnAutoComplete::schemaDirectory(version), version);
+            if (schema && schema->attributeCount() > 0) {
+                completer = std::make_unique<DsnAutoComplete>(schema);
+            }
+        } catch (const std::exception&) {
+        }
+    }
+    return completers_.emplace(version, std::move(completer)).first->second.get();
+}
+
+std::string QueryServer::handle(const std::string& request) {
+    JsonValue message;
+    if (!JsonReader(request).read(message)) {
+        return errorResponse("null", PARSE_ERROR, "Parse error");
+    }
+
+    const JsonValue* id = message.type == JsonValue::Type::OBJECT ? message.member("id") : nullptr;
+    std::string idJson = idToJson(id);
+    const JsonValue* method = message.type == JsonValue::Type::OBJECT ? message.member("method") : nullptr;
+    if (!method || method->type != JsonValue::Type::STRING) {
+        return errorResponse(idJson, INVALID_REQUEST, "Invalid request");
+    }
+    const JsonValue* params = message.member("params");
+    bool notification = id == nullptr;
+
+    std::string response;
+    if (method->text == "execute") {
+        const JsonValue* query = params ? params->member("query") : nullptr;
+        if (!query || query->type != JsonValue::Type::STRING) {
+            response = errorResponse(idJson, INVALID_PARAMS, "execute needs a string 'query'");
+        } else {
+            // Report failures the way the command line would: message on
+            // stderr after whatever was printed, plus the exit code
+            std::string failure;
+            int exitCode = 0;
+            std::string output;
+            std::string errors;
+            {
+                CapturedOutput captured;
+                DetachedInput detached;
+                try {
+                    std::string statement = trimStatement(query->text);
+                    if (!statement.empty()) {
+                        runStatement_(statement);
+                    }
+                } catch (const ArianeError& e) {
+                    failure = e.getFullMessage();
+                    exitCode = e.getExitCode();
+                } catch (const std::exception& e) {
+                    failure = std::string("Error: ") + e.what();
+                    exitCode = 1;
+                }
+                output = captured.out();
+                errors = captured.err();
+            }
+            if (!failure.empty()) {
+                errors += failure + "\n";
+            }
+
+            if (exitCode != 0) {
+                response = errorResponse(idJson, STATEMENT_FAILED, failure,
+                                         "{\"exit_code\":" + std::to_string(exitCode) +
+                                         ",\"output\":" + quoteJson(output) +
+                                         ",\"stderr\":" + quoteJson(errors) + "}");
+            } else {
+                response = resultResponse(idJson, "{\"output\":" + quoteJson(output) +
+                                                  ",\"stderr\":" + quoteJson(errors) + "}");
+            }
+        }
+    } else if (method->text == "complete") {
+        const JsonValue* code = params ? params->member("code") : nullptr;
+        const JsonValue* cursor = params ? params->member("cursor_pos") : nullptr;
+        const JsonValue* version = params ? params->member("version") : nullptr;
+        if (!code || code->type != JsonValue::Type::STRING ||
+            !cursor || cursor->type != JsonValue::Type::NUMBER || cursor->text[0] == '-' ||
+            (version && version->type != JsonValue::Type::STRING)) {
+            response = errorResponse(idJson, INVALID_PARAMS,
+                                     "complete needs a string 'code' and a 'cursor_pos'");
+        } else {
+            size_t cursorPos = std::strtoull(cursor->text.c_str(), nullptr, 10);
+            DsnAutoComplete* autocomplete = completer(version ? version->text : "AUTO");
+            response = resultResponse(idJson, autocomplete
+                ? DsnAutoComplete::toJson(autocomplete->getSuggestions(code->text, cursorPos))
+                : "[]");
+        }
+    } else if (method->text == "shutdown") {
+        stopped_ = true;
+        response = resultResponse(idJson, "null");
+    } else {
+        response = errorResponse(idJson, METHOD_NOT_FOUND, "Method not found: " + method->text);
+    }
+
+    return notification ? "" : response;
+}
+
+int QueryServer::serveStdio() {
+    // Statements print to std::cout, which is captured while they run;
+    // responses go straight to the real stdout
+    std::ostream out(std::cout.rdbuf());
+    std::string line;
+    while (!stopped_ && std::getline(std::cin, line)) {
+        if (line.find_first_not_of(" \t\r") == std::string::npos) {
+            continue;
+        }
+        std::string response = handle(line);
+        if (!response.empty()) {
+            out << response << '\n' << std::flush;
+        }
+    }
+    return 0;
+}
+
+int QueryServer::serveSocket(const std::string& path) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+        std::cerr << "Error: Invalid socket path: " << path << "\n";
+        return 1;
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+    // Replace a socket left behind by an earlier server, but nothing else
+    struct stat existing;
+    if (::lstat(path.c_str(), &existing) == 0) {
+        if (!S_ISSOCK(existing.st_mode)) {
+            std::cerr << "Error: " << path << " exists and is not a socket\n";
+            return 1;
+        }
+        ::unlink(path.c_str());
+    }
+
+    int listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0) {
+        std::cerr << "Error: Cannot create socket: " << std::strerror(errno) << "\n";
+        return 1;
+    }
+    // Queries read whatever the server can read: owner access only
+    mode_t oldMask = ::umask(0077);
+    int bound = ::bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    ::umask(oldMask);
+    if (bound < 0 || ::listen(listener, 4) < 0) {
+        std::cerr << "Error: Cannot listen on " << path << ": " << std::strerror(errno) << "\n";
+        ::close(listener);
+        return 1;
+    }
+
+    while (!stopped_) {
+        int client = ::accept(listener, nullptr, nullptr);
+        if (client < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::cerr << "Error: accept failed: " << std::strerror(errno) << "\n";
+            break;
+        }
+
+        std::string pending;
+        char buffer[65536];
+        bool open = true;
+        while (open && !stopped_) {
+            ssize_t n = ::read(client, buffer, sizeof(buffer));
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                break;
+            }
+            pending.append(buffer, static_cast<size_t>(n));
+
+            size_t start = 0;
+            for (size_t newline = pending.find('\n'); newline != std::string::npos && !stopped_;
+                 newline = pending.find('\n', start)) {
+                std::string line = pending.substr(start, newline - start);
+                start = newline + 1;
+                if (line.find_first_not_of(" \t\r") == std::string::npos) {
+                    continue;
+                }
+                std::string response = handle(line);
+                if (!response.empty() && !sendAll(client, response + "\n")) {
+                    open = false;
+                    break;
+                }
+            }
+            pending.erase(0, start);
+        }
+        ::close(client);
+    }
+
+    ::close(listener);
+    ::unlink(path.c_str());
+    return 0;
+}
+
+} // namespace ariane_xml
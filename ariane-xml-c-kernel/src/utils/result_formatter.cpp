@@ -6,11 +6,11 @@
 
 namespace ariane_xml {
 
-void ResultFormatter::print(const std::vector<ResultRow>& results, std::ostream& out) {
+void ResultFormatter::print(const ResultBatch& results, std::ostream& out) {
     out << formatAsText(results);
 }
 
-std::string ResultFormatter::formatAsText(const std::vector<ResultRow>& results) {
+std::string ResultFormatter::formatAsText(const ResultBatch& results) {
     std::ostringstream oss;
 
     // Add blank line before results
@@ -24,11 +24,8 @@ std::string ResultFormatter::formatAsText(const std::vector<ResultRow>& results)
     const int MAX_COLUMN_WIDTH = 50;
     const std::string TRUNCATE_INDICATOR = " 🔴"; // Red circle emoji
 
-    // Extract column headers from first row
-    std::vector<std::string> headers;
-    for (const auto& [field, value] : results[0]) {
-        headers.push_back(field);
-    }
+    // Column headers come from the batch's schema
+    const std::vector<std::string>& headers = results.columnNames();
 
     // Calculate column widths based on headers and data
     std::vector<size_t> columnWidths(headers.size(), 0);
@@ -39,16 +36,14 @@ std::string ResultFormatter::formatAsText(const std::vector<ResultRow>& results)
     }
 
     // Update with data widths (considering truncation)
-    for (const auto& row : results) {
-        size_t colIdx = 0;
-        for (const auto& [field, value] : row) {
-            size_t displayWidth = value.length();
+    for (size_t colIdx = 0; colIdx < headers.size(); ++colIdx) {
+        for (size_t row = 0; row < results.rowCount(); ++row) {
+            size_t displayWidth = results.value(row, colIdx).length();
             if (displayWidth > MAX_COLUMN_WIDTH) {
                 // Width will be MAX_COLUMN_WIDTH - 1 (for truncation) + indicator length
                 displayWidth = MAX_COLUMN_WIDTH - 1 + TRUNCATE_INDICATOR.length();
             }
             columnWidths[colIdx] = std::max(columnWidths[colIdx], displayWidth);
-            colIdx++;
         }
     }
 
@@ -71,31 +66,29 @@ std::string ResultFormatter::formatAsText(const std::vector<ResultRow>& results)
     oss << "\n";
 
     // Print data rows
-    for (const auto& row : results) {
-        size_t colIdx = 0;
-        for (const auto& [field, value] : row) {
+    for (size_t row = 0; row < results.rowCount(); ++row) {
+        for (size_t colIdx = 0; colIdx < headers.size(); ++colIdx) {
             if (colIdx > 0) {
                 oss << " | ";
             }
 
             // Handle truncation
-            std::string displayValue = value;
-            if (value.length() > MAX_COLUMN_WIDTH) {
-                displayValue = value.substr(0, MAX_COLUMN_WIDTH - 1) + TRUNCATE_INDICATOR;
+            std::string displayValue(results.value(row, colIdx));
+            if (displayValue.length() > MAX_COLUMN_WIDTH) {
+                displayValue = displayValue.substr(0, MAX_COLUMN_WIDTH - 1) + TRUNCATE_INDICATOR;
             }
 
             oss << std::left << std::setw(columnWidths[colIdx]) << displayValue;
-            colIdx++;
         }
         oss << "\n";
     }
 
     // Print row count
     oss << "\n";
-    if (results.size() == 1) {
+    if (results.rowCount() == 1) {
         oss << "1 row returned.\n";
     } else {
-        oss << results.size() << " rows returned.\n";
+        oss << results.rowCount() << " rows returned.\n";
     }
 
     return oss.str();
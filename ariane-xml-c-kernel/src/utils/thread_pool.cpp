@@ -0,0 +1,121 @@
+#include "utils/thread_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+
+namespace ariane_xml {
+
+namespace {
+// Set on pool threads so nested run() calls execute inline instead of
+// queueing behind the very jobs that are waiting on them
+thread_local bool t_inPoolThread = false;
+}
+
+ThreadPool::ThreadPool(size_t threadCount)
+    : size_(threadCount > 0 ? threadCount : defaultThreadCount()) {
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+size_t ThreadPool::defaultThreadCount() {
+    size_t hwThreads = std::thread::hardware_concurrency();
+    return hwThreads > 0 ? hwThreads : 4;
+}
+
+void ThreadPool::start() {
+    // Caller holds mutex_
+    threads_.reserve(size_);
+    for (size_t i = 0; i < size_; ++i) {
+        threads_.emplace_back([this]() { workerLoop(); });
+    }
+}
+
+void ThreadPool::workerLoop() {
+    t_inPoolThread = true;
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this]() { return stopping_ || !tasks_.empty(); });
+            if (tasks_.empty()) {
+                return;  // Stopping and drained
+            }
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+        task();
+    }
+}
+
+void ThreadPool::run(size_t workerCount, const std::function<void(size_t)>& job) {
+    workerCount = std::min(workerCount, size_);
+    if (workerCount == 0) {
+        return;
+    }
+
+    if (workerCount == 1 || t_inPoolThread) {
+        for (size_t workerId = 0; workerId < workerCount; ++workerId) {
+            job(workerId);
+        }
+        return;
+    }
+
+    // Completion latch for this batch
+    std::mutex doneMutex;
+    std::condition_variable doneCv;
+    size_t remaining = workerCount;
+    std::exception_ptr firstError;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (threads_.empty()) {
+            start();
+        }
+        for (size_t workerId = 0; workerId < workerCount; ++workerId) {
+            tasks_.push_back([&, workerId]() {
+                std::exception_ptr error;
+                try {
+                    job(workerId);
+                } catch (...) {
+                    error = std::current_exception();
+                }
+
+                std::lock_guard<std::mutex> doneLock(doneMutex);
+                if (error && !firstError) {
+                    firstError = error;
+                }
+                if (--remaining == 0) {
+                    doneCv.notify_one();
+                }
+            });
+        }
+    }
+    cv_.notify_all();
+
+    std::unique_lock<std::mutex> doneLock(doneMutex);
+    doneCv.wait(doneLock, [&]() { return remaining == 0; });
+
+    if (firstError) {
+        std::rethrow_exception(firstError);
+    }
+}
+
+void ThreadPool::parallelFor(size_t taskCount, const std::function<void(size_t)>& task) {
+    std::atomic<size_t> nextIndex{0};
+    run(std::min(taskCount, size_), [&](size_t) {
+        for (size_t i = nextIndex++; i < taskCount; i = nextIndex++) {
+            task(i);
+        }
+    });
+}
+
+} // namespace ariane_xml
@@ -1,13 +1,95 @@
 #include "utils/xml_loader.h"
 #include "error/error_codes.h"
 #include <algorithm>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 namespace ariane_xml {
 
-std::unique_ptr<pugi::xml_document> XmlLoader::load(const std::string& filepath) {
-    auto doc = std::make_unique<pugi::xml_document>();
+XmlDocument::XmlDocument()
+    : doc_(std::make_unique<pugi::xml_document>()),
+      indexSlot_(std::make_unique<IndexSlot>()) {}
 
-    pugi::xml_parse_result result = doc->load_file(filepath.c_str());
+XmlDocument::~XmlDocument() {
+    release();
+}
+
+XmlDocument::XmlDocument(XmlDocument&& other) noexcept
+    : doc_(std::move(other.doc_)),
+      indexSlot_(std::move(other.indexSlot_)),
+      mapping_(other.mapping_),
+      mappingSize_(other.mappingSize_) {
+    other.mapping_ = nullptr;
+    other.mappingSize_ = 0;
+}
+
+XmlDocument& XmlDocument::operator=(XmlDocument&& other) noexcept {
+    if (this != &other) {
+        release();
+        doc_ = std::move(other.doc_);
+        indexSlot_ = std::move(other.indexSlot_);
+        mapping_ = other.mapping_;
+        mappingSize_ = other.mappingSize_;
+        other.mapping_ = nullptr;
+        other.mappingSize_ = 0;
+    }
+    return *this;
+}
+
+void XmlDocument::release() {
+    // The index references the document, which references the mapping
+    indexSlot_.reset();
+    doc_.reset();
+    if (mapping_) {
+        munmap(mapping_, mappingSize_);
+        mapping_ = nullptr;
+        mappingSize_ = 0;
+    }
+}
+
+const ElementIndex& XmlDocument::index() const {
+    std::call_once(indexSlot_->built, [this] {
+        indexSlot_->index = std::make_unique<ElementIndex>(*doc_);
+    });
+    return *indexSlot_->index;
+}
+
+XmlDocument XmlLoader::load(const std::string& filepath) {
+    XmlDocument doc;
+    pugi::xml_parse_result result;
+
+    int fd = open(filepath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        // Same as pugixml's load_file: any failure to open is "not found"
+        result.status = pugi::status_file_not_found;
+    } else {
+        struct stat st;
+        bool regular = fstat(fd, &st) == 0 && S_ISREG(st.st_mode);
+
+        if (regular && st.st_size > 0) {
+            size_t size = static_cast<size_t>(st.st_size);
+            // Private writable mapping: pugixml terminates names and decodes
+            // entities in place, which only copies the pages it touches
+            void* mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+            if (mapping != MAP_FAILED) {
+                madvise(mapping, size, MADV_SEQUENTIAL);
+                doc.mapping_ = mapping;
+                doc.mappingSize_ = size;
+            }
+        }
+        close(fd);
+
+        if (doc.mapping_) {
+            result = doc->load_buffer_inplace(doc.mapping_, doc.mappingSize_);
+        } else if (regular && st.st_size == 0) {
+            result = doc->load_buffer("", 0);
+        } else {
+            // Special files, or the mapping failed: let pugixml read it
+            result = doc->load_file(filepath.c_str());
+        }
+    }
 
     if (!result) {
         // Check if it's a file not found error (status_file_not_found)
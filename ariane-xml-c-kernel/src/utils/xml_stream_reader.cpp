@@ -0,0 +1,576 @@
+#include "utils/xml_stream_reader.h"
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+
+namespace ariane_xml {
+
+namespace {
+
+constexpr size_t CHUNK_SIZE = 64 * 1024;
+
+bool isSpace(int c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+bool isNameStart(int c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || c == ':' || c >= 0x80;
+}
+
+bool isNameChar(int c) {
+    return isNameStart(c) || (c >= '0' && c <= '9') || c == '-' || c == '.';
+}
+
+void appendUtf8(std::string& out, unsigned long cp) {
+    if (cp < 0x80) {
+        out += static_cast<char>(cp);
+    } else if (cp < 0x800) {
+        out += static_cast<char>(0xC0 | (cp >> 6));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        out += static_cast<char>(0xE0 | (cp >> 12));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (cp >> 18));
+        out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+}
+
+// Case-insensitive match used for the declared encoding name
+bool equalsIgnoreCase(const std::string& a, const char* b) {
+    size_t n = std::strlen(b);
+    if (a.size() != n) return false;
+    for (size_t i = 0; i < n; ++i) {
+        if (std::tolower(static_cast<unsigned char>(a[i])) != b[i]) return false;
+    }
+    return true;
+}
+
+struct FileCloser {
+    void operator()(std::FILE* f) const { if (f) std::fclose(f); }
+};
+
+class StreamParser {
+public:
+    StreamParser(std::FILE* file, XmlStreamHandler& handler)
+        : file_(file), handler_(handler) {}
+
+    bool run();
+
+    std::string error;
+
+private:
+    // ---- Byte source (chunked, optional ISO-8859-1 -> UTF-8 conversion) ----
+
+    int peek() {
+        if (pos_ == buffer_.size() && !refill()) {
+            return EOF;
+        }
+        return static_cast<unsigned char>(buffer_[pos_]);
+    }
+
+    int get() {
+        int c = peek();
+        if (c != EOF) {
+            ++pos_;
+        }
+        return c;
+    }
+
+    bool refill();
+    void switchToLatin1();
+
+    bool fail(const std::string& message) {
+        if (error.empty()) {
+            error = message;
+        }
+        return false;
+    }
+
+    // ---- Tokens ----
+    bool parseText();
+    bool parseMarkup();
+    bool parseStartTag();
+    bool parseEndTag();
+    bool parseProcessingInstruction();
+    bool parseComment();
+    bool parseCData();
+    bool parseDoctype();
+    bool parseName(std::string& name);
+    bool parseAttributeValue(std::string& value);
+    void skipSpaces(bool* sawSpace = nullptr);
+    bool expect(const char* literal);
+    bool decodeEntity(std::string& out);
+
+    std::FILE* file_;
+    XmlStreamHandler& handler_;
+
+    std::string buffer_;
+    std::string raw_;
+    size_t pos_ = 0;
+    bool eof_ = false;
+    bool latin1_ = false;
+
+    bool atStart_ = true;       // Nothing but a BOM consumed yet
+    bool sawRoot_ = false;
+    std::vector<std::string> open_;
+    std::vector<XmlStreamAttribute> attributes_;
+    size_t attributeCount_ = 0;
+    std::string name_;
+    std::string text_;
+};
+
+bool StreamParser::refill() {
+    if (eof_) {
+        return false;
+    }
+    raw_.resize(CHUNK_SIZE);
+    size_t n = std::fread(&raw_[0], 1, CHUNK_SIZE, file_);
+    if (n < CHUNK_SIZE) {
+        eof_ = true;
+        if (std::ferror(file_)) {
+            fail("I/O error while reading");
+            return false;
+        }
+    }
+    raw_.resize(n);
+    pos_ = 0;
+
+    if (!latin1_) {
+        buffer_.swap(raw_);
+    } else {
+        buffer_.clear();
+        for (char ch : raw_) {
+            appendUtf8(buffer_, static_cast<unsigned char>(ch));
+        }
+    }
+    return !buffer_.empty();
+}
+
+void StreamParser::switchToLatin1() {
+    // The declaration is ASCII, so only the bytes after it need converting
+    std::string rest = buffer_.substr(pos_);
+    buffer_.clear();
+    for (char ch : rest) {
+        appendUtf8(buffer_, static_cast<unsigned char>(ch));
+    }
+    pos_ = 0;
+    latin1_ = true;
+}
+
+void StreamParser::skipSpaces(bool* sawSpace) {
+    while (isSpace(peek())) {
+        get();
+        if (sawSpace) *sawSpace = true;
+    }
+}
+
+bool StreamParser::expect(const char* literal) {
+    for (const char* p = literal; *p; ++p) {
+        if (get() != static_cast<unsigned char>(*p)) {
+            return fail(std::string("expected '") + literal + "'");
+        }
+    }
+    return true;
+}
+
+bool StreamParser::parseName(std::string& name) {
+    name.clear();
+    if (!isNameStart(peek())) {
+        return fail("invalid name");
+    }
+    while (isNameChar(peek())) {
+        name += static_cast<char>(get());
+    }
+    return true;
+}
+
+// Called after '&'. Decodes the five predefined entities and character
+// references; anything else is kept literally, as pugixml does.
+bool StreamParser::decodeEntity(std::string& out) {
+    std::string token;
+    while (token.size() < 12) {
+        int c = peek();
+        bool alnum = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9');
+        if (!alnum && c != '#') {
+            break;
+        }
+        token += static_cast<char>(get());
+    }
+    if (peek() != ';') {
+        out += '&';
+        out += token;
+        return true;
+    }
+
+    if (token == "amp")  { get(); out += '&';  return true; }
+    if (token == "lt")   { get(); out += '<';  return true; }
+    if (token == "gt")   { get(); out += '>';  return true; }
+    if (token == "apos") { get(); out += '\''; return true; }
+    if (token == "quot") { get(); out += '"';  return true; }
+
+    if (token.size() >= 2 && token[0] == '#') {
+        bool hex = token[1] == 'x';
+        size_t start = hex ? 2 : 1;
+        unsigned long cp = 0;
+        bool valid = start < token.size();
+        for (size_t i = start; i < token.size() && valid; ++i) {
+            char ch = token[i];
+            int digit;
+            if (ch >= '0' && ch <= '9') digit = ch - '0';
+            else if (hex && ch >= 'a' && ch <= 'f') digit = ch - 'a' + 10;
+            else if (hex && ch >= 'A' && ch <= 'F') digit = ch - 'A' + 10;
+            else { valid = false; break; }
+            cp = cp * (hex ? 16 : 10) + digit;
+        }
+        if (valid) {
+            if (cp == 0 || cp > 0x10FFFF) {
+                // pugixml would embed a NUL or an invalid code point; leave it to the DOM path
+                return fail("unsupported character reference");
+            }
+            get();
+            appendUtf8(out, cp);
+            return true;
+        }
+    }
+
+    out += '&';
+    out += token;
+    return true;
+}
+
+bool StreamParser::parseText() {
+    text_.clear();
+    bool whitespaceOnly = true;
+
+    while (true) {
+        int c = peek();
+        if (c == EOF || c == '<') {
+            break;
+        }
+        get();
+        if (!isSpace(c)) {
+            whitespaceOnly = false;
+        }
+        if (c == '&') {
+            if (!decodeEntity(text_)) return false;
+        } else if (c == '\r') {
+            if (peek() == '\n') get();
+            text_ += '\n';
+        } else {
+            text_ += static_cast<char>(c);
+        }
+    }
+
+    if (whitespaceOnly) {
+        return true;
+    }
+    atStart_ = false;
+    if (open_.empty()) {
+        return fail("text outside the root element");
+    }
+    return handler_.text(text_, false) || fail("stopped by handler");
+}
+
+bool StreamParser::parseAttributeValue(std::string& value) {
+    value.clear();
+    int quote = get();
+    if (quote != '"' && quote != '\'') {
+        return fail("attribute value must be quoted");
+    }
+    while (true) {
+        int c = get();
+        if (c == EOF) {
+            return fail("unterminated attribute value");
+        }
+        if (c == quote) {
+            return true;
+        }
+        if (c == '<') {
+            return fail("'<' in attribute value");
+        }
+        if (c == '&') {
+            if (!decodeEntity(value)) return false;
+        } else if (c == '\r') {
+            if (peek() == '\n') get();
+            value += ' ';
+        } else if (c == '\n' || c == '\t') {
+            value += ' ';
+        } else {
+            value += static_cast<char>(c);
+        }
+    }
+}
+
+bool StreamParser::parseStartTag() {
+    if (!parseName(name_)) return false;
+
+    // Attribute slots are reused between elements to avoid reallocating
+    attributeCount_ = 0;
+    bool selfClosing = false;
+
+    while (true) {
+        bool sawSpace = false;
+        skipSpaces(&sawSpace);
+        int c = peek();
+        if (c == '/') {
+            get();
+            if (!expect(">")) return false;
+            selfClosing = true;
+            break;
+        }
+        if (c == '>') {
+            get();
+            break;
+        }
+        if (!sawSpace || !isNameStart(c)) {
+            return fail("malformed start tag <" + name_ + ">");
+        }
+
+        if (attributeCount_ == attributes_.size()) {
+            attributes_.emplace_back();
+        }
+        XmlStreamAttribute& attr = attributes_[attributeCount_++];
+        if (!parseName(attr.first)) return false;
+        skipSpaces();
+        if (!expect("=")) return false;
+        skipSpaces();
+        if (!parseAttributeValue(attr.second)) return false;
+    }
+
+    sawRoot_ = true;
+    atStart_ = false;
+
+    attributes_.resize(attributeCount_);
+    if (!handler_.startElement(name_, attributes_)) {
+        return fail("stopped by handler");
+    }
+
+    if (selfClosing) {
+        return handler_.endElement(name_) || fail("stopped by handler");
+    }
+    open_.push_back(name_);
+    return true;
+}
+
+bool StreamParser::parseEndTag() {
+    if (!parseName(name_)) return false;
+    skipSpaces();
+    if (!expect(">")) return false;
+
+    if (open_.empty() || open_.back() != name_) {
+        return fail("mismatched end tag </" + name_ + ">");
+    }
+    open_.pop_back();
+    return handler_.endElement(name_) || fail("stopped by handler");
+}
+
+bool StreamParser::parseProcessingInstruction() {
+    std::string target;
+    if (!parseName(target)) return false;
+
+    std::string content;
+    while (true) {
+        int c = get();
+        if (c == EOF) {
+            return fail("unterminated processing instruction");
+        }
+        if (c == '?' && peek() == '>') {
+            get();
+            break;
+        }
+        content += static_cast<char>(c);
+    }
+
+    if (!equalsIgnoreCase(target, "xml")) {
+        atStart_ = false;
+        return true;
+    }
+    if (!atStart_) {
+        return fail("XML declaration not at start of document");
+    }
+    atStart_ = false;
+
+    // Same rule as pugixml: ISO-8859-1 / latin1 is converted, anything else is read as UTF-8
+    size_t enc = content.find("encoding");
+    if (enc != std::string::npos) {
+        size_t i = enc + 8;
+        while (i < content.size() && isSpace(content[i])) ++i;
+        if (i < content.size() && content[i] == '=') {
+            ++i;
+            while (i < content.size() && isSpace(content[i])) ++i;
+            if (i < content.size() && (content[i] == '"' || content[i] == '\'')) {
+                char quote = content[i++];
+                size_t end = content.find(quote, i);
+                if (end != std::string::npos) {
+                    std::string name = content.substr(i, end - i);
+                    if (equalsIgnoreCase(name, "iso-8859-1") || equalsIgnoreCase(name, "latin1")) {
+                        switchToLatin1();
+                    }
+                }
+            }
+        }
+    }
+    return true;
+}
+
+bool StreamParser::parseComment() {
+    // "<!--" consumed
+    int dashes = 0;
+    while (true) {
+        int c = get();
+        if (c == EOF) {
+            return fail("unterminated comment");
+        }
+        if (c == '>' && dashes >= 2) {
+            return true;
+        }
+        dashes = (c == '-') ? dashes + 1 : 0;
+    }
+}
+
+bool StreamParser::parseCData() {
+    // "<![CDATA[" consumed
+    text_.clear();
+    while (true) {
+        int c = get();
+        if (c == EOF) {
+            return fail("unterminated CDATA section");
+        }
+        if (c == '>' && text_.size() >= 2 &&
+            text_[text_.size() - 1] == ']' && text_[text_.size() - 2] == ']') {
+            text_.resize(text_.size() - 2);
+            break;
+        }
+        if (c == '\r') {
+            if (peek() == '\n') get();
+            text_ += '\n';
+        } else {
+            text_ += static_cast<char>(c);
+        }
+    }
+
+    if (open_.empty()) {
+        return fail("CDATA outside the root element");
+    }
+    return handler_.text(text_, true) || fail("stopped by handler");
+}
+
+bool StreamParser::parseDoctype() {
+    // "<!DOCTYPE" consumed; skip it, including any internal subset
+    if (!open_.empty() || sawRoot_) {
+        return fail("DOCTYPE inside the document");
+    }
+    int brackets = 0;
+    while (true) {
+        int c = get();
+        if (c == EOF) {
+            return fail("unterminated DOCTYPE");
+        }
+        if (c == '"' || c == '\'') {
+            int quote = c;
+            do {
+                c = get();
+                if (c == EOF) return fail("unterminated DOCTYPE");
+            } while (c != quote);
+        } else if (c == '[') {
+            ++brackets;
+        } else if (c == ']') {
+            --brackets;
+        } else if (c == '>' && brackets <= 0) {
+            return true;
+        }
+    }
+}
+
+bool StreamParser::parseMarkup() {
+    get();  // '<'
+    int c = peek();
+
+    if (c == '/') {
+        get();
+        return parseEndTag();
+    }
+    if (c == '?') {
+        get();
+        return parseProcessingInstruction();
+    }
+    if (c == '!') {
+        get();
+        c = peek();
+        if (c == '-') {
+            return expect("--") && parseComment();
+        }
+        if (c == '[') {
+            return expect("[CDATA[") && parseCData();
+        }
+        if (c == 'D') {
+            return expect("DOCTYPE") && parseDoctype();
+        }
+        return fail("unsupported markup declaration");
+    }
+    return parseStartTag();
+}
+
+bool StreamParser::run() {
+    if (!refill()) {
+        return fail("empty file");
+    }
+
+    // Encoding sniffing: UTF-8 BOM is skipped, UTF-16/32 is left to pugixml
+    if (buffer_.size() >= 3 && static_cast<unsigned char>(buffer_[0]) == 0xEF &&
+        static_cast<unsigned char>(buffer_[1]) == 0xBB && static_cast<unsigned char>(buffer_[2]) == 0xBF) {
+        pos_ = 3;
+    } else if (buffer_[0] == '\0' || (buffer_.size() >= 2 && buffer_[1] == '\0') ||
+               static_cast<unsigned char>(buffer_[0]) == 0xFE ||
+               static_cast<unsigned char>(buffer_[0]) == 0xFF) {
+        return fail("unsupported encoding");
+    }
+
+    while (true) {
+        int c = peek();
+        if (c == EOF) {
+            break;
+        }
+        bool ok = (c == '<') ? parseMarkup() : parseText();
+        if (!ok) {
+            return false;
+        }
+    }
+
+    if (!error.empty()) {
+        return false;  // I/O error during refill
+    }
+    if (!open_.empty()) {
+        return fail("unexpected end of file inside <" + open_.back() + ">");
+    }
+    if (!sawRoot_) {
+        return fail("no document element");
+    }
+    return true;
+}
+
+} // namespace
+
+bool XmlStreamReader::parse(const std::string& filepath,
+                            XmlStreamHandler& handler,
+                            std::string* error) {
+    std::unique_ptr<std::FILE, FileCloser> file(std::fopen(filepath.c_str(), "rb"));
+    if (!file) {
+        if (error) *error = "cannot open file";
+        return false;
+    }
+
+    StreamParser parser(file.get(), handler);
+    bool ok = parser.run();
+    if (!ok && error) {
+        *error = parser.error.empty() ? "parse error" : parser.error;
+    }
+    return ok;
+}
+
+} // namespace ariane_xml
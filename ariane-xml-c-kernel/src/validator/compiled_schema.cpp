@@ -0,0 +1,206 @@
+#include "validator/compiled_schema.h"
+#include "generator/xsd_parser.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <system_error>
+
+namespace ariane_xml {
+
+namespace {
+
+// Whether 'value' has exactly the shape of 'shape', where 'd' stands for
+// an ASCII digit and any other character for itself
+bool matchesShape(const char* value, const char* shape) {
+    for (; *shape; ++value, ++shape) {
+        if (*value == '\0') {
+            return false;
+        }
+        bool ok = *shape == 'd' ? (*value >= '0' && *value <= '9') : *value == *shape;
+        if (!ok) {
+            return false;
+        }
+    }
+    return *value == '\0';
+}
+
+} // namespace
+
+std::shared_ptr<const CompiledSchema> CompiledSchema::load(const std::string& xsdPath) {
+    return compile(*XsdParser::parse(xsdPath));
+}
+
+std::shared_ptr<const CompiledSchema> CompiledSchema::compile(const XsdSchema& schema) {
+    std::shared_ptr<CompiledSchema> compiled(new CompiledSchema());
+
+    auto root = schema.getRootElement();
+    if (root) {
+        // Declarations are shared between the parents of a named type's
+        // elements; each is compiled once
+        std::unordered_map<const XsdElement*, TypeId> types;
+        compiled->rootName_ = root->name;
+        compiled->rootType_ = compiled->compileType(*root, types);
+    }
+    return compiled;
+}
+
+CompiledSchema::TypeId CompiledSchema::compileType(
+    const XsdElement& element,
+    std::unordered_map<const XsdElement*, TypeId>& compiled
+) {
+    auto it = compiled.find(&element);
+    if (it != compiled.end()) {
+        return it->second;
+    }
+
+    // Children first, so this type's particles end up consecutive
+    std::vector<TypeId> childTypes;
+    childTypes.reserve(element.children.size());
+    for (const auto& child : element.children) {
+        childTypes.push_back(compileType(*child, compiled));
+    }
+
+    Type type;
+    type.content = element.type;
+    type.optional = element.isOptional();
+
+    type.particlesBegin = static_cast<uint32_t>(particles_.size());
+    type.lookupBegin = static_cast<uint32_t>(lookup_.size());
+    for (size_t i = 0; i < element.children.size(); ++i) {
+        const XsdElement& child = *element.children[i];
+        Particle particle;
+        particle.name = intern(child.name);
+        particle.type = childTypes[i];
+        particle.minOccurs = child.minOccurs;
+        particle.maxOccurs = child.maxOccurs;
+
+        particle.firstOfName = std::none_of(lookup_.begin() + type.lookupBegin, lookup_.end(),
+                                            [&](const auto& entry) { return entry.first == particle.name; });
+        if (particle.firstOfName) {
+            lookup_.emplace_back(particle.name, static_cast<uint32_t>(particles_.size()));
+        }
+        particles_.push_back(particle);
+    }
+    type.particlesEnd = static_cast<uint32_t>(particles_.size());
+    type.lookupEnd = static_cast<uint32_t>(lookup_.size());
+    std::sort(lookup_.begin() + type.lookupBegin, lookup_.end());
+
+    type.attributesBegin = static_cast<uint32_t>(attributes_.size());
+    for (const auto& attr : element.attributes) {
+        attributes_.push_back(Attribute{attr->name, attr->type, !attr->isOptional()});
+    }
+    type.attributesEnd = static_cast<uint32_t>(attributes_.size());
+
+    TypeId id = static_cast<TypeId>(types_.size());
+    types_.push_back(type);
+    compiled.emplace(&element, id);
+    return id;
+}
+
+CompiledSchema::NameId CompiledSchema::intern(const std::string& name) {
+    auto it = nameIds_.find(name);
+    if (it != nameIds_.end()) {
+        return it->second;
+    }
+    names_.push_back(name);
+    NameId id = static_cast<NameId>(names_.size() - 1);
+    nameIds_.emplace(names_.back(), id);
+    return id;
+}
+
+CompiledSchema::NameId CompiledSchema::nameId(std::string_view name) const {
+    auto it = nameIds_.find(name);
+    return it != nameIds_.end() ? it->second : NONE;
+}
+
+uint32_t CompiledSchema::findParticle(const Type& type, NameId name) const {
+    auto begin = lookup_.begin() + type.lookupBegin;
+    auto end = lookup_.begin() + type.lookupEnd;
+    auto it = std::lower_bound(begin, end, std::make_pair(name, uint32_t(0)));
+    return it != end && it->first == name ? it->second : NONE;
+}
+
+bool CompiledSchema::matchesType(const char* value, XsdType type) {
+    if (*value == '\0') {
+        return true; // Empty values are checked separately
+    }
+
+    switch (type) {
+        case XsdType::STRING:
+            return true; // Any string is valid
+
+        case XsdType::INTEGER: {
+            // The whole value must convert, without overflow
+            char* end;
+            errno = 0;
+            std::strtoll(value, &end, 10);
+            return end != value && errno != ERANGE && *end == '\0';
+        }
+
+        case XsdType::DECIMAL: {
+            char* end;
+            errno = 0;
+            std::strtod(value, &end);
+            return end != value && errno != ERANGE && *end == '\0';
+        }
+
+        case XsdType::BOOLEAN: {
+            std::string_view text(value);
+            return text == "true" || text == "false" || text == "1" || text == "0";
+        }
+
+        case XsdType::DATE:
+            // Basic ISO date format: YYYY-MM-DD
+            return matchesShape(value, "dddd-dd-dd");
+
+        case XsdType::DATETIME:
+            // Basic ISO datetime format: YYYY-MM-DDTHH:MM:SS
+            return matchesShape(value, "dddd-dd-ddTdd:dd:dd");
+
+        case XsdType::COMPLEX:
+            return true; // Complex types are validated structurally
+
+        default:
+            return true;
+    }
+}
+
+std::shared_ptr<const CompiledSchema> CompiledSchemaCache::load(const std::string& xsdPath) {
+    std::error_code ec;
+    uintmax_t size = std::filesystem::file_size(xsdPath, ec);
+    std::filesystem::file_time_type mtime;
+    if (!ec) {
+        mtime = std::filesystem::last_write_time(xsdPath, ec);
+    }
+    if (ec) {
+        // Let the parser report the unreadable file
+        return CompiledSchema::load(xsdPath);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(xsdPath);
+        if (it != entries_.end() && it->second.size == size && it->second.mtime == mtime) {
+            return it->second.schema;
+        }
+    }
+
+    // Compile outside the lock; a schema that fails to parse isn't cached
+    auto schema = CompiledSchema::load(xsdPath);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    Entry& entry = entries_[xsdPath];
+    entry.schema = schema;
+    entry.size = size;
+    entry.mtime = mtime;
+    return schema;
+}
+
+size_t CompiledSchemaCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t dropped = entries_.size();
+    entries_.clear();
+    return dropped;
+}
+
+} // namespace ariane_xml
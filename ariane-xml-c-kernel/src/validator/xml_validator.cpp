@@ -1,12 +1,11 @@
 #include "validator/xml_validator.h"
-#include "generator/xsd_parser.h"
+#include "utils/thread_pool.h"
 #include <pugixml.hpp>
 #include <filesystem>
 #include <glob.h>
 #include <iostream>
-#include <regex>
 #include <algorithm>
-#include <set>
+#include <map>
 #include <cstring>
 
 namespace ariane_xml {
@@ -55,6 +54,56 @@ std::vector<std::string> XmlValidator::expandPattern(const std::string& pattern)
 ValidationResult XmlValidator::validateFile(
     const std::string& xmlFile,
     const std::string& xsdFile
+) {
+    // Parse and compile the XSD schema
+    std::shared_ptr<const CompiledSchema> schema;
+    std::string schemaError;
+    try {
+        schema = CompiledSchema::load(xsdFile);
+    } catch (const std::exception& e) {
+        schemaError = std::string("Failed to parse XSD schema: ") + e.what();
+    }
+
+    return validateWithSchema(xmlFile, schema.get(), schemaError);
+}
+
+std::vector<std::pair<std::string, ValidationResult>> XmlValidator::validateFiles(
+    const std::vector<std::string>& xmlFiles,
+    const std::string& xsdFile,
+    ThreadPool* pool,
+    CompiledSchemaCache* schemas
+) {
+    // Compile the XSD once for the whole batch (the compiled schema is
+    // only read during validation)
+    std::shared_ptr<const CompiledSchema> schema;
+    std::string schemaError;
+    try {
+        schema = schemas ? schemas->load(xsdFile) : CompiledSchema::load(xsdFile);
+    } catch (const std::exception& e) {
+        schemaError = std::string("Failed to parse XSD schema: ") + e.what();
+    }
+
+    std::vector<std::pair<std::string, ValidationResult>> results(xmlFiles.size());
+
+    auto validateOne = [&](size_t i) {
+        results[i] = {xmlFiles[i], validateWithSchema(xmlFiles[i], schema.get(), schemaError)};
+    };
+
+    if (pool) {
+        pool->parallelFor(xmlFiles.size(), validateOne);
+    } else {
+        for (size_t i = 0; i < xmlFiles.size(); ++i) {
+            validateOne(i);
+        }
+    }
+
+    return results;
+}
+
+ValidationResult XmlValidator::validateWithSchema(
+    const std::string& xmlFile,
+    const CompiledSchema* schema,
+    const std::string& schemaError
 ) {
     ValidationResult result;
 
@@ -76,12 +125,8 @@ ValidationResult XmlValidator::validateFile(
         return result;
     }
 
-    // Parse XSD schema
-    std::unique_ptr<XsdSchema> schema;
-    try {
-        schema = XsdParser::parse(xsdFile);
-    } catch (const std::exception& e) {
-        result.addError(std::string("Failed to parse XSD schema: ") + e.what());
+    if (!schema) {
+        result.addError(schemaError);
         return result;
     }
 
@@ -89,28 +134,30 @@ ValidationResult XmlValidator::validateFile(
     return validateAgainstSchema(doc, *schema);
 }
 
-std::vector<std::pair<std::string, ValidationResult>> XmlValidator::validateFiles(
-    const std::vector<std::string>& xmlFiles,
-    const std::string& xsdFile
-) {
-    std::vector<std::pair<std::string, ValidationResult>> results;
-
-    for (const auto& xmlFile : xmlFiles) {
-        ValidationResult result = validateFile(xmlFile, xsdFile);
-        results.push_back({xmlFile, result});
+struct XmlValidator::Walk {
+    const CompiledSchema& schema;
+    ValidationResult& result;
+    std::vector<const char*> path;  // Element names from the document element down
+    std::vector<int> counts;        // Occurrences per particle, for each element being checked
+
+    // XPath-like location of the current element, built only when reported
+    std::string location() const {
+        std::string location;
+        for (const char* name : path) {
+            location += '/';
+            location += name;
+        }
+        return location;
     }
-
-    return results;
-}
+};
 
 ValidationResult XmlValidator::validateAgainstSchema(
     const pugi::xml_document& doc,
-    const XsdSchema& schema
+    const CompiledSchema& schema
 ) {
     ValidationResult result;
 
-    auto rootElement = schema.getRootElement();
-    if (!rootElement) {
+    if (!schema.hasRoot()) {
         result.addError("Schema has no root element defined");
         return result;
     }
@@ -129,9 +176,9 @@ ValidationResult XmlValidator::validateAgainstSchema(
     }
 
     // Check root element name matches
-    if (xmlRoot.name() != rootElement->name) {
+    if (xmlRoot.name() != schema.rootName()) {
         result.addError(
-            "Root element name mismatch. Expected: " + rootElement->name +
+            "Root element name mismatch. Expected: " + schema.rootName() +
             ", Found: " + std::string(xmlRoot.name()),
             "/" + std::string(xmlRoot.name())
         );
@@ -139,45 +186,46 @@ ValidationResult XmlValidator::validateAgainstSchema(
     }
 
     // Validate the root element recursively
-    validateElement(xmlRoot, rootElement, result, "/" + rootElement->name);
+    Walk walk{schema, result, {xmlRoot.name()}, {}};
+    validateElement(xmlRoot, schema.rootType(), walk);
 
     return result;
 }
 
 bool XmlValidator::validateElement(
     const pugi::xml_node& node,
-    const std::shared_ptr<XsdElement>& schemaElement,
-    ValidationResult& result,
-    const std::string& path
+    CompiledSchema::TypeId typeId,
+    Walk& walk
 ) {
     bool valid = true;
+    const CompiledSchema::Type& type = walk.schema.type(typeId);
 
     // Validate attributes
-    if (!validateAttributes(node, schemaElement, result, path)) {
+    if (!validateAttributes(node, type, walk)) {
         valid = false;
     }
 
     // Validate content based on type
-    if (schemaElement->type == XsdType::COMPLEX) {
+    if (type.content == XsdType::COMPLEX) {
         // Validate child elements
-        if (!validateChildren(node, schemaElement, result, path)) {
+        if (!validateChildren(node, type, walk)) {
             valid = false;
         }
     } else {
         // Simple type - validate text content
-        std::string textValue = node.text().as_string();
+        const char* textValue = node.text().as_string();
 
         // Empty text is allowed if element has minOccurs=0
-        if (textValue.empty() && !schemaElement->isOptional()) {
-            result.addError(
+        if (*textValue == '\0' && !type.optional) {
+            walk.result.addError(
                 "Required element is empty",
-                path
+                walk.location()
             );
             valid = false;
-        } else if (!textValue.empty() && !matchesType(textValue, schemaElement->type)) {
-            result.addError(
-                "Value does not match expected type: " + textValue,
-                path
+        } else if (!CompiledSchema::matchesType(textValue, type.content)) {
+            walk.result.addError(
+                "Value does not match expected type: " + std::string(textValue),
+                walk.location()
             );
             valid = false;
         }
@@ -188,51 +236,44 @@ bool XmlValidator::validateElement(
 
 bool XmlValidator::validateAttributes(
     const pugi::xml_node& node,
-    const std::shared_ptr<XsdElement>& schemaElement,
-    ValidationResult& result,
-    const std::string& path
+    const CompiledSchema::Type& type,
+    Walk& walk
 ) {
     bool valid = true;
 
     // Check for required attributes
-    for (const auto& schemaAttr : schemaElement->attributes) {
-        pugi::xml_attribute xmlAttr = node.attribute(schemaAttr->name.c_str());
+    for (uint32_t i = type.attributesBegin; i < type.attributesEnd; ++i) {
+        const CompiledSchema::Attribute& schemaAttr = walk.schema.attribute(i);
+        pugi::xml_attribute xmlAttr = node.attribute(schemaAttr.name.c_str());
 
         if (!xmlAttr) {
-            if (!schemaAttr->isOptional()) {
-                result.addError(
-                    "Missing required attribute: " + schemaAttr->name,
-                    path
+            if (schemaAttr.required) {
+                walk.result.addError(
+                    "Missing required attribute: " + schemaAttr.name,
+                    walk.location()
                 );
                 valid = false;
             }
-        } else {
+        } else if (!CompiledSchema::matchesType(xmlAttr.value(), schemaAttr.type)) {
             // Validate attribute value type
-            std::string attrValue = xmlAttr.value();
-            if (!matchesType(attrValue, schemaAttr->type)) {
-                result.addError(
-                    "Attribute '" + schemaAttr->name +
-                    "' has invalid value type: " + attrValue,
-                    path
-                );
-                valid = false;
-            }
+            walk.result.addError(
+                "Attribute '" + schemaAttr.name +
+                "' has invalid value type: " + xmlAttr.value(),
+                walk.location()
+            );
+            valid = false;
         }
     }
 
     // Check for unexpected attributes (not in schema)
     for (pugi::xml_attribute attr : node.attributes()) {
-        std::string attrName = attr.name();
         bool found = false;
-        for (const auto& schemaAttr : schemaElement->attributes) {
-            if (schemaAttr->name == attrName) {
-                found = true;
-                break;
-            }
+        for (uint32_t i = type.attributesBegin; i < type.attributesEnd && !found; ++i) {
+            found = walk.schema.attribute(i).name == attr.name();
         }
         if (!found) {
-            result.addWarning(
-                "Unexpected attribute '" + attrName + "' at " + path
+            walk.result.addWarning(
+                "Unexpected attribute '" + std::string(attr.name()) + "' at " + walk.location()
             );
         }
     }
@@ -242,139 +283,85 @@ bool XmlValidator::validateAttributes(
 
 bool XmlValidator::validateChildren(
     const pugi::xml_node& node,
-    const std::shared_ptr<XsdElement>& schemaElement,
-    ValidationResult& result,
-    const std::string& path
+    const CompiledSchema::Type& type,
+    Walk& walk
 ) {
     bool valid = true;
-
-    // Count occurrences of each child element
-    std::map<std::string, int> childCounts;
-    for (pugi::xml_node child : node.children()) {
-        if (child.type() == pugi::node_element) {
-            childCounts[child.name()]++;
+    const CompiledSchema& schema = walk.schema;
+
+    // Count occurrences of each child element against its particle; names
+    // the type doesn't declare are tallied apart
+    size_t base = walk.counts.size();
+    walk.counts.resize(base + (type.particlesEnd - type.particlesBegin), 0);
+    std::map<std::string, int> unexpected;
+    for (pugi::xml_node child = node.first_child(); child; child = child.next_sibling()) {
+        if (child.type() != pugi::node_element) {
+            continue;
+        }
+        uint32_t particle = schema.findParticle(type, schema.nameId(child.name()));
+        if (particle != CompiledSchema::NONE) {
+            ++walk.counts[base + particle - type.particlesBegin];
+        } else {
+            ++unexpected[child.name()];
         }
     }
 
     // Validate each schema child element
-    for (const auto& schemaChild : schemaElement->children) {
-        int count = childCounts[schemaChild->name];
+    for (uint32_t i = type.particlesBegin; i < type.particlesEnd; ++i) {
+        const CompiledSchema::Particle& particle = schema.particle(i);
+        int count = particle.firstOfName ? walk.counts[base + i - type.particlesBegin] : 0;
 
         // Check minOccurs
-        if (count < schemaChild->minOccurs) {
-            result.addError(
-                "Element '" + schemaChild->name + "' appears " +
+        if (count < particle.minOccurs) {
+            walk.result.addError(
+                "Element '" + schema.name(particle.name) + "' appears " +
                 std::to_string(count) + " times, but minOccurs is " +
-                std::to_string(schemaChild->minOccurs),
-                path
+                std::to_string(particle.minOccurs),
+                walk.location()
             );
             valid = false;
         }
 
         // Check maxOccurs (if not unbounded)
-        if (schemaChild->maxOccurs != -1 && count > schemaChild->maxOccurs) {
-            result.addError(
-                "Element '" + schemaChild->name + "' appears " +
+        if (particle.maxOccurs != -1 && count > particle.maxOccurs) {
+            walk.result.addError(
+                "Element '" + schema.name(particle.name) + "' appears " +
                 std::to_string(count) + " times, but maxOccurs is " +
-                std::to_string(schemaChild->maxOccurs),
-                path
+                std::to_string(particle.maxOccurs),
+                walk.location()
             );
             valid = false;
         }
-
-        // Mark as validated
-        childCounts.erase(schemaChild->name);
     }
+    walk.counts.resize(base);
 
     // Check for unexpected child elements
-    for (const auto& [childName, count] : childCounts) {
-        result.addWarning(
+    for (const auto& [childName, count] : unexpected) {
+        walk.result.addWarning(
             "Unexpected element '" + childName + "' (appears " +
-            std::to_string(count) + " times) at " + path
+            std::to_string(count) + " times) at " + walk.location()
         );
     }
 
     // Recursively validate each child element
-    for (pugi::xml_node child : node.children()) {
+    for (pugi::xml_node child = node.first_child(); child; child = child.next_sibling()) {
         if (child.type() != pugi::node_element) {
             continue;
         }
 
-        std::string childName = child.name();
-        std::string childPath = path + "/" + childName;
-
-        // Find matching schema element
-        std::shared_ptr<XsdElement> matchingSchema;
-        for (const auto& schemaChild : schemaElement->children) {
-            if (schemaChild->name == childName) {
-                matchingSchema = schemaChild;
-                break;
-            }
+        uint32_t particle = schema.findParticle(type, schema.nameId(child.name()));
+        if (particle == CompiledSchema::NONE) {
+            continue;  // Already reported as unexpected element
         }
 
-        if (matchingSchema) {
-            if (!validateElement(child, matchingSchema, result, childPath)) {
-                valid = false;
-            }
+        walk.path.push_back(child.name());
+        if (!validateElement(child, schema.particle(particle).type, walk)) {
+            valid = false;
         }
-        // else: already reported as unexpected element
+        walk.path.pop_back();
     }
 
     return valid;
 }
 
-bool XmlValidator::matchesType(const std::string& value, XsdType type) {
-    if (value.empty()) {
-        return true; // Empty values are checked separately
-    }
-
-    switch (type) {
-        case XsdType::STRING:
-            return true; // Any string is valid
-
-        case XsdType::INTEGER: {
-            try {
-                size_t pos;
-                std::stoll(value, &pos);
-                return pos == value.length();
-            } catch (...) {
-                return false;
-            }
-        }
-
-        case XsdType::DECIMAL: {
-            try {
-                size_t pos;
-                std::stod(value, &pos);
-                return pos == value.length();
-            } catch (...) {
-                return false;
-            }
-        }
-
-        case XsdType::BOOLEAN: {
-            return value == "true" || value == "false" ||
-                   value == "1" || value == "0";
-        }
-
-        case XsdType::DATE: {
-            // Basic ISO date format: YYYY-MM-DD
-            std::regex datePattern(R"(\d{4}-\d{2}-\d{2})");
-            return std::regex_match(value, datePattern);
-        }
-
-        case XsdType::DATETIME: {
-            // Basic ISO datetime format: YYYY-MM-DDTHH:MM:SS
-            std::regex datetimePattern(R"(\d{4}-\d{2}-\d{2}T\d{2}:\d{2}:\d{2})");
-            return std::regex_match(value, datetimePattern);
-        }
-
-        case XsdType::COMPLEX:
-            return true; // Complex types are validated structurally
-
-        default:
-            return true;
-    }
-}
-
 } // namespace ariane_xml
@@ -0,0 +1,128 @@
+// Build-time generator for the bundled DSN schema tables (see
+// dsn/dsn_schema_tables.h): parses each schema directory with DsnParser and
+// writes the attributes, with a fingerprint of every XSD they came from,
+// as static C++ tables.
+//
+// Run by the build:
+//   dsn-schema-gen <output.cpp> [<version> <schema dir>]...
+
+#include "dsn/dsn_parser.h"
+#include "dsn/dsn_schema_tables.h"
+#include "utils/thread_pool.h"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace ariane_xml;
+
+namespace {
+
+// C++ string literal; bytes outside printable ASCII as octal escapes
+std::string literal(std::string_view text) {
+    std::string out = "\"";
+    for (unsigned char c : text) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += static_cast<char>(c);
+        } else if (c < 0x20 || c >= 0x7f || c == '?') {
+            char buf[5];
+            snprintf(buf, sizeof(buf), "\\%03o", c);
+            out += buf;
+        } else {
+            out += static_cast<char>(c);
+        }
+    }
+    return out + '"';
+}
+
+bool writeSchema(std::ostream& out, size_t index, const std::string& version,
+                 const std::string& schemaDir, std::ostream& entries, ThreadPool& pool) {
+    std::vector<std::filesystem::path> xsds;
+    for (const auto& entry : std::filesystem::directory_iterator(schemaDir)) {
+        if (entry.path().extension() == ".xsd") {
+            xsds.push_back(entry.path());
+        }
+    }
+    std::sort(xsds.begin(), xsds.end());
+
+    auto schema = DsnParser::parseDirectory(schemaDir, version, &pool);
+    if (xsds.empty() || schema->attributeCount() == 0) {
+        std::cerr << "dsn-schema-gen: no DSN attributes in " << schemaDir << std::endl;
+        return false;
+    }
+    if (schema->blocCount() != 0) {
+        std::cerr << "dsn-schema-gen: bloc tables are not supported (" << schemaDir << ")" << std::endl;
+        return false;
+    }
+
+    out << "\n// " << version << ": " << std::filesystem::path(schemaDir).filename().string() << "\n";
+    out << "const DsnSourceFile FILES_" << index << "[] = {\n";
+    for (const auto& path : xsds) {
+        std::ifstream file(path, std::ios::binary);
+        std::string contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        out << "    {" << literal(path.filename().string()) << ", " << contents.size() << "ULL, "
+            << hashDsnSchemaFile(contents) << "ULL},\n";
+    }
+    out << "};\n\n";
+
+    // In attribute id order: adding them in this order rebuilds the same
+    // table, chains and indices
+    out << "const DsnAttributeRecord ATTRIBUTES_" << index << "[] = {\n";
+    size_t count = schema->attributeCount();
+    for (DsnSchema::AttributeId id = 0; id < count; ++id) {
+        DsnAttribute attr = schema->attribute(id);
+        out << "    {" << literal(attr.full_name) << ", " << literal(attr.short_id) << ", "
+            << literal(attr.bloc_name) << ", " << literal(attr.bloc_label) << ",\n"
+            << "     " << literal(attr.description) << ",\n"
+            << "     " << literal(attr.type) << ", " << attr.min_occurs << ", "
+            << attr.max_occurs << ", " << (attr.mandatory ? "true" : "false") << "},\n";
+    }
+    out << "};\n";
+
+    entries << "    {" << literal(version) << ", FILES_" << index << ", " << xsds.size()
+            << ", ATTRIBUTES_" << index << ", " << count << "},\n";
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2 || argc % 2 != 0) {
+        std::cerr << "Usage: " << argv[0] << " <output.cpp> [<version> <schema dir>]..." << std::endl;
+        return 1;
+    }
+
+    ThreadPool pool;
+    std::ostringstream out;
+    std::ostringstream entries;
+    out << "// Generated by dsn-schema-gen from the bundled DSN schemas. Do not edit.\n\n"
+        << "#include \"dsn/dsn_schema_tables.h\"\n\n"
+        << "namespace ariane_xml {\n\n"
+        << "namespace {\n";
+    for (int i = 2; i + 1 < argc; i += 2) {
+        if (!writeSchema(out, i / 2 - 1, argv[i], argv[i + 1], entries, pool)) {
+            return 1;
+        }
+    }
+    out << "\n} // namespace\n\n"
+        << "const DsnSchemaTables BUNDLED_DSN_SCHEMAS[] = {\n"
+        << entries.str()
+        << "    {nullptr, nullptr, 0, nullptr, 0},\n"
+        << "};\n\n"
+        << "} // namespace ariane_xml\n";
+
+    std::ofstream file(argv[1], std::ios::binary);
+    file << out.str();
+    if (!file) {
+        std::cerr << "dsn-schema-gen: cannot write " << argv[1] << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -10,12 +10,14 @@ from ipykernel.kernelbase import Kernel
 import subprocess
 import re
 import os
+import sys
 import time
 import json
 import io
 import csv
 import base64
 from typing import Dict, Any, List, Optional, Tuple
+from .query_server import QueryServerClient, QueryServerUnavailable
 
 # Phase 3: Import pandas and ipywidgets for advanced features
 try:
@@ -120,6 +122,10 @@ Welcome! Query XML files using familiar SQL syntax with rich HTML output.
         self.last_query_result = None  # Store last result for export
         self.current_progress_widget = None  # For progress indicators
 
+        # Long-lived ariane-xml --server keeping the session warm between
+        # cells; None once it proved unavailable (one process per query then)
+        self.query_server = QueryServerClient(self.ariane_xml_path, self.working_directory)
+
     def _find_ariane_xml(self) -> str:
         """Locate the Ariane-XML executable"""
         # In Docker, check the build directory first
@@ -1805,6 +1811,14 @@ Welcome! Query XML files using familiar SQL syntax with rich HTML output.
             if not query:
                 return {'success': True, 'output': '', 'error': None}
 
+            if self.query_server is not None:
+                try:
+                    return self._execute_query_on_server(query)
+                except QueryServerUnavailable as e:
+                    print(f"[Ariane-XML Kernel] Query server unavailable ({e}), "
+                          "running one process per query", file=sys.stderr)
+                    self.query_server = None
+
             result = subprocess.run(
                 [self.ariane_xml_path, query],
                 capture_output=True,
@@ -1826,7 +1840,7 @@ Welcome! Query XML files using familiar SQL syntax with rich HTML output.
                     'error': result.stderr or f"Ariane-XML exited with code {result.returncode}"
                 }
 
-        except subprocess.TimeoutExpired:
+        except (subprocess.TimeoutExpired, TimeoutError):
             return {
                 'success': False,
                 'output': '',
@@ -1848,6 +1862,44 @@ Welcome! Query XML files using familiar SQL syntax with rich HTML output.
                 'error': f'Unexpected error: {str(e)}'
             }
 
+    def _execute_query_on_server(self, query: str) -> Dict[str, Any]:
+        """Execute a query on the long-lived ariane-xml server"""
+        try:
+            response = self.query_server.call('execute', {'query': query}, timeout=30)
+        finally:
+            notice = self.query_server.take_restart_notice()
+            if notice:
+                self.send_response(
+                    self.iopub_socket,
+                    'stream',
+                    {
+                        'name': 'stderr',
+                        'text': f'{notice}\n'
+                    }
+                )
+
+        if 'result' in response:
+            return {
+                'success': True,
+                'output': response['result'].get('output', ''),
+                'error': None
+            }
+
+        # Same output and error text the command line would have produced
+        error = response.get('error') or {}
+        data = error.get('data') or {}
+        return {
+            'success': False,
+            'output': data.get('output', ''),
+            'error': data.get('stderr') or error.get('message') or 'Ariane-XML query failed'
+        }
+
+    def do_shutdown(self, restart: bool) -> Dict[str, Any]:
+        """Stop the query server with the kernel"""
+        if self.query_server is not None:
+            self.query_server.close()
+        return {'status': 'ok', 'restart': restart}
+
     def _format_dsn_describe_output(self, output: str) -> str:
         """Format DESCRIBE command output with enhanced styling"""
         lines = output.strip().split('\n')
@@ -3273,6 +3325,69 @@ Welcome! Query XML files using familiar SQL syntax with rich HTML output.
 
         return code[start:cursor_pos]
 
+    def _fetch_completions(self, code: str, cursor_pos: int) -> Optional[List[Dict[str, Any]]]:
+        """
+        Suggestions from the C++ autocompletion, or None when it failed.
+
+        Asks the query server first, which keeps each DSN schema loaded
+        between keystrokes; falls back to one `--autocomplete` process per
+        request (parsing the schema every time) when the server is not
+        available or too old to know the 'complete' method.
+        """
+        version = self.dsn_version or 'AUTO'
+
+        if self.query_server is not None:
+            try:
+                response = self.query_server.call(
+                    'complete',
+                    {'code': code, 'cursor_pos': cursor_pos, 'version': version},
+                    timeout=2,  # Quick timeout for responsiveness
+                    keep_on_timeout=True  # The server holds the execute session
+                )
+                if 'result' in response:
+                    return response['result']
+            except TimeoutError:
+                return None
+            except QueryServerUnavailable as e:
+                print(f"[Ariane-XML Kernel] Query server unavailable ({e}), "
+                      "running one process per query", file=sys.stderr)
+                self.query_server = None
+
+        # Build command for C++ autocomplete
+        cmd = [
+            self.ariane_xml_path,
+            '--autocomplete',
+            code,
+            str(cursor_pos)
+        ]
+
+        # Add version parameter if DSN version is set
+        if self.dsn_version:
+            cmd.extend(['--version', self.dsn_version])
+
+        # Call C++ autocomplete via subprocess
+        result = subprocess.run(
+            cmd,
+            capture_output=True,
+            text=True,
+            timeout=2,  # Quick timeout for responsiveness
+            cwd=self.working_directory
+        )
+
+        if result.returncode != 0:
+            # Autocomplete failed
+            # Log error for debugging (visible in Jupyter logs)
+            if result.stderr:
+                print(f"Autocomplete error: {result.stderr}", file=sys.stderr)
+            return None
+
+        # Parse JSON response from C++
+        try:
+            return json.loads(result.stdout)
+        except json.JSONDecodeError as e:
+            print(f"Autocomplete JSON error: {e}\nOutput: {result.stdout}", file=sys.stderr)
+            return None
+
     def do_complete(self, code: str, cursor_pos: int) -> Dict[str, Any]:
         """
         Handle code completion requests from Jupyter.
@@ -3301,32 +3416,8 @@ Welcome! Query XML files using familiar SQL syntax with rich HTML output.
             }
 
         try:
-            # Build command for C++ autocomplete
-            cmd = [
-                self.ariane_xml_path,
-                '--autocomplete',
-                code,
-                str(cursor_pos)
-            ]
-
-            # Add version parameter if DSN version is set
-            if self.dsn_version:
-                cmd.extend(['--version', self.dsn_version])
-
-            # Call C++ autocomplete via subprocess
-            result = subprocess.run(
-                cmd,
-                capture_output=True,
-                text=True,
-                timeout=2,  # Quick timeout for responsiveness
-                cwd=self.working_directory
-            )
-
-            if result.returncode != 0:
-                # Autocomplete failed, return empty
-                # Log error for debugging (visible in Jupyter logs)
-                if result.stderr:
-                    print(f"Autocomplete error: {result.stderr}", file=__import__('sys').stderr)
+            suggestions = self._fetch_completions(code, cursor_pos)
+            if suggestions is None:
                 return {
                     'matches': [],
                     'cursor_start': cursor_pos,
@@ -3335,9 +3426,6 @@ Welcome! Query XML files using familiar SQL syntax with rich HTML output.
                     'status': 'ok'
                 }
 
-            # Parse JSON response from C++
-            suggestions = json.loads(result.stdout)
-
             # Extract completion strings
             matches = [s['completion'] for s in suggestions]
 
@@ -3368,7 +3456,7 @@ Welcome! Query XML files using familiar SQL syntax with rich HTML output.
                 'status': 'ok'
             }
 
-        except subprocess.TimeoutExpired:
+        except (subprocess.TimeoutExpired, TimeoutError):
             # Timeout - return empty completions
             return {
                 'matches': [],
@@ -3379,7 +3467,7 @@ Welcome! Query XML files using familiar SQL syntax with rich HTML output.
             }
         except json.JSONDecodeError as e:
             # JSON parsing error - log and return empty
-            print(f"Autocomplete JSON error: {e}\nOutput: {result.stdout}", file=__import__('sys').stderr)
+            print(f"Autocomplete JSON error: {e}", file=sys.stderr)
             return {
                 'matches': [],
                 'cursor_start': cursor_pos,
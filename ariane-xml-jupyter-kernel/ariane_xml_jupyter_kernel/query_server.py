@@ -0,0 +1,178 @@
+"""
+Ariane-XML Query Server Client
+
+Keeps one `ariane-xml --server` process alive for the kernel session and
+sends it newline-delimited JSON-RPC 2.0 requests over its stdin/stdout.
+The server keeps its session (mode, XSD and DSN schema, document cache)
+between requests, so a cell no longer pays process startup or schema
+parsing.
+"""
+
+import json
+import os
+import selectors
+import subprocess
+import time
+from typing import Any, Dict, List, Optional
+
+
+class QueryServerUnavailable(Exception):
+    """The server could not be started or stopped answering"""
+
+
+class QueryServerClient:
+    """
+    Client for a lazily started `ariane-xml --server` process
+
+    Usage:
+        client = QueryServerClient('/path/to/ariane-xml', cwd)
+        response = client.call('execute', {'query': 'SELECT ...'}, timeout=30)
+        # response holds either 'result' or 'error' (JSON-RPC 2.0)
+        client.close()
+
+    A server that dies or times out is discarded; the next call starts a
+    fresh one and replays the SET statements the old one accepted, so mode,
+    XSD, DEST and cache settings carry over. The document cache and the
+    loaded schemas don't. take_restart_notice() tells the caller it happened.
+    """
+
+    def __init__(self, executable: str, cwd: Optional[str] = None):
+        self.executable = executable
+        self.cwd = cwd
+        self._process: Optional[subprocess.Popen] = None
+        self._buffer = b''
+        self._next_id = 1
+        self._abandoned = set()  # Ids of requests whose late responses are skipped
+        self._session: List[str] = []  # Accepted SET statements, last one per setting
+        self._started_before = False
+        self._restart_notice: Optional[str] = None
+
+    def _start(self):
+        try:
+            self._process = subprocess.Popen(
+                [self.executable, '--server'],
+                stdin=subprocess.PIPE,
+                stdout=subprocess.PIPE,
+                stderr=subprocess.DEVNULL,
+                cwd=self.cwd,
+                bufsize=0
+            )
+        except OSError as e:
+            raise QueryServerUnavailable(str(e))
+        self._buffer = b''
+        self._abandoned.clear()
+
+        if not self._started_before:
+            self._started_before = True
+            return
+
+        # A replacement: bring its session back to where the old one was
+        for statement in list(self._session):
+            self._request('execute', {'query': statement}, timeout=30)
+        replayed = ''.join(f'\n  {statement}' for statement in self._session)
+        self._restart_notice = (
+            'The ariane-xml server was restarted and its session reset.'
+            + (f' Replayed:{replayed}' if replayed else '')
+        )
+
+    def _discard(self):
+        if self._process is not None:
+            try:
+                self._process.kill()
+                self._process.wait(timeout=1)
+            except Exception:
+                pass
+        self._process = None
+        self._buffer = b''
+
+    def _read_line(self, deadline: float) -> bytes:
+        """Read one response line before the deadline"""
+        with selectors.DefaultSelector() as selector:
+            selector.register(self._process.stdout, selectors.EVENT_READ)
+            while b'\n' not in self._buffer:
+                remaining = deadline - time.monotonic()
+                if remaining <= 0 or not selector.select(remaining):
+                    raise TimeoutError()
+                chunk = os.read(self._process.stdout.fileno(), 65536)
+                if not chunk:
+                    raise QueryServerUnavailable('ariane-xml server exited')
+                self._buffer += chunk
+        line, _, self._buffer = self._buffer.partition(b'\n')
+        return line
+
+    def call(self, method: str, params: Optional[Dict[str, Any]] = None,
+             timeout: float = 30, keep_on_timeout: bool = False) -> Dict[str, Any]:
+        """
+        Send one request and wait for its response
+
+        Raises TimeoutError when no answer arrives in time, and
+        QueryServerUnavailable when the server can't be started or exits,
+        e.g. an older ariane-xml without --server. A timeout stops the
+        server, unless 'keep_on_timeout': then only this request is given
+        up and the server answers the next one once it is done with it.
+        """
+        if self._process is None or self._process.poll() is not None:
+            self._discard()
+            self._start()
+
+        response = self._request(method, params, timeout, keep_on_timeout)
+        if method == 'execute' and 'result' in response:
+            self._remember((params or {}).get('query', ''))
+        return response
+
+    def take_restart_notice(self) -> Optional[str]:
+        """Message about the last server restart, once; None if there was none"""
+        notice, self._restart_notice = self._restart_notice, None
+        return notice
+
+    def _request(self, method: str, params: Optional[Dict[str, Any]], timeout: float,
+                 keep_on_timeout: bool = False) -> Dict[str, Any]:
+        request_id = self._next_id
+        self._next_id += 1
+        request = {'jsonrpc': '2.0', 'id': request_id, 'method': method, 'params': params or {}}
+
+        deadline = time.monotonic() + timeout
+        try:
+            self._process.stdin.write((json.dumps(request) + '\n').encode('utf-8'))
+            while True:
+                line = self._read_line(deadline)
+                response = json.loads(line.decode('utf-8', errors='replace'))
+                if response.get('id') not in self._abandoned:
+                    break
+                self._abandoned.discard(response.get('id'))
+        except TimeoutError:
+            if keep_on_timeout:
+                self._abandoned.add(request_id)
+            else:
+                self._discard()
+            raise
+        except (OSError, ValueError, QueryServerUnavailable) as e:
+            self._discard()
+            raise QueryServerUnavailable(str(e))
+
+        if response.get('id') != request_id:
+            self._discard()
+            raise QueryServerUnavailable('Unexpected response from ariane-xml server')
+        return response
+
+    def _remember(self, query: str):
+        """Keep a SET statement for replay, replacing an earlier one for the same setting"""
+        words = query.split()
+        if len(words) < 2 or words[0].upper() != 'SET':
+            return
+        setting = words[1].upper()
+        self._session = [statement for statement in self._session
+                         if statement.split()[1].upper() != setting]
+        self._session.append(query.strip())
+
+    def close(self):
+        """Ask the server to stop, killing it if it doesn't"""
+        if self._process is None:
+            return
+        if self._process.poll() is None:
+            try:
+                self.call('shutdown', timeout=2)
+                self._process.wait(timeout=2)
+            except Exception:
+                pass
+        self._discard()
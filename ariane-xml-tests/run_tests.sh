@@ -173,6 +173,31 @@ run_test "ORDER-004" \
     'SELECT .title FROM "ariane-xml-tests/data/books1.xml" ORDER BY price DESC;' \
     "Learning Programming"
 
+run_test "ORDER-005" \
+    "ORDER BY two keys, second breaks ties" \
+    'SELECT i.label FROM "ariane-xml-tests/data/sort_keys.xml" FOR i IN .item ORDER BY code, rank DESC LIMIT 1;' \
+    "Apple"
+
+run_test "ORDER-006" \
+    "ORDER BY puts empty values first" \
+    'SELECT i.label FROM "ariane-xml-tests/data/sort_keys.xml" FOR i IN .item ORDER BY rank LIMIT 1;' \
+    "Delta"
+
+run_test "ORDER-007" \
+    "ORDER BY compares numbers numerically" \
+    'SELECT i.label FROM "ariane-xml-tests/data/sort_keys.xml" FOR i IN .item ORDER BY rank LIMIT 1 OFFSET 1;' \
+    "Alpha"
+
+run_test "ORDER-008" \
+    "ORDER BY DESC puts text before numbers" \
+    'SELECT i.label FROM "ariane-xml-tests/data/sort_keys.xml" FOR i IN .item ORDER BY rank DESC LIMIT 1;' \
+    "Gamma"
+
+run_test "ORDER-009" \
+    "ORDER BY keeps file order for ties" \
+    'SELECT i.label FROM "ariane-xml-tests/data/sort_keys.xml" FOR i IN .item ORDER BY rank LIMIT 1 OFFSET 3;' \
+    "Apple"
+
 run_test "LIMIT-001" \
     "LIMIT results" \
     'SELECT .book.title FROM "ariane-xml-tests/data/books1.xml" LIMIT 1;' \
@@ -364,9 +389,64 @@ run_test "IN-010" \
     "The Great Adventure"
 
 # ============================================================================
-# CATEGORY 9: Configuration Commands
+# CATEGORY 9: GROUP BY and HAVING
+# ============================================================================
+print_category "9. GROUP BY and HAVING"
+
+run_test "GRP-001" \
+    "GROUP BY with COUNT" \
+    'SELECT dept.name, COUNT(emp) FROM "ariane-xml-tests/data/company.xml" FOR dept IN .department FOR emp IN dept.employee GROUP BY dept.name;' \
+    "Sales +\| 2"
+
+run_test "GRP-002" \
+    "GROUP BY with AVG" \
+    'SELECT dept.name, AVG(emp.salary) FROM "ariane-xml-tests/data/company.xml" FOR dept IN .department FOR emp IN dept.employee GROUP BY dept.name;' \
+    "Engineering +\| 85000"
+
+run_test "GRP-003" \
+    "Aggregate without GROUP BY" \
+    'SELECT SUM(.employee.salary) FROM "ariane-xml-tests/data/company.xml";' \
+    "315000"
+
+run_test "GRP-004" \
+    "HAVING on GROUP BY field path" \
+    'SELECT dept.name, COUNT(emp) FROM "ariane-xml-tests/data/company.xml" FOR dept IN .department FOR emp IN dept.employee GROUP BY dept.name HAVING dept.name = "Sales";' \
+    "1 row returned"
+
+run_test "GRP-005" \
+    "HAVING on GROUP BY field name" \
+    'SELECT dept.name, COUNT(emp) FROM "ariane-xml-tests/data/company.xml" FOR dept IN .department FOR emp IN dept.employee GROUP BY dept.name HAVING name = "Sales";' \
+    "1 row returned"
+
+run_test "GRP-006" \
+    "HAVING on GROUP BY field not selected" \
+    'SELECT COUNT(emp) FROM "ariane-xml-tests/data/company.xml" FOR dept IN .department FOR emp IN dept.employee GROUP BY dept.name HAVING dept.name = "Sales";' \
+    "1 row returned"
+
+run_test "GRP-007" \
+    "HAVING on aggregate" \
+    'SELECT dept.name, AVG(emp.salary) FROM "ariane-xml-tests/data/company.xml" FOR dept IN .department FOR emp IN dept.employee GROUP BY dept.name HAVING AVG(emp.salary) > 80000;' \
+    "1 row returned"
+
+run_test "GRP-008" \
+    "HAVING on alias" \
+    'SELECT dept.name, COUNT(emp) AS n FROM "ariane-xml-tests/data/company.xml" FOR dept IN .department FOR emp IN dept.employee GROUP BY dept.name HAVING n >= 2;' \
+    "2 rows returned"
+
+run_test "GRP-009" \
+    "HAVING rejecting every group" \
+    'SELECT dept.name, COUNT(emp), AVG(emp.salary) FROM "ariane-xml-tests/data/company.xml" FOR dept IN .department FOR emp IN dept.employee GROUP BY dept.name HAVING COUNT(emp) > 2;' \
+    "No results found"
+
+run_test "GRP-010" \
+    "HAVING with AND" \
+    'SELECT dept.name, COUNT(emp) FROM "ariane-xml-tests/data/company.xml" FOR dept IN .department FOR emp IN dept.employee GROUP BY dept.name HAVING dept.name = "Sales" AND COUNT(emp) = 2;' \
+    "1 row returned"
+
+# ============================================================================
+# CATEGORY 10: Configuration Commands
 # ============================================================================
-print_category "9. Configuration Commands"
+print_category "10. Configuration Commands"
 
 run_test "CONFIG-001" \
     "SET XSD command" \
@@ -389,9 +469,9 @@ run_test "CONFIG-004" \
     "ariane-xml-tests/output"
 
 # ============================================================================
-# CATEGORY 10: XML Generation
+# CATEGORY 11: XML Generation
 # ============================================================================
-print_category "10. XML Generation"
+print_category "11. XML Generation"
 
 run_test "GEN-001" \
     "Generate XML files" \
@@ -407,9 +487,9 @@ run_test "GEN-002" \
 rm -f ariane-xml-tests/output/generated_*.xml ariane-xml-tests/output/test_*.xml 2>/dev/null
 
 # ============================================================================
-# CATEGORY 11: XML Validation (CHECK Command)
+# CATEGORY 12: XML Validation (CHECK Command)
 # ============================================================================
-print_category "11. XML Validation"
+print_category "12. XML Validation"
 
 run_test "CHECK-001" \
     "Validate single file" \
@@ -427,9 +507,9 @@ run_test "CHECK-003" \
     "Summary:.*valid"
 
 # ============================================================================
-# CATEGORY 12: Error Handling
+# CATEGORY 13: Error Handling
 # ============================================================================
-print_category "12. Error Handling"
+print_category "13. Error Handling"
 
 run_test "ERR-001" \
     "Invalid query syntax" \
@@ -447,9 +527,9 @@ run_test "ERR-003" \
     "XSD path not set"
 
 # ============================================================================
-# CATEGORY 11: VERBOSE Mode - Ambiguity Detection
+# CATEGORY 14: VERBOSE Mode - Ambiguity Detection
 # ============================================================================
-print_category "11. VERBOSE Mode - Ambiguity Detection"
+print_category "14. VERBOSE Mode - Ambiguity Detection"
 
 run_test "VERB-001" \
     "Detect ambiguous attribute" \
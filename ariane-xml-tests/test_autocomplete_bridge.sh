@@ -2,8 +2,6 @@
 # Test script for C++ autocomplete bridge functionality
 # Tests the --autocomplete mode that provides suggestions to Jupyter kernel
 
-set -e  # Exit on error
-
 # Color codes for output
 GREEN='\033[0;32m'
 RED='\033[0;31m'
@@ -49,19 +47,19 @@ run_test() {
     if ! echo "$result" | python3 -m json.tool > /dev/null 2>&1; then
         echo -e "${RED}✗ FAILED${NC} - Invalid JSON output"
         echo "  Output: $result"
-        ((TESTS_FAILED++))
+        TESTS_FAILED=$((TESTS_FAILED + 1))
         return 1
     fi
 
     # Check if output contains expected pattern
     if echo "$result" | grep -q "$expected_pattern"; then
         echo -e "${GREEN}✓ PASSED${NC}"
-        ((TESTS_PASSED++))
+        TESTS_PASSED=$((TESTS_PASSED + 1))
         return 0
     else
         echo -e "${RED}✗ FAILED${NC} - Expected pattern not found: $expected_pattern"
         echo "  Output: $result"
-        ((TESTS_FAILED++))
+        TESTS_FAILED=$((TESTS_FAILED + 1))
         return 1
     fi
 }
@@ -80,12 +78,12 @@ run_empty_test() {
     # Check if it returned empty array
     if [ "$result" = "[]" ]; then
         echo -e "${GREEN}✓ PASSED${NC}"
-        ((TESTS_PASSED++))
+        TESTS_PASSED=$((TESTS_PASSED + 1))
         return 0
     else
         echo -e "${RED}✗ FAILED${NC} - Expected empty array"
         echo "  Output: $result"
-        ((TESTS_FAILED++))
+        TESTS_FAILED=$((TESTS_FAILED + 1))
         return 1
     fi
 }
@@ -129,11 +127,11 @@ except:
     sys.exit(1)
 " 2>&1 | grep -q "OK"; then
     echo -e "${GREEN}✓ PASSED${NC}"
-    ((TESTS_PASSED++))
+    TESTS_PASSED=$((TESTS_PASSED + 1))
 else
     echo -e "${RED}✗ FAILED${NC} - Missing required JSON fields"
     echo "  Output: $result"
-    ((TESTS_FAILED++))
+    TESTS_FAILED=$((TESTS_FAILED + 1))
 fi
 
 # Test 7: Check suggestion type values
@@ -155,18 +153,30 @@ except:
     sys.exit(1)
 " 2>&1 | grep -q "OK"; then
     echo -e "${GREEN}✓ PASSED${NC}"
-    ((TESTS_PASSED++))
+    TESTS_PASSED=$((TESTS_PASSED + 1))
 else
     echo -e "${RED}✗ FAILED${NC} - Invalid suggestion type"
     echo "  Output: $result"
-    ((TESTS_FAILED++))
+    TESTS_FAILED=$((TESTS_FAILED + 1))
 fi
 
 # Test 8: Mid-query completion
 run_test "Mid-query completion" "SELECT S21_G00_ FROM file.xml" 15 "S21_G00"
 
 # Test 9: WHERE clause completion
-run_test "WHERE clause field completion" "SELECT * FROM file.xml WHERE 30_" 33 "30_"
+run_test "WHERE clause field completion" "SELECT * FROM file.xml WHERE 30_" 32 "30_"
+
+# Test 10: Descriptions come from the schema
+run_test "Field description filled" "SELECT S21_G00_06_00" 20 '"description":"SIREN"'
+
+# Test 11: A word of the description finds the field
+run_test "Description word (salaire)" "SELECT salaire" 14 '"completion":"S21_G00_62_006"'
+
+# Test 12: Accents are ignored when matching descriptions
+run_test "Accent folding (numero)" "SELECT numero" 13 '"description":"Numéro'
+
+# Test 13: A one-edit typo still finds the field, ranked first
+run_test "Typo completion (S21_G00_3O_001)" "SELECT S21_G00_3O_001" 21 '^\[{"completion":"S21_G00_30_001"'
 
 echo ""
 echo "====================================="
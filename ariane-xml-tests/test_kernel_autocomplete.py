@@ -25,6 +25,8 @@ class TestKernelAutocomplete(unittest.TestCase):
         # Enable DSN mode for tests
         self.kernel.dsn_mode = True
         self.kernel.dsn_version = 'AUTO'
+        # Test the one-process-per-request path that subprocess.run is mocked for
+        self.kernel.query_server = None
 
     def test_get_partial_word_simple(self):
         """Test _get_partial_word with simple input"""
@@ -236,6 +238,28 @@ class TestIntegrationAutocomplete(unittest.TestCase):
         if result['matches']:
             self.assertIn('SELECT', result['matches'])
 
+    def test_autocomplete_integration_description_word(self):
+        """Test a word of the field description finds the field"""
+        result = self.kernel.do_complete("SELECT salaire", 14)
+
+        self.assertEqual(result['status'], 'ok')
+        self.assertIn('S21_G00_62_006', result['matches'])
+        self.assertEqual(result['cursor_start'], 7)
+
+    def test_autocomplete_integration_accent_folding(self):
+        """Test 'numero' matches descriptions spelled 'Numéro'"""
+        result = self.kernel.do_complete("SELECT numero", 13)
+
+        self.assertEqual(result['status'], 'ok')
+        self.assertIn('S10_G00_00_003', result['matches'])  # Numéro de version du logiciel utilisé
+
+    def test_autocomplete_integration_typo(self):
+        """Test a field name with one wrong character is still suggested first"""
+        result = self.kernel.do_complete("SELECT S21_G00_3O_001", 21)
+
+        self.assertEqual(result['status'], 'ok')
+        self.assertEqual(result['matches'][0], 'S21_G00_30_001')
+
 
 def run_tests():
     """Run all tests"""
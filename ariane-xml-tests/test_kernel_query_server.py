@@ -0,0 +1,242 @@
+#!/usr/bin/env python3
+"""
+Unit tests for the kernel's query server client
+Tests the `ariane-xml --server` JSON-RPC protocol, timeouts, and the session
+replay when a server has to be restarted
+"""
+
+import sys
+import os
+import shutil
+import tempfile
+import textwrap
+import unittest
+from unittest.mock import Mock
+
+# Add parent directory to path to import kernel
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), '..', 'ariane-xml-jupyter-kernel'))
+
+from ariane_xml_jupyter_kernel.kernel import ArianeXMLKernel
+from ariane_xml_jupyter_kernel.query_server import QueryServerClient, QueryServerUnavailable
+
+
+# Stand-in for `ariane-xml --server`: answers one JSON-RPC request per line.
+# 'SLEEP <s>' and completions of 'slow' take their time; 'SHOW SESSION'
+# lists the SET statements this process has seen.
+FAKE_SERVER = textwrap.dedent('''
+    import json, os, sys, time
+    session = []
+    for line in sys.stdin:
+        request = json.loads(line)
+        method = request['method']
+        params = request.get('params', {})
+        result = None
+        if method == 'execute':
+            query = params['query']
+            if query.startswith('SLEEP '):
+                time.sleep(float(query.split()[1]))
+            elif query.upper().startswith('SET '):
+                session.append(query)
+            output = '|'.join(session) if query == 'SHOW SESSION' else query
+            result = {'output': output, 'pid': os.getpid()}
+        elif method == 'complete':
+            if params['code'] == 'slow':
+                time.sleep(1.5)
+            result = [params['code']]
+        elif method == 'shutdown':
+            print(json.dumps({'jsonrpc': '2.0', 'id': request['id'], 'result': None}), flush=True)
+            break
+        print(json.dumps({'jsonrpc': '2.0', 'id': request['id'], 'result': result}), flush=True)
+''')
+
+
+class TestQueryServerClient(unittest.TestCase):
+    """Test cases for QueryServerClient against a scripted server"""
+
+    @classmethod
+    def setUpClass(cls):
+        """Write the fake server as an executable script"""
+        cls.temp_dir = tempfile.mkdtemp()
+        cls.server_path = os.path.join(cls.temp_dir, 'fake-ariane-xml')
+        with open(cls.server_path, 'w') as f:
+            f.write(f'#!{sys.executable}\n{FAKE_SERVER}')
+        os.chmod(cls.server_path, 0o755)
+
+    @classmethod
+    def tearDownClass(cls):
+        shutil.rmtree(cls.temp_dir, ignore_errors=True)
+
+    def setUp(self):
+        self.client = QueryServerClient(self.server_path, self.temp_dir)
+
+    def tearDown(self):
+        self.client.close()
+
+    def execute(self, query, timeout=5):
+        return self.client.call('execute', {'query': query}, timeout=timeout)['result']
+
+    def test_execute_round_trip(self):
+        """Test a request gets its own response"""
+        self.assertEqual(self.execute('SELECT .a FROM x.xml')['output'], 'SELECT .a FROM x.xml')
+
+    def test_server_kept_between_calls(self):
+        """Test consecutive calls share one server process"""
+        first = self.execute('SHOW MODE')['pid']
+        second = self.execute('SHOW MODE')['pid']
+        self.assertEqual(first, second)
+        self.assertIsNone(self.client.take_restart_notice())
+
+    def test_execute_timeout_restarts_and_replays_session(self):
+        """Test a timed out query restarts the server with its SET statements"""
+        self.execute('SET MODE DSN')
+        self.execute('SET XSD schema.xsd')
+        pid = self.execute('SHOW SESSION')['pid']
+
+        with self.assertRaises(TimeoutError):
+            self.execute('SLEEP 5', timeout=0.5)
+
+        result = self.execute('SHOW SESSION')
+        self.assertNotEqual(result['pid'], pid)
+        self.assertEqual(result['output'], 'SET MODE DSN|SET XSD schema.xsd')
+
+        notice = self.client.take_restart_notice()
+        self.assertIn('session reset', notice)
+        self.assertIn('SET MODE DSN', notice)
+        self.assertIsNone(self.client.take_restart_notice())
+
+    def test_replay_keeps_last_statement_per_setting(self):
+        """Test only the latest value of each setting is replayed"""
+        self.execute('SET MODE DSN')
+        self.execute('SET XSD a.xsd')
+        self.execute('set mode STANDARD')
+        self.client._process.kill()
+        self.client._process.wait()
+
+        self.assertEqual(self.execute('SHOW SESSION')['output'], 'SET XSD a.xsd|set mode STANDARD')
+
+    def test_completion_timeout_keeps_server(self):
+        """Test a slow completion is given up without losing the session"""
+        self.execute('SET MODE DSN')
+        pid = self.execute('SHOW MODE')['pid']
+
+        with self.assertRaises(TimeoutError):
+            self.client.call('complete', {'code': 'slow', 'cursor_pos': 4},
+                             timeout=0.2, keep_on_timeout=True)
+
+        # The late completion answer is skipped, not taken for this one
+        result = self.execute('SHOW SESSION')
+        self.assertEqual(result['pid'], pid)
+        self.assertEqual(result['output'], 'SET MODE DSN')
+        self.assertIsNone(self.client.take_restart_notice())
+
+    def test_missing_executable(self):
+        """Test an executable that can't start is reported as unavailable"""
+        client = QueryServerClient(os.path.join(self.temp_dir, 'missing'), self.temp_dir)
+        with self.assertRaises(QueryServerUnavailable):
+            client.call('execute', {'query': 'SHOW MODE'})
+
+
+class TestKernelQueryServer(unittest.TestCase):
+    """Test how the kernel reacts to server timeouts and restarts"""
+
+    def setUp(self):
+        self.kernel = ArianeXMLKernel()
+        self.kernel.dsn_mode = True
+        self.kernel.query_server = Mock()
+        self.kernel.send_response = Mock()
+
+    def test_completion_timeout_keeps_server(self):
+        """Test a completion timeout neither discards the server nor falls back"""
+        self.kernel.query_server.call.side_effect = TimeoutError()
+        server = self.kernel.query_server
+
+        self.assertIsNone(self.kernel._fetch_completions('SELECT S21_', 11))
+        self.assertIs(self.kernel.query_server, server)
+        self.assertTrue(server.call.call_args.kwargs['keep_on_timeout'])
+
+    def test_restart_notice_shown(self):
+        """Test the user is told when the server session was reset"""
+        self.kernel.query_server.call.return_value = {'result': {'output': 'MODE: DSN\n'}}
+        self.kernel.query_server.take_restart_notice.return_value = 'The ariane-xml server was restarted'
+
+        result = self.kernel._execute_query_on_server('SHOW MODE')
+
+        self.assertTrue(result['success'])
+        stream = self.kernel.send_response.call_args.args[2]
+        self.assertEqual(stream['name'], 'stderr')
+        self.assertIn('restarted', stream['text'])
+
+
+class TestIntegrationQueryServer(unittest.TestCase):
+    """Integration tests that require built C++ executable"""
+
+    def setUp(self):
+        """Check if C++ executable exists"""
+        path = os.environ.get('ARIANE_XML_BIN',
+                              os.path.join(os.path.dirname(__file__), '..',
+                                           'ariane-xml-c-kernel', 'build', 'ariane-xml'))
+        if not os.path.exists(path):
+            self.skipTest(f"C++ executable not found at {path}")
+        self.client = QueryServerClient(path, os.path.join(os.path.dirname(__file__), '..'))
+
+    def tearDown(self):
+        self.client.close()
+
+    def test_session_kept_between_requests(self):
+        """Test SET MODE carries over to the next request"""
+        self.client.call('execute', {'query': 'SET MODE DSN'})
+        response = self.client.call('execute', {'query': 'SHOW MODE'})
+        self.assertIn('MODE: DSN', response['result']['output'])
+
+    def test_session_replayed_after_restart(self):
+        """Test a restarted server gets the previous mode back"""
+        self.client.call('execute', {'query': 'SET MODE DSN'})
+        self.client._process.kill()
+        self.client._process.wait()
+
+        response = self.client.call('execute', {'query': 'SHOW MODE'})
+        self.assertIn('MODE: DSN', response['result']['output'])
+        self.assertIn('SET MODE DSN', self.client.take_restart_notice())
+
+    def test_prompt_takes_default_answer(self):
+        """Test a statement that prompts doesn't read the next request"""
+        with tempfile.TemporaryDirectory() as temp_dir:
+            missing = os.path.join(temp_dir, 'missing', 'dest')
+            response = self.client.call('execute', {'query': f'SET DEST {missing}'}, timeout=5)
+            self.assertIn('cancelled', response['result']['output'])
+            self.assertFalse(os.path.exists(missing))
+
+        response = self.client.call('execute', {'query': 'SHOW MODE'}, timeout=5)
+        self.assertIn('MODE:', response['result']['output'])
+
+        # Replaying the prompting statement after a restart doesn't hang either
+        self.client._process.kill()
+        self.client._process.wait()
+        response = self.client.call('execute', {'query': 'SHOW MODE'}, timeout=5)
+        self.assertIn('MODE:', response['result']['output'])
+
+    def test_unknown_method(self):
+        """Test an unknown method gets a JSON-RPC error"""
+        response = self.client.call('bogus')
+        self.assertEqual(response['error']['code'], -32601)
+
+
+def run_tests():
+    """Run all tests"""
+    loader = unittest.TestLoader()
+    suite = unittest.TestSuite()
+
+    # Add test classes
+    suite.addTests(loader.loadTestsFromTestCase(TestQueryServerClient))
+    suite.addTests(loader.loadTestsFromTestCase(TestKernelQueryServer))
+    suite.addTests(loader.loadTestsFromTestCase(TestIntegrationQueryServer))
+
+    # Run tests
+    runner = unittest.TextTestRunner(verbosity=2)
+    result = runner.run(suite)
+
+    return 0 if result.wasSuccessful() else 1
+
+
+if __name__ == '__main__':
+    sys.exit(run_tests())